@@ -24,7 +24,15 @@ public:
     while (true)
     {
       Loop();
-      taskYIELD();
+      if (polling)
+      {
+        taskYIELD();
+      }
+      else
+      {
+        // Sleep until input or MIDI arrives, but never longer than one LED frame so timer driven Loops keep pace.
+        MatrixOS::SYS::WaitForWake(1000 / Device::LED::fps);
+      }
     }
   }
 
@@ -40,6 +48,13 @@ public:
   virtual void End() {};
 
   virtual ~Application() = default;
+
+protected:
+  // Opt back into spinning Loop() continuously instead of sleeping between events.
+  void SetPolling(bool polling) { this->polling = polling; }
+
+private:
+  bool polling = false;
 };
 
 #define APPID(author, name) StaticHash(author "-" name)
@@ -98,7 +113,7 @@ template <typename APPLICATION_CLASS> static inline void RegisterApplication(uin
   GetApplicationIDs()[order] = app_id;
 }
 
+// An inline variable rather than a constructor function, so it is initialized after the app's info it reads.
+// Constructor functions have no order against static members and ran first on native Linux builds.
 #define REGISTER_APPLICATION(APPLICATION_CLASS, IS_SYSTEM)                                                                                 \
-  __attribute__((__constructor__)) inline void APPLICATION_HELPER_CLASS(APPLICATION_CLASS)(void) {                                         \
-    RegisterApplication<APPLICATION_CLASS>(__COUNTER__, IS_SYSTEM);                                                                       \
-  }
+  inline const bool APPLICATION_HELPER_CLASS(APPLICATION_CLASS) = (RegisterApplication<APPLICATION_CLASS>(__COUNTER__, IS_SYSTEM), true);
@@ -13,12 +13,20 @@
 
 #define TAG "UAD Actions"
 
-bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, ActionEvent* actionEvent) {
-  if (actionInfo->depth > 5)
-  {
-    MLOGE(TAG, "Action depth exceeded");
-    return false;
-  }
+template <typename T>
+static T* ActionData(UADAction* action) {
+  static_assert(sizeof(T) <= UAD_ACTION_DATA_SIZE, "Action data does not fit in UADAction");
+  static_assert(alignof(T) <= alignof(UADAction), "Action data is over aligned for UADAction");
+  return reinterpret_cast<T*>(action->data);
+}
+
+template <typename T>
+static const T& ActionData(const UADAction* action) {
+  return *reinterpret_cast<const T*>(action->data);
+}
+
+bool UADRuntime::CompileAction(cb0r_t actionData, ActionType actionType, UADAction* action) {
+  action->signature = 0;
 
   cb0r_s actionIndex;
 
@@ -30,7 +38,7 @@ bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, Action
 
   uint32_t actionSignature = 0;
 
-  if (actionInfo->actionType == ActionType::ACTION)
+  if (actionType == ActionType::ACTION)
   {
     if (actionIndex.value >= actionList.size())
     {
@@ -38,9 +46,8 @@ bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, Action
       return false;
     }
     actionSignature = actionList[actionIndex.value];
-    MLOGV(TAG, "Executing action - %d", actionSignature);
   }
-  else if (actionInfo->actionType == ActionType::EFFECT)
+  else if (actionType == ActionType::EFFECT)
   {
     if (actionIndex.value >= effectList.size())
     {
@@ -48,37 +55,88 @@ bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, Action
       return false;
     }
     actionSignature = effectList[actionIndex.value];
-    MLOGV(TAG, "Executing effect - %d", actionSignature);
   }
 
+  bool decoded = false;
+  switch (actionSignature)
+  {
+  case MidiAction::signature:
+    decoded = MidiAction::LoadData(actionData, ActionData<MidiAction::MidiAction>(action));
+    break;
+  case KeyboardAction::signature:
+    decoded = KeyboardAction::LoadData(actionData, ActionData<KeyboardAction::KeyboardAction>(action));
+    break;
+  case GamepadAction::signature:
+    decoded = GamepadAction::LoadData(actionData, ActionData<GamepadAction::GamepadAction>(action));
+    break;
+  case LayerAction::signature:
+    decoded = LayerAction::LoadData(actionData, ActionData<LayerAction::LayerAction>(action));
+    break;
+  case WrapAction::signature:
+    decoded = WrapAction::LoadData(actionData, ActionData<WrapAction::WrapAction>(action));
+    break;
+  case ColorEffect::signature:
+    decoded = ColorEffect::LoadData(actionData, ActionData<ColorEffect::ColorEffectData>(action));
+    break;
+  case ActionColorEffect::signature:
+    decoded = ActionColorEffect::LoadData(actionData, ActionData<ActionColorEffect::ActionColorEffectData>(action), &argumentPool);
+    break;
+  default:
+    MLOGW(TAG, "Unknown action - %d", actionSignature);
+    return false;
+  }
+
+  if (!decoded)
+  {
+    MLOGE(TAG, "Failed to load action - %d", actionSignature);
+    return false;
+  }
+
+  action->signature = actionSignature;
+  return true;
+}
+
+bool UADRuntime::ExecuteAction(ActionInfo* actionInfo, const UADAction* action, ActionEvent* actionEvent) {
+  if (actionInfo->depth > 5)
+  {
+    MLOGE(TAG, "Action depth exceeded");
+    return false;
+  }
+
+  MLOGV(TAG, "Executing %s - %d", actionInfo->actionType == ActionType::ACTION ? "action" : "effect", action->signature);
+
   if (actionEvent->type == ActionEventType::KEYEVENT)
   {
-    switch (actionSignature)
+    switch (action->signature)
     {
     case MidiAction::signature:
-      return MidiAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return MidiAction::KeyEvent(this, actionInfo, ActionData<MidiAction::MidiAction>(action), actionEvent->keyInfo);
     case KeyboardAction::signature:
-      return KeyboardAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return KeyboardAction::KeyEvent(this, actionInfo, ActionData<KeyboardAction::KeyboardAction>(action), actionEvent->keyInfo);
     case GamepadAction::signature:
-      return GamepadAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return GamepadAction::KeyEvent(this, actionInfo, ActionData<GamepadAction::GamepadAction>(action), actionEvent->keyInfo);
     case LayerAction::signature:
-      return LayerAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return LayerAction::KeyEvent(this, actionInfo, ActionData<LayerAction::LayerAction>(action), actionEvent->keyInfo);
     case WrapAction::signature:
-      return WrapAction::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return WrapAction::KeyEvent(this, actionInfo, ActionData<WrapAction::WrapAction>(action), actionEvent->keyInfo);
     case ColorEffect::signature:
-      return ColorEffect::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
-    case ActionColorEffect::signature:
-      return ActionColorEffect::KeyEvent(this, actionInfo, actionData, actionEvent->keyInfo);
+      return ColorEffect::KeyEvent(this, actionInfo, ActionData<ColorEffect::ColorEffectData>(action), actionEvent->keyInfo);
+    case ActionColorEffect::signature: {
+      const ActionColorEffect::ActionColorEffectData& data = ActionData<ActionColorEffect::ActionColorEffectData>(action);
+      return ActionColorEffect::KeyEvent(this, actionInfo, data, argumentPool.data() + data.colorOffset, actionEvent->keyInfo);
+    }
     }
   }
   else if (actionEvent->type == ActionEventType::INITIALIZATION)
   {
-    switch (actionSignature)
+    switch (action->signature)
     {
     case ColorEffect::signature:
-      return ColorEffect::Initialization(this, actionInfo, actionData);
-    case ActionColorEffect::signature:
-      return ActionColorEffect::Initialization(this, actionInfo, actionData);
+      return ColorEffect::Initialization(this, actionInfo, ActionData<ColorEffect::ColorEffectData>(action));
+    case ActionColorEffect::signature: {
+      const ActionColorEffect::ActionColorEffectData& data = ActionData<ActionColorEffect::ActionColorEffectData>(action);
+      return ActionColorEffect::Initialization(this, actionInfo, data, argumentPool.data() + data.colorOffset);
+    }
     }
   }
   return false;
@@ -6,12 +6,12 @@ const char* TAG = "ActionColorEffect";
 
 constexpr uint32_t signature = StaticHash("actioncolor");
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
-  if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released)
-  {
-    return false;
-  }
+struct ActionColorEffectData {
+  uint16_t enabled;     // Bitmap of group register values that have a color
+  uint32_t colorOffset; // First color in the runtime argument pool, one per enabled bit
+};
 
+static bool LoadData(cb0r_t actionData, ActionColorEffectData* data, vector<uint32_t>* colorPool) {
   cb0r_s cbor_data;
   if (!cb0r_get_check_type(actionData, 1, &cbor_data, CB0R_INT))
   {
@@ -19,6 +19,29 @@ static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionDat
     return false;
   }
 
+  data->enabled = cbor_data.value;
+  data->colorOffset = colorPool->size();
+
+  uint8_t colorCount = __builtin_popcount(data->enabled);
+  for (uint8_t i = 0; i < colorCount; i++)
+  {
+    if (!cb0r_next_check_type(actionData, &cbor_data, &cbor_data, CB0R_INT))
+    {
+      MLOGE(TAG, "Failed to get color");
+      colorPool->resize(data->colorOffset);
+      return false;
+    }
+    colorPool->push_back(cbor_data.value);
+  }
+  return true;
+}
+
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const ActionColorEffectData& data, const uint32_t* colors, KeypadInfo* keypadInfo) {
+  if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released)
+  {
+    return false;
+  }
+
   ActionInfo groupActionInfo = *actionInfo;
   groupActionInfo.index = 255;
 
@@ -28,7 +51,7 @@ static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionDat
 
   groupRegister &= 0x0F;
 
-  int8_t index = UADRuntime::IndexInBitmap(cbor_data.value, groupRegister);
+  int8_t index = UADRuntime::IndexInBitmap(data.enabled, groupRegister);
 
   if (index == -1)
   {
@@ -36,13 +59,7 @@ static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionDat
   }
   else
   {
-    Color color;
-    if (!cb0r_get_check_type(actionData, index + 1, &cbor_data, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get color");
-      return false;
-    }
-    color = Color(cbor_data.value);
+    Color color = Color(colors[index - 1]);
     if (actionInfo->indexType == ActionIndexType::COORD)
     {
       MatrixOS::LED::SetColor(actionInfo->coord, color, 0);
@@ -55,23 +72,10 @@ static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionDat
   }
 }
 
-static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData) {
-  cb0r_s cbor_data;
-  if (!cb0r_get_check_type(actionData, 1, &cbor_data, CB0R_INT))
+static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, const ActionColorEffectData& data, const uint32_t* colors) {
+  if (IsBitSet(data.enabled, 0))
   {
-    MLOGE(TAG, "Failed to get enabled bitmap");
-    return false;
-  }
-
-  if (IsBitSet(cbor_data.value, 0))
-  {
-    Color color;
-    if (!cb0r_get_check_type(actionData, 2, &cbor_data, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get color");
-      return false;
-    }
-    color = Color(cbor_data.value);
+    Color color = Color(colors[0]);
     if (actionInfo->indexType == ActionIndexType::COORD)
     {
       MatrixOS::LED::SetColor(actionInfo->coord, color, 0);
@@ -53,18 +53,10 @@ static bool LoadData(cb0r_t actionData, ColorEffectData* data) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const ColorEffectData& data, KeypadInfo* keypadInfo) {
   if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released)
     return false;
 
-  struct ColorEffectData data;
-
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load data");
-    return false;
-  }
-
   // if(data.hasActivated == false)
   // {
   //     return true;
@@ -97,15 +89,7 @@ static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionDat
   return false;
 }
 
-static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData) {
-  struct ColorEffectData data;
-
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load data");
-    return false;
-  }
-
+static bool Initialization(UADRuntime* uadRT, ActionInfo* actionInfo, const ColorEffectData& data) {
   // if(data.hasDefault)
   // {
   if (actionInfo->indexType == ActionIndexType::COORD)
@@ -126,19 +126,11 @@ static bool LoadData(cb0r_t actionData, GamepadAction* action) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const GamepadAction& data, KeypadInfo* keypadInfo) {
   MLOGV(TAG, "KeyEvent");
   if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released && keypadInfo->state != KeypadState::Aftertouch)
     return false;
 
-  struct GamepadAction data;
-
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load action");
-    return false;
-  }
-
   if (data.source != AnalogSource::KeyForce && keypadInfo->state == KeypadState::Aftertouch)
   {
     return false;
@@ -31,19 +31,11 @@ static bool LoadData(cb0r_t actionData, KeyboardAction* action) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const KeyboardAction& action, KeypadInfo* keypadInfo) {
   MLOGV(TAG, "KeyEvent");
   if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released)
     return false;
 
-  struct KeyboardAction action;
-
-  if (!LoadData(actionData, &action))
-  {
-    MLOGE(TAG, "Failed to load action");
-    return false;
-  }
-
   uint8_t keycode = action.key;
 
   if (action.key == 0)
@@ -51,17 +51,10 @@ static bool LoadData(cb0r_t actionData, LayerAction* action) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const LayerAction& data, KeypadInfo* keypadInfo) {
   if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released)
     return false;
 
-  struct LayerAction data;
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load action");
-    return false;
-  }
-
   // Process Layer Action
   int8_t targetLayer = data.layer;
   if (data.relative)
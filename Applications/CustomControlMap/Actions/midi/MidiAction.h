@@ -194,19 +194,12 @@ static bool LoadData(cb0r_t actionData, MidiAction* action) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const MidiAction& data, KeypadInfo* keypadInfo) {
   if (keypadInfo->state != KeypadState::Pressed && keypadInfo->state != KeypadState::Released && keypadInfo->state != KeypadState::Aftertouch)
   {
     return false;
   }
 
-  MidiAction data;
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load action");
-    return false;
-  }
-
   uint16_t outputValue = 0;
   switch (data.source)
   {
@@ -74,13 +74,7 @@ static bool LoadData(cb0r_t actionData, WrapAction* action) {
   return true;
 }
 
-static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, cb0r_t actionData, KeypadInfo* keypadInfo) {
-  WrapAction data;
-  if (!LoadData(actionData, &data))
-  {
-    MLOGE(TAG, "Failed to load action");
-    return false;
-  }
+static bool KeyEvent(UADRuntime* uadRT, ActionInfo* actionInfo, const WrapAction& data, KeypadInfo* keypadInfo) {
   ActionInfo newAction = *actionInfo;
 
   if (data.relativeLayer == true)
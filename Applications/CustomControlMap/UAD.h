@@ -6,6 +6,19 @@
 #include "Action.h"
 
 #define UAD_VERSION 0
+#define UAD_ACTION_DATA_SIZE 24 // Bytes reserved for the decoded arguments of one action
+
+// An action or effect decoded at load time. Key events dispatch on it without touching the CBOR.
+struct UADAction {
+  uint32_t signature = 0; // Resolved name hash, 0 if the action failed to decode
+  alignas(void*) uint8_t data[UAD_ACTION_DATA_SIZE]; // Argument struct of the action, filled by its LoadData
+};
+
+// Run of compiled actions in the action pool
+struct UADActionSpan {
+  uint32_t start = 0;
+  uint16_t count = 0;
+};
 
 // Universal Action Descriptor
 class UADRuntime {
@@ -33,7 +46,7 @@ public:
 
   bool ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent);                   // WIll pick a layer and index for Action
   bool ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent);                   // WIll pick a layer and index for Effect
-  bool ExecuteAction(ActionInfo* actionInfo, cb0r_t actionData, ActionEvent* actionEvent); // Not intended for direct use
+  bool ExecuteAction(ActionInfo* actionInfo, const UADAction* action, ActionEvent* actionEvent); // Not intended for direct use
   // bool GetActionsFromOffset(uint16_t offset, cb0r_t result);
   void InitializeLayer(uint8_t layer = 255); // 255 means top layer
   void DeinitializeLayer(uint8_t layer = 255);
@@ -61,8 +74,13 @@ public:
 private:
   vector<uint32_t> actionList;
   vector<uint32_t> effectList;
-  uint16_t** actionLUT;
-  uint16_t* effectLUT;
+
+  // Compiled tables, built once by LoadUAD. The raw UAD is only kept around so it can be read back.
+  vector<UADAction> actionPool;      // Every compiled action and effect, grouped by key and layer
+  vector<uint32_t> argumentPool;     // Variable length arguments, such as action color lists
+  vector<uint16_t> actionLayers;     // Per key, bitmap of layers that define actions
+  vector<UADActionSpan> actionTable; // Per key and layer, the actions in actionPool
+  vector<UADActionSpan> effectTable; // Per layer and key, the effects in actionPool
 
   std::map<uint32_t, uint32_t> registers;
 
@@ -71,9 +89,15 @@ private:
   bool LoadActionList(cb0r_t uadMap);
   bool LoadEffectList(cb0r_t uadMap);
   bool CreateHashList(cb0r_t cborArray, vector<uint32_t>* list); // Used to generate hash for action names
-  bool CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension lutSize);
-  bool CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lutSize);
+  bool CompileActions(cb0r_t actionMatrix);
+  bool CompileEffects(cb0r_t effectMatrix);
+  bool CompileActionList(cb0r_t cborArray, ActionType actionType, UADActionSpan* span);
+  bool CompileAction(cb0r_t actionData, ActionType actionType, UADAction* action); // Resolves the signature and decodes the arguments
+  void ClearTables();
   bool LoadDevice(cb0r_t uadMap);
+
+  bool GetKeyIndex(Point xy, uint16_t* keyIndex);
+  void ExecuteLayerEffects(uint8_t layer, ActionEvent* actionEvent);
 };
 
 #define IsBitSet(byte, bit) ((byte & (1 << bit)) != 0)
\ No newline at end of file
@@ -8,21 +8,14 @@ UADRuntime::UADRuntime(uint8_t* uad, size_t size) {
   LoadUAD(uad, size);
 }
 
-UADRuntime::~UADRuntime() {
-  // Free LUTs
-  if (actionLUT != NULL)
-  {
-    for (uint16_t x = 0; x < mapSize.x; x++)
-    {
-      free(actionLUT[x]);
-    }
-    free(actionLUT);
-  }
-
-  if (effectLUT != NULL)
-  {
-    free(effectLUT);
-  }
+UADRuntime::~UADRuntime() {}
+
+void UADRuntime::ClearTables() {
+  actionPool.clear();
+  argumentPool.clear();
+  actionLayers.clear();
+  actionTable.clear();
+  effectTable.clear();
 }
 
 bool UADRuntime::CheckVersion(cb0r_t uadMap) {
@@ -85,7 +78,26 @@ bool UADRuntime::CreateHashList(cb0r_t cborArray, vector<uint32_t>* list) {
   return true;
 }
 
-bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension lutSize) {
+bool UADRuntime::CompileActionList(cb0r_t cborArray, ActionType actionType, UADActionSpan* span) {
+  span->start = actionPool.size();
+  span->count = cborArray->length;
+
+  cb0r_s actionData = *cborArray;
+  for (uint16_t i = 0; i < span->count; i++)
+  {
+    actionPool.emplace_back();
+    if (!cb0r_next_check_type(cborArray, &actionData, &actionData, CB0R_ARRAY))
+    {
+      MLOGE(TAG, "Failed to get action %d from action list\n", i);
+      return false;
+    }
+    // Actions that fail to decode keep signature 0 and are skipped at runtime, so indexes (and their registers) stay stable
+    CompileAction(&actionData, actionType, &actionPool.back());
+  }
+  return true;
+}
+
+bool UADRuntime::CompileActions(cb0r_t actionMatrix) {
   cb0r_s xBitmap;
   if (!cb0r_get_check_type(actionMatrix, 0, &xBitmap, CB0R_INT))
   {
@@ -93,19 +105,13 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
     return false;
   }
 
-  *lut = (uint16_t**)pvPortMalloc(lutSize.x * sizeof(uint16_t*));
+  actionLayers.assign(mapSize.x * mapSize.y, 0);
+  actionTable.assign(mapSize.x * mapSize.y * layerCount, UADActionSpan());
 
   // Layer 1
   cb0r_s yArray = xBitmap;
-  for (uint8_t x = 0; x < lutSize.x; x++)
+  for (uint8_t x = 0; x < mapSize.x; x++)
   {
-    (*lut)[x] = (uint16_t*)pvPortMalloc(lutSize.y * sizeof(uint16_t));
-
-    for (uint8_t y = 0; y < lutSize.y; y++)
-    {
-      (*lut)[x][y] = 0;
-    }
-
     if (!IsBitSet(xBitmap.value, x))
     {
       continue;
@@ -126,7 +132,7 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
 
     // Layer 2
     cb0r_s layerArray = yBitmap;
-    for (uint8_t y = 0; y < lutSize.y; y++)
+    for (uint8_t y = 0; y < mapSize.y; y++)
     {
       if (!IsBitSet(yBitmap.value, y))
       {
@@ -139,20 +145,42 @@ bool UADRuntime::CreateActionLUT(cb0r_t actionMatrix, uint16_t*** lut, Dimension
         return false;
       }
 
-      uint32_t offset = layerArray.start - uad;
-      if (offset > UINT16_MAX)
+      cb0r_s layerBitmap;
+      if (!cb0r_get_check_type(&layerArray, 0, &layerBitmap, CB0R_INT))
       {
-        MLOGE(TAG, "Action Y Offset is too large\n");
+        MLOGE(TAG, "Failed to get Action Layer Bitmap\n");
         return false;
       }
 
-      (*lut)[x][y] = (uint16_t)offset;
+      uint16_t keyIndex = x * mapSize.y + y;
+      actionLayers[keyIndex] = layerBitmap.value & ((1 << layerCount) - 1);
+
+      // Layer 3 - Stored from the top layer down
+      cb0r_s actions = layerBitmap;
+      for (int8_t layer = layerCount - 1; layer >= 0; layer--)
+      {
+        if (!IsBitSet(layerBitmap.value, layer))
+        {
+          continue;
+        }
+
+        if (!cb0r_next_check_type(&layerArray, &actions, &actions, CB0R_ARRAY))
+        {
+          MLOGE(TAG, "Failed to get Action Array\n");
+          return false;
+        }
+
+        if (!CompileActionList(&actions, ActionType::ACTION, &actionTable[keyIndex * layerCount + layer]))
+        {
+          return false;
+        }
+      }
     }
   }
   return true;
 }
 
-bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lutSize) {
+bool UADRuntime::CompileEffects(cb0r_t effectMatrix) {
   cb0r_s layerBitmap;
   if (!cb0r_get_check_type(effectMatrix, 0, &layerBitmap, CB0R_INT))
   {
@@ -160,15 +188,15 @@ bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lu
     return false;
   }
 
-  *lut = (uint16_t*)pvPortMalloc(lutSize * sizeof(uint16_t));
+  uint16_t keyCount = mapSize.x * mapSize.y;
+  effectTable.assign(layerCount * keyCount, UADActionSpan());
 
   // Layer List
   cb0r_s xArray = layerBitmap;
-  for (uint8_t layer = 0; layer < lutSize; layer++)
+  for (uint8_t layer = 0; layer < layerCount; layer++)
   {
     if (!IsBitSet(layerBitmap.value, layer))
     {
-      (*lut)[layer] = 0;
       continue;
     }
 
@@ -178,14 +206,54 @@ bool UADRuntime::CreateEffectLUT(cb0r_t effectMatrix, uint16_t** lut, uint8_t lu
       return false;
     }
 
-    uint32_t offset = xArray.start - uad;
-    if (offset > UINT16_MAX)
+    cb0r_s xBitmap;
+    if (!cb0r_get_check_type(&xArray, 0, &xBitmap, CB0R_INT))
     {
-      MLOGE(TAG, "Effect X Offset is too large\n");
+      MLOGE(TAG, "Failed to get Effect X Bitmap\n");
       return false;
     }
 
-    (*lut)[layer] = (uint16_t)offset;
+    cb0r_s yArray = xBitmap;
+    for (uint8_t x = 0; x < mapSize.x; x++)
+    {
+      if (!IsBitSet(xBitmap.value, x))
+      {
+        continue;
+      }
+
+      if (!cb0r_next_check_type(&xArray, &yArray, &yArray, CB0R_ARRAY))
+      {
+        MLOGE(TAG, "Failed to get Effect Y Array\n");
+        return false;
+      }
+
+      cb0r_s yBitmap;
+      if (!cb0r_get_check_type(&yArray, 0, &yBitmap, CB0R_INT))
+      {
+        MLOGE(TAG, "Failed to get Effect Y Bitmap\n");
+        return false;
+      }
+
+      cb0r_s effects = yBitmap;
+      for (uint8_t y = 0; y < mapSize.y; y++)
+      {
+        if (!IsBitSet(yBitmap.value, y))
+        {
+          continue;
+        }
+
+        if (!cb0r_next_check_type(&yArray, &effects, &effects, CB0R_ARRAY))
+        {
+          MLOGE(TAG, "Failed to get Effect Array\n");
+          return false;
+        }
+
+        if (!CompileActionList(&effects, ActionType::EFFECT, &effectTable[layer * keyCount + x * mapSize.y + y]))
+        {
+          return false;
+        }
+      }
+    }
   }
   return true;
 }
@@ -279,6 +347,11 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     return false;
   }
   layerCount = deviceData.value;
+  if (layerCount > 16)
+  {
+    MLOGE(TAG, "Too many layers: %d", layerCount);
+    return false;
+  }
 
   // Get Device Actions
   if (!cb0r_find(&device, CB0R_UTF8, 7, (uint8_t*)"actions", &deviceData) || deviceData.type != CB0R_ARRAY)
@@ -286,7 +359,11 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     MLOGE(TAG, "Failed to get Device Actions");
     return false;
   }
-  CreateActionLUT(&deviceData, &actionLUT, mapSize);
+  if (!CompileActions(&deviceData))
+  {
+    MLOGE(TAG, "Failed to compile Device Actions");
+    return false;
+  }
 
   // Get Device Effects
   if (!cb0r_find(&device, CB0R_UTF8, 7, (uint8_t*)"effects", &deviceData) || deviceData.type != CB0R_ARRAY)
@@ -294,11 +371,17 @@ bool UADRuntime::LoadDevice(cb0r_t uadMap) {
     MLOGE(TAG, "Failed to get Device Effects");
     return false;
   }
-  CreateEffectLUT(&deviceData, &effectLUT, layerCount);
+  if (!CompileEffects(&deviceData))
+  {
+    MLOGE(TAG, "Failed to compile Device Effects");
+    return false;
+  }
   return deviceFound;
 }
 
 bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
+  loaded = false;
+  ClearTables();
   this->uad = uad;
   this->uadSize = size;
   MLOGI(TAG, "Loading UAD");
@@ -333,12 +416,13 @@ bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
   if (!LoadDevice(&uadMap))
   { // Load map of current device, including action and effect.
     MLOGE(TAG, "Failed to load device");
+    ClearTables();
     return false;
   }
 
   loaded = true;
 
-  MLOGI(TAG, "Done parsing UAD");
+  MLOGI(TAG, "Done parsing UAD, %d actions compiled", actionPool.size());
 
   InitializeLayer();
   return true;
@@ -346,4 +430,5 @@ bool UADRuntime::LoadUAD(uint8_t* uad, size_t size) {
 
 void UADRuntime::UnloadUAD() {
   loaded = false;
+  ClearTables();
 }
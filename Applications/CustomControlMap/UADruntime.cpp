@@ -4,18 +4,22 @@
 #define TAG "UAD Runtime"
 
 int8_t UADRuntime::IndexInBitmap(uint64_t bitmap, uint8_t index) {
-  if (!IsBitSet(bitmap, index))
+  if (index >= 64 || !((bitmap >> index) & 1))
   {
     return -1;
   }
 
-  // Find nums of bits set before index - TODO: This can probably be optimized by a lot
-  uint8_t count = 0;
-  for (uint8_t i = 0; i < index; i++)
+  // Nums of bits set before index
+  return __builtin_popcountll(bitmap & ((1ull << index) - 1)) + 1;
+}
+
+bool UADRuntime::GetKeyIndex(Point xy, uint16_t* keyIndex) {
+  if (xy.x >= mapSize.x || xy.y >= mapSize.y || xy.x < 0 || xy.y < 0)
   {
-    count += IsBitSet(bitmap, i);
+    return false;
   }
-  return count + 1;
+  *keyIndex = xy.x * mapSize.y + xy.y;
+  return true;
 }
 
 void UADRuntime::KeyEvent(InputId inputId, KeypadInfo* keypadInfo) {
@@ -50,54 +54,37 @@ void UADRuntime::KeyEvent(InputId inputId, KeypadInfo* keypadInfo) {
 }
 
 bool UADRuntime::ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent) {
-  // Get Offset based on index type
-  uint16_t offset;
+  // Get key index based on index type
+  uint16_t keyIndex;
   ActionInfo newActionInfo = *actionInfo;
   newActionInfo.actionType = ActionType::ACTION;
 
-  if (actionInfo->indexType == ActionIndexType::COORD)
-  {
-    // MLOGV(TAG, "Executing actions for key %d,%d", actionInfo->coord.x, actionInfo->coord.y);
-    offset = actionLUT[actionInfo->coord.x][actionInfo->coord.y];
-  }
-  else
+  if (actionInfo->indexType != ActionIndexType::COORD)
   {
     MLOGV(TAG, "Executing actions for key %d ( Doesn't not support off grid keys yet)", actionInfo->id);
     return false; // Doesn't not support off grid keys yet
   }
 
-  // If the offset is 0, there are no actions to execute
-  if (offset == 0)
+  if (!GetKeyIndex(actionInfo->coord, &keyIndex))
   {
-    MLOGV(TAG, "No actions to execute");
     return false;
   }
 
-  // Get Action Layer Array
-  cb0r_s layerArray;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &layerArray) || layerArray.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Action Layer Array");
-    return false;
-  }
+  uint16_t layerBitmap = actionLayers[keyIndex];
 
-  // Get Action Layer Bitmap
-  cb0r_s bitmap;
-  if (!cb0r_get_check_type(&layerArray, 0, &bitmap, CB0R_INT))
+  // If no layer has actions, there are no actions to execute
+  if (layerBitmap == 0)
   {
-    MLOGE(TAG, "Failed to get Action Layer Bitmap");
+    MLOGV(TAG, "No actions to execute");
     return false;
   }
 
   // Execute Actions - Iterate through layers and pass through layers based on configs
-  // TODO: Because the we are reading layers from back of the array to front of the array, we need to iterate from back to front. That means
-  // we can't do serial reading. I will get this fixed.
-  cb0r_s actions = bitmap;
   MLOGD(TAG, "Layer Enabled: %d", layerEnabled);
   for (int8_t layer = layerCount - 1; layer >= 0; layer--)
   {
     // If the layer has no action.
-    if (!IsBitSet(bitmap.value, layer))
+    if (!IsBitSet(layerBitmap, layer))
     {
       if (IsBitSet(layerPassthrough, layer))
       {
@@ -113,13 +100,6 @@ bool UADRuntime::ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent
       }
     }
 
-    // Get the actions array
-    if (!cb0r_next_check_type(&layerArray, &actions, &actions, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get Action Array");
-      return false;
-    }
-
     // If the layer is not enabled, skip it
     MLOGV(TAG, "Checking Layer: %d", layer);
     if (!IsBitSet(layerEnabled, layer))
@@ -132,16 +112,12 @@ bool UADRuntime::ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent
     newActionInfo.layer = layer;
 
     // Execute the actions
-    cb0r_s actionData = actions;
-    MLOGV(TAG, "Action Length: %d", actions.length);
-    for (uint8_t actionIndex = 0; actionIndex < actions.length; actionIndex++)
+    const UADActionSpan& actions = actionTable[keyIndex * layerCount + layer];
+    MLOGV(TAG, "Action Length: %d", actions.count);
+    for (uint16_t actionIndex = 0; actionIndex < actions.count; actionIndex++)
     {
       newActionInfo.index = actionIndex;
-      if (!cb0r_next_check_type(&actions, &actionData, &actionData, CB0R_ARRAY))
-      {
-        MLOGE(TAG, "Failed to get action %d from action list", actionIndex);
-      }
-      ExecuteAction(&newActionInfo, &actionData, actionEvent);
+      ExecuteAction(&newActionInfo, &actionPool[actions.start + actionIndex], actionEvent);
     }
     break; // Action on top layer executed, stop executing following layers
   }
@@ -149,8 +125,8 @@ bool UADRuntime::ExecuteActions(ActionInfo* actionInfo, ActionEvent* actionEvent
 }
 
 bool UADRuntime::ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent) {
-  // Get Offset based on index type
-  uint16_t offset = effectLUT[effectInfo->layer];
+  // Get key index based on index type
+  uint16_t keyIndex;
   ActionInfo newEffectInfo = *effectInfo;
   newEffectInfo.actionType = ActionType::EFFECT;
 
@@ -164,79 +140,25 @@ bool UADRuntime::ExecuteEffects(ActionInfo* effectInfo, ActionEvent* effectEvent
     return false; // Doesn't not support off grid keys yet
   }
 
-  // If the offset is 0, there are no effects to execute
-  if (offset == 0)
+  if (effectInfo->layer >= layerCount || !GetKeyIndex(effectInfo->coord, &keyIndex))
   {
-    MLOGV(TAG, "No effects to execute");
     return false;
   }
 
-  // Get X Array
-  cb0r_s xArray;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &xArray) || xArray.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return false;
-  }
+  const UADActionSpan& effects = effectTable[effectInfo->layer * mapSize.x * mapSize.y + keyIndex];
 
-  // Get x Layer Bitmap
-  cb0r_s xBitmap;
-  if (!cb0r_get_check_type(&xArray, 0, &xBitmap, CB0R_INT))
-  {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
-    return false;
-  }
-
-  int8_t xIndex = IndexInBitmap(xBitmap.value, effectInfo->coord.x);
-
-  if (xIndex == -1)
+  // If the span is empty, there are no effects to execute
+  if (effects.count == 0)
   {
     MLOGV(TAG, "No effects to execute");
     return false;
   }
 
-  // Get Y Array
-  cb0r_s yArray;
-  if (!cb0r_get_check_type(&xArray, xIndex, &yArray, CB0R_ARRAY))
-  {
-    MLOGE(TAG, "Failed to get Effect Y Array");
-    return false;
-  }
-
-  // Get y Layer Bitmap
-  cb0r_s yBitmap;
-  if (!cb0r_get_check_type(&yArray, 0, &yBitmap, CB0R_INT))
-  {
-    MLOGE(TAG, "Failed to get Effect Y Bitmap");
-    return false;
-  }
-
-  int8_t yIndex = IndexInBitmap(yBitmap.value, effectInfo->coord.y);
-
-  if (yIndex == -1)
-  {
-    MLOGV(TAG, "No effects to execute");
-    return false;
-  }
-
-  // Get the effects array
-  cb0r_s effects;
-  if (!cb0r_get_check_type(&yArray, yIndex, &effects, CB0R_ARRAY))
-  {
-    MLOGE(TAG, "Failed to get Effect Array");
-    return false;
-  }
-
   // Execute the effects
-  cb0r_s effectData = effects;
-  for (uint8_t effectIndex = 0; effectIndex < effects.length; effectIndex++)
+  for (uint16_t effectIndex = 0; effectIndex < effects.count; effectIndex++)
   {
     newEffectInfo.index = effectIndex;
-    if (!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get effect %d from effect list", effectIndex);
-    }
-    ExecuteAction(&newEffectInfo, &effectData, effectEvent);
+    ExecuteAction(&newEffectInfo, &actionPool[effects.start + effectIndex], effectEvent);
   }
   return true;
 }
@@ -260,196 +182,56 @@ uint8_t UADRuntime::GetTopLayer() {
   return 0;
 }
 
-void UADRuntime::InitializeLayer(uint8_t layer) {
-  if (layer == 255)
-  {
-    layer = GetTopLayer();
-  }
-
-  MLOGI(TAG, "Initializing layer %d", layer);
-
-  uint16_t offset = effectLUT[layer];
-
-  // Nothing in this layer
-  if (offset == 0)
+void UADRuntime::ExecuteLayerEffects(uint8_t layer, ActionEvent* actionEvent) {
+  if (layer >= layerCount)
   {
-    MLOGI(TAG, "Nothing in the effect layer");
     return;
   }
 
-  ActionEvent actionEvent = {.type = ActionEventType::INITIALIZATION, .data = NULL};
-
   ActionInfo effectInfo;
   effectInfo.actionType = ActionType::EFFECT;
   effectInfo.indexType = ActionIndexType::COORD;
+  effectInfo.layer = layer;
 
-  // Iterating
-  cb0r_s xArray;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &xArray) || xArray.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return;
-  }
-
-  // Get X Bitmap
-  cb0r_s xBitmap;
-  if (!cb0r_get_check_type(&xArray, 0, &xBitmap, CB0R_INT))
-  {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
-    return;
-  }
-
-  // Get Y Array
-  cb0r_s yArray = xBitmap;
+  const UADActionSpan* effects = &effectTable[layer * mapSize.x * mapSize.y];
   for (uint8_t x = 0; x < mapSize.x; x++)
   {
-    if (!IsBitSet(xBitmap.value, x))
-    {
-      continue;
-    }
-
-    if (!cb0r_next_check_type(&xArray, &yArray, &yArray, CB0R_ARRAY))
+    for (uint8_t y = 0; y < mapSize.y; y++, effects++)
     {
-      MLOGE(TAG, "Failed to get Effect Y Array");
-      return;
-    }
-
-    // Get Y Bitmap
-    cb0r_s yBitmap;
-    if (!cb0r_get_check_type(&yArray, 0, &yBitmap, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Bitmap");
-      return;
-    }
-
-    // Get Y Array
-    cb0r_s effects = yBitmap;
-    for (uint8_t y = 0; y < mapSize.y; y++)
-    {
-      if (!IsBitSet(yBitmap.value, y))
-      {
-        continue;
-      }
-
-      if (!cb0r_next_check_type(&yArray, &effects, &effects, CB0R_ARRAY))
+      effectInfo.coord = Point(x, y);
+      for (uint16_t effectIndex = 0; effectIndex < effects->count; effectIndex++)
       {
-        MLOGE(TAG, "Failed to get Effect Effect Array\n");
-        return;
-      }
-
-      // Execute the effects
-      cb0r_s effectData = effects;
-      for (uint8_t effectIndex = 0; effectIndex < effects.length; effectIndex++)
-      {
-        effectInfo.coord = Point(x, y);
-        effectInfo.layer = layer;
         effectInfo.index = effectIndex;
-
-        if (!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
-        {
-          MLOGE(TAG, "Failed to get effect %d from effect list", effectIndex);
-          continue;
-        }
-        ExecuteAction(&effectInfo, &effectData, &actionEvent);
+        ExecuteAction(&effectInfo, &actionPool[effects->start + effectIndex], actionEvent);
       }
     }
   }
-  MLOGI(TAG, "Layer %d initialized", layer);
 }
 
-void UADRuntime::DeinitializeLayer(uint8_t layer) {
+void UADRuntime::InitializeLayer(uint8_t layer) {
   if (layer == 255)
   {
     layer = GetTopLayer();
   }
 
-  MLOGI(TAG, "Deinitializing layer %d", layer);
-
-  uint16_t offset = effectLUT[layer];
-
-  // Nothing in this layer
-  if (offset == 0)
-  {
-    MLOGI(TAG, "Nothing in the effect layer");
-    return;
-  }
-
-  ActionEvent actionEvent = {.type = ActionEventType::DEINITIALIZATION, .data = NULL};
+  MLOGI(TAG, "Initializing layer %d", layer);
 
-  ActionInfo effectInfo;
-  effectInfo.actionType = ActionType::EFFECT;
-  effectInfo.indexType = ActionIndexType::COORD;
+  ActionEvent actionEvent = {.type = ActionEventType::INITIALIZATION, .data = NULL};
+  ExecuteLayerEffects(layer, &actionEvent);
 
-  // Iterating
-  cb0r_s xArray;
-  if (!cb0r((uint8_t*)uad + offset, (uint8_t*)uad + uadSize, 0, &xArray) || xArray.type != CB0R_ARRAY)
-  {
-    MLOGE(TAG, "Failed to get Effect X Array");
-    return;
-  }
+  MLOGI(TAG, "Layer %d initialized", layer);
+}
 
-  // Get X Bitmap
-  cb0r_s xBitmap;
-  if (!cb0r_get_check_type(&xArray, 0, &xBitmap, CB0R_INT))
+void UADRuntime::DeinitializeLayer(uint8_t layer) {
+  if (layer == 255)
   {
-    MLOGE(TAG, "Failed to get Effect X Bitmap");
-    return;
+    layer = GetTopLayer();
   }
 
-  // Get Y Array
-  cb0r_s yArray = xBitmap;
-  for (uint8_t x = 0; x < mapSize.x; x++)
-  {
-    if (!IsBitSet(xBitmap.value, x))
-    {
-      continue;
-    }
-
-    if (!cb0r_next_check_type(&xArray, &yArray, &yArray, CB0R_ARRAY))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Array");
-      return;
-    }
-
-    // Get Y Bitmap
-    cb0r_s yBitmap;
-    if (!cb0r_get_check_type(&yArray, 0, &yBitmap, CB0R_INT))
-    {
-      MLOGE(TAG, "Failed to get Effect Y Bitmap");
-      return;
-    }
-
-    // Get Y Array
-    cb0r_s effects = yBitmap;
-    for (uint8_t y = 0; y < mapSize.y; y++)
-    {
-      if (!IsBitSet(yBitmap.value, y))
-      {
-        continue;
-      }
-
-      if (!cb0r_next_check_type(&yArray, &effects, &effects, CB0R_ARRAY))
-      {
-        MLOGE(TAG, "Failed to get Effect Effect Array\n");
-        return;
-      }
+  MLOGI(TAG, "Deinitializing layer %d", layer);
 
-      // Execute the effects
-      cb0r_s effectData = effects;
-      for (uint8_t effectIndex = 0; effectIndex < effects.length; effectIndex++)
-      {
-        effectInfo.coord = Point(x, y);
-        effectInfo.layer = layer;
-        effectInfo.index = effectIndex;
+  ActionEvent actionEvent = {.type = ActionEventType::DEINITIALIZATION, .data = NULL};
+  ExecuteLayerEffects(layer, &actionEvent);
 
-        if (!cb0r_next_check_type(&effects, &effectData, &effectData, CB0R_ARRAY))
-        {
-          MLOGE(TAG, "Failed to get effect %d from effect list", effectIndex);
-          continue;
-        }
-        ExecuteAction(&effectInfo, &effectData, &actionEvent);
-      }
-    }
-  }
   MLOGI(TAG, "Layer %d deinitialized", layer);
 }
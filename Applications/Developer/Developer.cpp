@@ -1,6 +1,7 @@
 #include "Developer.h"
 
 #include "MIDI/MIDI.h"
+#include <algorithm>
 
 namespace
 {
@@ -12,6 +13,7 @@ constexpr size_t MAX_SYSEX_SIZE = 256;
 constexpr uint8_t COMMAND_PING = 0x00;
 constexpr uint8_t COMMAND_SET_INPUT_REPORT = 0x01;
 constexpr uint8_t COMMAND_EXIT_APP = 0x02;
+constexpr uint8_t COMMAND_SET_TELEMETRY_VIEW = 0x03;
 constexpr uint8_t COMMAND_LED_WRITE_INDEX = 0x10;
 constexpr uint8_t COMMAND_LED_WRITE_XY = 0x11;
 constexpr uint8_t COMMAND_LED_WRITE_INDEX_RANGE = 0x12;
@@ -44,6 +46,10 @@ constexpr uint8_t LED_COLOR_RGB24 = 0x00;
 constexpr uint8_t LED_COLOR_RGBW32 = 0x01;
 constexpr uint8_t LED_COLOR_RGB565 = 0x02;
 
+constexpr uint32_t TELEMETRY_VIEW_INTERVAL_MS = 500;
+constexpr uint32_t TELEMETRY_STACK_LOW = 512; // Bytes of stack headroom
+constexpr uint32_t TELEMETRY_STACK_WARNING = 1024;
+
 enum class Transport : uint8_t {
   HID,
   SysEx,
@@ -61,6 +67,8 @@ struct CommandReply {
   vector<uint8_t> data;
   bool exitApp = false;
   bool skipAck = false;
+  bool setTelemetryView = false;
+  bool telemetryView = false;
 };
 
 uint8_t To7Bit(uint16_t value) {
@@ -477,6 +485,7 @@ bool GetHIDPayloadLength(uint8_t command, const uint8_t* payload, size_t size, s
     *length = 0;
     return true;
   case COMMAND_SET_INPUT_REPORT:
+  case COMMAND_SET_TELEMETRY_VIEW:
     if (size < 1)
     {
       return false;
@@ -681,6 +690,17 @@ CommandReply ExecuteCommand(uint8_t command, const uint8_t* payload, size_t leng
     reply.exitApp = true;
     return reply;
   }
+  case COMMAND_SET_TELEMETRY_VIEW: {
+    if (length != 1)
+    {
+      reply.result = CommandResult::BadLength;
+      return reply;
+    }
+
+    reply.setTelemetryView = true;
+    reply.telemetryView = payload[0] != 0;
+    return reply;
+  }
   case COMMAND_LED_WRITE_INDEX:
     reply.result = HandleLedWriteIndex(payload, length, transport);
     reply.skipAck = reply.result == CommandResult::OK;
@@ -852,18 +872,22 @@ void HandleMIDIControlChange(const MidiPacket& packet) {
 } // namespace
 
 void Developer::Setup(const vector<string>& args) {
-  (void)args;
   hidKeyReportEnabled = false;
   midiKeyReportEnabled = false;
   sysExKeyReportEnabled = false;
   sysExReportPort = MIDI_PORT_INVALID;
   sysExBuffer.reserve(MAX_SYSEX_SIZE);
+  SetTelemetryView(std::find(args.begin(), args.end(), "telemetry") != args.end());
 }
 
 void Developer::Loop() {
   DrainInput();
   DrainHID();
   DrainMIDI();
+  if (telemetryViewEnabled && (uint32_t)MatrixOS::SYS::Millis() - lastTelemetryRender >= TELEMETRY_VIEW_INTERVAL_MS)
+  {
+    RenderTelemetry();
+  }
   MatrixOS::SYS::DelayMs(1);
 }
 
@@ -948,6 +972,10 @@ void Developer::HandleHIDReport(const uint8_t* report, size_t size) {
     {
       SendHIDAck(command, reply.data);
     }
+    if (reply.setTelemetryView)
+    {
+      SetTelemetryView(reply.telemetryView);
+    }
     if (reply.exitApp)
     {
       Exit();
@@ -1041,12 +1069,16 @@ void Developer::HandleSysExMessage(uint16_t port, const vector<uint8_t>& message
   {
     if (command == COMMAND_SET_INPUT_REPORT)
     {
-      sysExReportPort = sysExKeyReportEnabled ? port : MIDI_PORT_INVALID;
+      sysExReportPort = sysExKeyReportEnabled ? port : (uint16_t)MIDI_PORT_INVALID;
     }
     if (!reply.skipAck)
     {
       SendSysExAck(port, command, reply.data);
     }
+    if (reply.setTelemetryView)
+    {
+      SetTelemetryView(reply.telemetryView);
+    }
     if (reply.exitApp)
     {
       Exit();
@@ -1056,3 +1088,54 @@ void Developer::HandleSysExMessage(uint16_t port, const vector<uint8_t>& message
 
   SendSysExError(port, command, ResultToErrorCode(reply.result));
 }
+
+void Developer::SetTelemetryView(bool enabled) {
+  if (telemetryViewEnabled && !enabled)
+  {
+    MatrixOS::LED::Fill(Color::Black);
+    MatrixOS::LED::Update();
+  }
+  telemetryViewEnabled = enabled;
+  telemetry = MatrixOS::Telemetry::Snapshot();
+  if (enabled)
+  {
+    RenderTelemetry();
+  }
+}
+
+// A row per task, lit across by its CPU share and colored by its stack headroom. The bottom row has a pixel per queue,
+// colored by how full it has been, red once it has dropped anything.
+void Developer::RenderTelemetry() {
+  MatrixOS::Telemetry::Sample(&telemetry);
+  lastTelemetryRender = telemetry.timestamp;
+  MatrixOS::LED::Fill(Color::Black);
+
+  uint8_t taskRows = Device::ySize - 1;
+  for (uint8_t row = 0; row < taskRows && row < telemetry.tasks.size(); row++)
+  {
+    const MatrixOS::Telemetry::TaskStats& task = telemetry.tasks[row];
+    Color color = task.stackFree < TELEMETRY_STACK_LOW ? Color::Red : task.stackFree < TELEMETRY_STACK_WARNING ? Color::Yellow : Color::Green;
+    uint8_t length = (task.cpuPermille * Device::xSize + 999) / 1000;
+    MatrixOS::LED::SetColor(Point(0, row), length == 0 ? color.Dim() : color);
+    for (uint8_t x = 1; x < length; x++)
+    {
+      MatrixOS::LED::SetColor(Point(x, row), color);
+    }
+  }
+
+  for (uint8_t x = 0; x < Device::xSize && x < telemetry.queues.size(); x++)
+  {
+    const MatrixOS::Telemetry::QueueStats& queue = telemetry.queues[x];
+    Color color = Color::Green;
+    if (queue.dropped > 0)
+    {
+      color = Color::Red;
+    }
+    else if (queue.capacity > 0 && queue.highWaterMark * 2 >= queue.capacity)
+    {
+      color = Color::Yellow;
+    }
+    MatrixOS::LED::SetColor(Point(x, taskRows), queue.pending == 0 ? color.Dim() : color);
+  }
+  MatrixOS::LED::Update();
+}
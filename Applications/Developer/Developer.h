@@ -2,6 +2,7 @@
 
 #include "Application.h"
 #include "MatrixOS.h"
+#include "System/Telemetry.h"
 
 class Developer : public Application {
 public:
@@ -24,6 +25,9 @@ private:
   vector<uint8_t> sysExBuffer;
   uint16_t activeSysExPort = MIDI_PORT_INVALID;
   uint16_t sysExReportPort = MIDI_PORT_INVALID;
+  bool telemetryViewEnabled = false;
+  uint32_t lastTelemetryRender = 0;
+  MatrixOS::Telemetry::Snapshot telemetry;
 
   void DrainInput();
   void DrainHID();
@@ -34,4 +38,7 @@ private:
   void HandleMIDIPacket(const MidiPacket& packet);
   void HandleSysExPacket(const MidiPacket& packet);
   void HandleSysExMessage(uint16_t port, const vector<uint8_t>& message);
+
+  void SetTelemetryView(bool enabled);
+  void RenderTelemetry();
 };
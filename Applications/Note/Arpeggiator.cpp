@@ -3,13 +3,18 @@
 #include <cstdlib>
 
 Arpeggiator::Arpeggiator(ArpeggiatorConfig* cfg) {
+  // Reserve up front so steady-state clock ticks don't touch the heap
+  notePool.reserve(ARP_RESERVED_NOTES);
+  arpSequence.reserve(ARP_RESERVED_NOTES * 2);
+  gateOffQueue.reserve(ARP_RESERVED_NOTES);
+
   if (cfg != nullptr)
   {
     UpdateConfig(cfg);
   }
 }
 
-void Arpeggiator::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
+void Arpeggiator::Tick(MidiPacketSpan input, MidiPacketBuffer& output) {
   if (disableOnNextTick)
   {
     disableOnNextTick = false;
@@ -67,7 +72,7 @@ void Arpeggiator::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
     {
       const GateOffEvent& event = gateOffQueue.front();
       output.push_back(MidiPacket::NoteOff(event.channel, event.note, 0));
-      gateOffQueue.pop_front();
+      gateOffQueue.erase(gateOffQueue.begin());
     }
 
     // If notePool was empty but now has notes, force start
@@ -105,7 +110,7 @@ void Arpeggiator::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
   }
 }
 
-void Arpeggiator::ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& output) {
+void Arpeggiator::ProcessNoteOn(const MidiPacket& packet, [[maybe_unused]] MidiPacketBuffer& output) {
   uint8_t note = packet.Note();
   uint8_t velocity = packet.Velocity();
   uint8_t channel = packet.Channel();
@@ -129,7 +134,7 @@ void Arpeggiator::ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& out
   }
 }
 
-void Arpeggiator::ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& output) {
+void Arpeggiator::ProcessNoteOff(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t note = packet.Note();
 
   // Remove from note pool
@@ -161,7 +166,7 @@ void Arpeggiator::ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& ou
   }
 }
 
-void Arpeggiator::ProcessAfterTouch(const MidiPacket& packet, deque<MidiPacket>& output) {
+void Arpeggiator::ProcessAfterTouch(const MidiPacket& packet, [[maybe_unused]] MidiPacketBuffer& output) {
   uint8_t note = packet.Note();
   uint8_t velocity = packet.Velocity();
 
@@ -612,7 +617,7 @@ void Arpeggiator::UpdateSequence() {
   }
 }
 
-void Arpeggiator::StepArpeggiator(deque<MidiPacket>& output) {
+void Arpeggiator::StepArpeggiator(MidiPacketBuffer& output) {
   if (arpSequence.empty())
   {
     return;
@@ -3,9 +3,10 @@
 #include "MatrixOS.h"
 #include "MidiEffect.h"
 #include <vector>
-#include <deque>
 #include <map>
 
+#define ARP_RESERVED_NOTES 32 // Held notes the arpeggiator reserves storage for
+
 enum ArpDirection {
   ARP_UP,
   ARP_DOWN,
@@ -85,7 +86,7 @@ private:
     uint8_t channel;
   };
 
-  deque<GateOffEvent> gateOffQueue; // Chronologically ordered queue of gate-off events
+  vector<GateOffEvent> gateOffQueue; // Chronologically ordered queue of gate-off events, only a few entries deep
 
   bool disableOnNextTick = false;
 
@@ -94,11 +95,11 @@ private:
   uint8_t lastSequenceIndex = 0; // Track last index to detect sequence completion
 
   // Helper functions
-  void ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessAfterTouch(const MidiPacket& packet, deque<MidiPacket>& output);
+  void ProcessNoteOn(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessNoteOff(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessAfterTouch(const MidiPacket& packet, MidiPacketBuffer& output);
   void UpdateSequence();
-  void StepArpeggiator(deque<MidiPacket>& output);
+  void StepArpeggiator(MidiPacketBuffer& output);
   void CalculateTicksPerStep();
   void GenerateEuclideanMap();
 
@@ -113,7 +114,7 @@ public:
 
   Arpeggiator(ArpeggiatorConfig* cfg);
 
-  void Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) override;
+  void Tick(MidiPacketSpan input, MidiPacketBuffer& output) override;
   void Reset() override;
   void SetEnabled(bool state) override;
 
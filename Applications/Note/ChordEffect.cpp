@@ -1,7 +1,7 @@
 #include "ChordEffect.h"
 #include <algorithm>
 
-void ChordEffect::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
+void ChordEffect::Tick(MidiPacketSpan input, MidiPacketBuffer& output) {
   if (disableOnNextTick)
   {
     disableOnNextTick = false;
@@ -50,7 +50,7 @@ void ChordEffect::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
   };
 }
 
-void ChordEffect::ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& output) {
+void ChordEffect::ProcessNoteOn(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t root = packet.Note();
   uint8_t velocity = packet.Velocity();
   uint8_t channel = packet.Channel();
@@ -98,7 +98,7 @@ void ChordEffect::ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& out
   }
 }
 
-void ChordEffect::ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& output) {
+void ChordEffect::ProcessNoteOff(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t root = packet.Note();
   uint8_t channel = packet.Channel();
 
@@ -121,7 +121,7 @@ void ChordEffect::ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& ou
   noteOrder.erase(std::remove(noteOrder.begin(), noteOrder.end(), root), noteOrder.end());
 }
 
-void ChordEffect::ProcessAfterTouch(const MidiPacket& packet, deque<MidiPacket>& output) {
+void ChordEffect::ProcessAfterTouch(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t root = packet.Note();
   uint8_t velocity = packet.Velocity();
   uint8_t channel = packet.Channel();
@@ -231,7 +231,7 @@ void ChordEffect::CalculateChord() {
   }
 }
 
-void ChordEffect::ReleaseAllChords(deque<MidiPacket>& output) {
+void ChordEffect::ReleaseAllChords(MidiPacketBuffer& output) {
   // Go through all keys in noteOwner and send note off
   for (auto& pair : noteOwner)
   {
@@ -245,7 +245,7 @@ void ChordEffect::ReleaseAllChords(deque<MidiPacket>& output) {
   noteOrder.clear();
 }
 
-void ChordEffect::UpdateChords(deque<MidiPacket>& output) {
+void ChordEffect::UpdateChords(MidiPacketBuffer& output) {
   CalculateChord();
 
   // Build new ownership map and chord notes for all roots
@@ -40,9 +40,9 @@ private:
   uint8_t lastChannel = 0;
 
   // Helper functions
-  void ProcessNoteOn(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessNoteOff(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessAfterTouch(const MidiPacket& packet, deque<MidiPacket>& output);
+  void ProcessNoteOn(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessNoteOff(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessAfterTouch(const MidiPacket& packet, MidiPacketBuffer& output);
   vector<uint8_t> BuildChordFromNote(uint8_t root);
   void CalculateChord();
 
@@ -50,12 +50,12 @@ public:
   int8_t inversion = 0;
   ChordCombo chordCombo = {0};
 
-  void Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) override;
+  void Tick(MidiPacketSpan input, MidiPacketBuffer& output) override;
   void Reset() override;
   void SetEnabled(bool state) override;
   void ClearChord();
   void SetChordCombo(ChordCombo combo);
-  void ReleaseAllChords(deque<MidiPacket>& output);
-  void UpdateChords(deque<MidiPacket>& output);
+  void ReleaseAllChords(MidiPacketBuffer& output);
+  void UpdateChords(MidiPacketBuffer& output);
   void SetInversion(int8_t inversion);
 };
\ No newline at end of file
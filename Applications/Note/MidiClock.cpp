@@ -20,22 +20,27 @@ uint32_t MidiClock::TickCount() {
   return tick_count;
 }
 
+uint32_t MidiClock::UsUntilNextTick() {
+  uint32_t elapsed = (uint32_t)MatrixOS::SYS::Micros() - last_tick;
+  return elapsed >= pulse_length ? 0 : pulse_length - elapsed;
+}
+
+// Advances one pulse per call, call until it returns false to catch up on every pulse that has elapsed
 bool MidiClock::Tick() {
   uint32_t micros = MatrixOS::SYS::Micros();
   uint32_t elapsed = micros - last_tick;
 
   if (elapsed >= pulse_length)
   {
-
-    if (elapsed >= pulse_length * 2)
+    if (elapsed >= pulse_length * ppqn)
     {
-      // If we've fallen behind significantly (missed multiple ticks), resync
+      // More than a beat behind (stalled or just started), resync instead of bursting the backlog
       last_tick = micros;
     }
     else
     {
-      // Normal tick, maintain consistent timing by adding pulse_length
-      last_tick = micros;
+      // Step from the previous pulse so late calls don't drift the tempo
+      last_tick += pulse_length;
     }
     tick_count++;
     return true;
@@ -16,5 +16,6 @@ public:
   uint8_t PPQN();
   void SetBPM(uint16_t bpm);
   uint32_t TickCount();
+  uint32_t UsUntilNextTick();
   bool Tick();
 };
\ No newline at end of file
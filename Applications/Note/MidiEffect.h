@@ -1,6 +1,7 @@
 #pragma once
 
 #include "MatrixOS.h"
+#include "MidiPacketBuffer.h"
 
 #define EFFECT_TPQN 96 // Tick per quarter note
 
@@ -12,10 +13,10 @@ protected:
 public:
   virtual ~MidiEffect() = default;
 
-  // Process input array and populate output array
-  // Input: packets to process (can be empty for generators like arpeggiator/LFO)
-  // Output: processed packets (effect should append to this)
-  virtual void Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) = 0;
+  // Process input packets and populate output buffer
+  // Input: view of packets to process (can be empty for generators like arpeggiator/LFO)
+  // Output: fixed-capacity buffer owned by the pipeline (effect should append to this, packets past capacity are dropped)
+  virtual void Tick(MidiPacketSpan input, MidiPacketBuffer& output) = 0;
 
   // Called when effect is reset - cleanup state
   virtual void Reset() {}
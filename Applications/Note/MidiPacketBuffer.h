@@ -0,0 +1,93 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#define MIDI_PIPELINE_BUFFER_SIZE 64 // Packets each pipeline stage can hold per tick
+
+// Read-only view over a run of packets. Effects iterate it like a container.
+class MidiPacketSpan {
+private:
+  const MidiPacket* data;
+  size_t length;
+
+public:
+  MidiPacketSpan(const MidiPacket* data, size_t length) : data(data), length(length) {}
+
+  const MidiPacket* begin() const {
+    return data;
+  }
+  const MidiPacket* end() const {
+    return data + length;
+  }
+  size_t size() const {
+    return length;
+  }
+  bool empty() const {
+    return length == 0;
+  }
+};
+
+// Fixed-capacity packet FIFO with inline storage. Never allocates; packets pushed while full are dropped and counted.
+// Unread packets are moved back to the front only when space runs out, so a buffer that is drained every tick stays linear.
+class MidiPacketBuffer {
+private:
+  MidiPacket packets[MIDI_PIPELINE_BUFFER_SIZE];
+  uint16_t head = 0;
+  uint16_t tail = 0;
+  uint32_t dropped = 0;
+
+public:
+  bool push_back(const MidiPacket& packet) {
+    if (tail == MIDI_PIPELINE_BUFFER_SIZE)
+    {
+      if (head == 0)
+      {
+        dropped++;
+        return false;
+      }
+      std::copy(packets + head, packets + tail, packets);
+      tail -= head;
+      head = 0;
+    }
+    packets[tail++] = packet;
+    return true;
+  }
+
+  bool pop_front(MidiPacket& packet) {
+    if (head == tail)
+    {
+      return false;
+    }
+    packet = packets[head++];
+    if (head == tail)
+    {
+      head = tail = 0;
+    }
+    return true;
+  }
+
+  void clear() {
+    head = tail = 0;
+  }
+
+  const MidiPacket* begin() const {
+    return packets + head;
+  }
+  const MidiPacket* end() const {
+    return packets + tail;
+  }
+  size_t size() const {
+    return tail - head;
+  }
+  bool empty() const {
+    return head == tail;
+  }
+
+  MidiPacketSpan View() const {
+    return MidiPacketSpan(packets + head, tail - head);
+  }
+
+  uint32_t Dropped() const {
+    return dropped;
+  }
+};
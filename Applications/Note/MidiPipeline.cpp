@@ -5,42 +5,51 @@ void MidiPipeline::Send(const MidiPacket& packet) {
 }
 
 bool MidiPipeline::Get(MidiPacket& packet) {
-  if (outputQueue.empty())
-  {
-    return false;
-  }
-  packet = outputQueue.front();
-  outputQueue.pop_front();
-  return true;
+  return outputQueue.pop_front(packet);
 }
 
-void MidiPipeline::Tick() {
-  if (effects.empty())
-  {
-    // No effects, direct passthrough
-    outputQueue.insert(outputQueue.end(), std::make_move_iterator(inputQueue.begin()), std::make_move_iterator(inputQueue.end()));
-    inputQueue.clear();
-    return;
-  }
+MidiPacketSpan MidiPipeline::Output() const {
+  return outputQueue.View();
+}
 
-  std::deque<MidiPacket> effectInput;
-  std::deque<MidiPacket> effectOutput;
+void MidiPipeline::ClearOutput() {
+  outputQueue.clear();
+}
 
-  // Start with inputQueue as effectOutput
-  effectOutput.swap(inputQueue);
+void MidiPipeline::Tick() {
+  MidiPacketBuffer* stageInput = &inputQueue;
+  MidiPacketBuffer* stageOutput = &stageBuffers[0];
 
-  for (MidiEffect* effect : effects)
+  for (size_t i = 0; i < effects.size(); i++)
   {
-    if (effect->IsEnabled())
+    if (!effects[i]->IsEnabled())
     {
-      effectInput.swap(effectOutput); // take previous output as new input
-      effectOutput.clear();            // prepare output buffer
-      effect->Tick(effectInput, effectOutput);
+      continue;
     }
+
+    stageOutput->clear();
+    uint64_t start = MatrixOS::SYS::Micros();
+    effects[i]->Tick(stageInput->View(), *stageOutput);
+    uint32_t elapsed = (uint32_t)(MatrixOS::SYS::Micros() - start);
+
+    MidiEffectStats& stats = effectStats[i];
+    stats.ticks++;
+    stats.lastMicros = elapsed;
+    stats.totalMicros += elapsed;
+    if (elapsed > stats.maxMicros)
+    {
+      stats.maxMicros = elapsed;
+    }
+
+    stageInput->clear();
+
+    // Previous output becomes the next input
+    stageInput = stageOutput;
+    stageOutput = (stageOutput == &stageBuffers[0]) ? &stageBuffers[1] : &stageBuffers[0];
   }
 
   // Update note states and move final output to main queue
-  for (const MidiPacket& packet : effectOutput)
+  for (const MidiPacket& packet : *stageInput)
   {
     // Track note on/off states
     if (packet.status == NoteOn && packet.Velocity() > 0)
@@ -51,10 +60,10 @@ void MidiPipeline::Tick() {
     {
       SetNoteState(packet.Note(), false);
     }
+    outputQueue.push_back(packet);
   }
 
-  outputQueue.insert(outputQueue.end(), std::make_move_iterator(effectOutput.begin()), std::make_move_iterator(effectOutput.end()));
-  effectOutput.clear();
+  stageInput->clear();
 }
 
 int32_t MidiPipeline::AddEffect(const string& key, MidiEffect* effect, const string& addAfter) {
@@ -63,6 +72,7 @@ int32_t MidiPipeline::AddEffect(const string& key, MidiEffect* effect, const str
     // Add to front
     effectKeys.insert(effectKeys.begin(), key);
     effects.insert(effects.begin(), effect);
+    effectStats.insert(effectStats.begin(), MidiEffectStats());
     return 0;
   }
   else if (addAfter == "tail" || addAfter.empty())
@@ -70,6 +80,7 @@ int32_t MidiPipeline::AddEffect(const string& key, MidiEffect* effect, const str
     // Add to back (default)
     effectKeys.push_back(key);
     effects.push_back(effect);
+    effectStats.push_back(MidiEffectStats());
     return static_cast<int32_t>(effectKeys.size() - 1);
   }
   else
@@ -81,6 +92,7 @@ int32_t MidiPipeline::AddEffect(const string& key, MidiEffect* effect, const str
       {
         effectKeys.insert(effectKeys.begin() + i + 1, key);
         effects.insert(effects.begin() + i + 1, effect);
+        effectStats.insert(effectStats.begin() + i + 1, MidiEffectStats());
         return static_cast<int32_t>(i + 1);
       }
     }
@@ -96,6 +108,7 @@ void MidiPipeline::RemoveEffect(const string& key) {
     {
       effectKeys.erase(effectKeys.begin() + i);
       effects.erase(effects.begin() + i);
+      effectStats.erase(effectStats.begin() + i);
       break;
     }
   }
@@ -114,6 +127,7 @@ void MidiPipeline::Reset() {
 void MidiPipeline::Clear() {
   effectKeys.clear();
   effects.clear();
+  effectStats.clear();
   inputQueue.clear();
   outputQueue.clear();
   memset(noteStates, 0, sizeof(noteStates));
@@ -152,3 +166,18 @@ bool MidiPipeline::IsNoteActive(uint8_t note) const {
   }
   return false;
 }
+
+const MidiEffectStats* MidiPipeline::GetEffectStats(const string& key) const {
+  for (size_t i = 0; i < effectKeys.size(); ++i)
+  {
+    if (effectKeys[i] == key)
+    {
+      return &effectStats[i];
+    }
+  }
+  return nullptr;
+}
+
+uint32_t MidiPipeline::GetDroppedPackets() const {
+  return inputQueue.Dropped() + outputQueue.Dropped() + stageBuffers[0].Dropped() + stageBuffers[1].Dropped();
+}
\ No newline at end of file
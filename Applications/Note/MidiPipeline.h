@@ -2,15 +2,26 @@
 
 #include "MatrixOS.h"
 #include "MidiEffect.h"
+#include "MidiPacketBuffer.h"
+
+// Processing time of one effect, measured around each of its Tick calls
+struct MidiEffectStats {
+  uint32_t ticks = 0;
+  uint32_t lastMicros = 0;
+  uint32_t maxMicros = 0;
+  uint64_t totalMicros = 0;
+};
 
 // Pipeline manager class - minimal and efficient
 class MidiPipeline {
 private:
-  vector<string> effectKeys;     // Effect keys in order
-  vector<MidiEffect*> effects;   // Effects in same order
-  deque<MidiPacket> inputQueue;  // Input queue
-  deque<MidiPacket> outputQueue; // Output queue
-  uint8_t noteStates[16] = {0};  // Bitmap tracking active notes (each bit represents a note)
+  vector<string> effectKeys;           // Effect keys in order
+  vector<MidiEffect*> effects;         // Effects in same order
+  vector<MidiEffectStats> effectStats; // Stats in same order
+  MidiPacketBuffer inputQueue;         // Input queue
+  MidiPacketBuffer outputQueue;        // Output queue
+  MidiPacketBuffer stageBuffers[2];    // Ping-pong buffers passed between effects
+  uint8_t noteStates[16] = {0};        // Bitmap tracking active notes (each bit represents a note)
 
   // Private note state management
   void SetNoteState(uint8_t note, bool on);
@@ -22,6 +33,10 @@ public:
   // Get packet from output queue
   bool Get(MidiPacket& packet);
 
+  // View of every packet in the output queue, valid until the next Tick or ClearOutput
+  MidiPacketSpan Output() const;
+  void ClearOutput();
+
   // Process all input queue packets and call Tick on all effects
   void Tick();
 
@@ -47,4 +62,10 @@ public:
 
   // Public note state queries
   bool IsNoteActive(uint8_t note) const;
+
+  // Get processing time stats for an effect, nullptr if key is not in the chain
+  const MidiEffectStats* GetEffectStats(const string& key) const;
+
+  // Packets dropped because a pipeline buffer was full
+  uint32_t GetDroppedPackets() const;
 };
\ No newline at end of file
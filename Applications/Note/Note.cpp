@@ -265,6 +265,8 @@ void Note::Setup(const vector<string>& args) {
   });
 
   actionMenu.SetGlobalLoopFunc([&]() -> void { Tick(); });
+  // Round up, a sub-ms wait would spin. Tick() catches up on the pulse that's up to a ms late.
+  actionMenu.SetGlobalLoopWaitFunc([&]() -> uint32_t { return (midiClock.UsUntilNextTick() + 999) / 1000; });
 
   actionMenu.AllowExit(false);
   actionMenu.SetSetupFunc([&]() -> void { PlayView(); });
@@ -1871,7 +1873,7 @@ void Note::SaveConfigs() {
 }
 
 void Note::Tick() {
-  if (midiClock.Tick())
+  while (midiClock.Tick())
   {
     if (clockMode == CLOCK_INTERNAL_CLOCKOUT && midiClock.TickCount() % (EFFECT_TPQN / 24) == 0)
     {
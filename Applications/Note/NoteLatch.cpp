@@ -1,7 +1,7 @@
 #include "NoteLatch.h"
 #include <algorithm>
 
-void NoteLatch::Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) {
+void NoteLatch::Tick(MidiPacketSpan input, MidiPacketBuffer& output) {
   // Check if we need to disable and release latched notes
   if (disableOnNextTick)
   {
@@ -69,7 +69,7 @@ void NoteLatch::SetToggleMode(bool enable) {
   }
 }
 
-void NoteLatch::ProcessNoteMessage(const MidiPacket& packet, deque<MidiPacket>& output) {
+void NoteLatch::ProcessNoteMessage(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t note = packet.Note();
   lastChannel = packet.Channel();
 
@@ -106,7 +106,7 @@ void NoteLatch::ProcessNoteMessage(const MidiPacket& packet, deque<MidiPacket>&
   }
 }
 
-void NoteLatch::ProcessNoteMessageToggleMode(const MidiPacket& packet, deque<MidiPacket>& output) {
+void NoteLatch::ProcessNoteMessageToggleMode(const MidiPacket& packet, MidiPacketBuffer& output) {
   uint8_t note = packet.Note();
 
   if (packet.status == NoteOn && packet.Velocity() > 0)
@@ -134,7 +134,7 @@ void NoteLatch::ProcessNoteMessageToggleMode(const MidiPacket& packet, deque<Mid
   }
 }
 
-void NoteLatch::ReleaseAllLatchedNotes(deque<MidiPacket>& output) {
+void NoteLatch::ReleaseAllLatchedNotes(MidiPacketBuffer& output) {
   // Send note off for all latched notes
   for (uint8_t note : latchedNotes)
   {
@@ -15,7 +15,7 @@ private:
   uint8_t lastChannel = 0;
 
 public:
-  void Tick(deque<MidiPacket>& input, deque<MidiPacket>& output) override;
+  void Tick(MidiPacketSpan input, MidiPacketBuffer& output) override;
   void Reset() override;
   void SetEnabled(bool state) override;
   void SetToggleMode(bool enable);
@@ -24,9 +24,9 @@ public:
   }
 
 private:
-  void ProcessNoteMessage(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessAfterTouch(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessNoteMessageToggleMode(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ProcessAfterTouchToggleMode(const MidiPacket& packet, deque<MidiPacket>& output);
-  void ReleaseAllLatchedNotes(deque<MidiPacket>& output);
+  void ProcessNoteMessage(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessAfterTouch(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessNoteMessageToggleMode(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ProcessAfterTouchToggleMode(const MidiPacket& packet, MidiPacketBuffer& output);
+  void ReleaseAllLatchedNotes(MidiPacketBuffer& output);
 };
\ No newline at end of file
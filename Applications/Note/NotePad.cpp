@@ -418,7 +418,7 @@ void NotePad::FirstScan(Point origin) {
   }
 }
 
-bool NotePad::RenderRootNScale(Point origin) {
+bool NotePad::RenderRootNScale(MatrixOS::LED::Canvas& canvas) {
   uint8_t index = 0;
   Color color_dim = rt->config->useWhiteAsOutOfScale ? Color(0x202020) : rt->config->color.Dim(32);
   for (int8_t y = 0; y < dimension.y; y++)
@@ -426,38 +426,38 @@ bool NotePad::RenderRootNScale(Point origin) {
     for (int8_t x = 0; x < dimension.x; x++)
     {
       uint8_t note = noteMap[index];
-      Point globalPos = origin + Point(x, y);
       if (note == 255)
       {
-        MatrixOS::LED::SetColor(globalPos, Color(0));
+        frame[index] = Color(0);
       }
       else if (IsNoteActive(note) || rt->midiPipeline.IsNoteActive(note) || IsNoteHighlighted(note))
       { // If find the note is currently active. Show it as white
-        MatrixOS::LED::SetColor(globalPos, Color::White);
+        frame[index] = Color::White;
       }
       else
       {
         uint8_t inScale = InScale(note); // Check if the note is in scale.
         if (inScale == OFF_SCALE_NOTE)
         {
-          MatrixOS::LED::SetColor(globalPos, color_dim);
+          frame[index] = color_dim;
         }
         else if (inScale == SCALE_NOTE)
         {
-          MatrixOS::LED::SetColor(globalPos, rt->config->color);
+          frame[index] = rt->config->color;
         }
         else if (inScale == ROOT_NOTE)
         {
-          MatrixOS::LED::SetColor(globalPos, rt->config->rootColor);
+          frame[index] = rt->config->rootColor;
         }
       }
       index++;
     }
   }
+  canvas.SetRect(Point(0, 0), dimension, frame.data());
   return true;
 }
 
-bool NotePad::RenderColorPerKey(Point origin) {
+bool NotePad::RenderColorPerKey(MatrixOS::LED::Canvas& canvas) {
   uint8_t index = 0;
   const Color* colorMap;
   if (rt->config->colorMode == COLOR_PER_KEY_POLY)
@@ -478,14 +478,13 @@ bool NotePad::RenderColorPerKey(Point origin) {
     for (int8_t x = 0; x < dimension.x; x++)
     {
       uint8_t note = noteMap[index];
-      Point globalPos = origin + Point(x, y);
       if (note == 255)
       {
-        MatrixOS::LED::SetColor(globalPos, Color(0));
+        frame[index] = Color(0);
       }
       else if (IsNoteActive(note) || rt->midiPipeline.IsNoteActive(note) || IsNoteHighlighted(note))
       { // If find the note is currently active. Show it as white
-        MatrixOS::LED::SetColor(globalPos, Color::White);
+        frame[index] = Color::White;
       }
       else
       {
@@ -493,33 +492,39 @@ bool NotePad::RenderColorPerKey(Point origin) {
         uint8_t inScale = InScale(note);
         if (inScale == OFF_SCALE_NOTE)
         {
-          MatrixOS::LED::SetColor(globalPos, rt->config->useWhiteAsOutOfScale ? Color(0x202020) : Color(colorMap[awayFromRoot]).Dim(32));
+          frame[index] = rt->config->useWhiteAsOutOfScale ? Color(0x202020) : Color(colorMap[awayFromRoot]).Dim(32);
         }
         else
         {
-          MatrixOS::LED::SetColor(globalPos, colorMap[awayFromRoot]);
+          frame[index] = colorMap[awayFromRoot];
         }
       }
       index++;
     }
   }
+  canvas.SetRect(Point(0, 0), dimension, frame.data());
   return true;
 }
 
 bool NotePad::Render(Point origin) {
+  return RenderCanvas(MatrixOS::LED::AcquireCanvas().View(origin));
+}
+
+bool NotePad::RenderCanvas(MatrixOS::LED::Canvas canvas) {
   if (first_scan)
   {
-    FirstScan(origin);
+    FirstScan(canvas.Origin());
     first_scan = false;
   }
+  frame.resize(dimension.Area()); // The whole pad is drawn into this and written in one go
   switch (rt->config->colorMode)
   {
   case ROOT_N_SCALE:
-    return RenderRootNScale(origin);
+    return RenderRootNScale(canvas);
     break;
   case COLOR_PER_KEY_POLY:
   case COLOR_PER_KEY_RAINBOW:
-    return RenderColorPerKey(origin);
+    return RenderColorPerKey(canvas);
     break;
   default:
     return false;
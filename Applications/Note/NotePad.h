@@ -81,10 +81,12 @@ struct NotePadRuntime {
 
   void Tick() {
     midiPipeline.Tick();
-    MidiPacket midiPacket;
-    while (midiPipeline.Get(midiPacket))
+    MidiPacketSpan output = midiPipeline.Output();
+    if (!output.empty())
     {
-      MatrixOS::MIDI::Send(midiPacket, MIDI_PORT_ALL);
+      // Chords and arpeggiator releases go out as one burst
+      MatrixOS::MIDI::SendBatch(output.begin(), output.size(), MIDI_PORT_ALL);
+      midiPipeline.ClearOutput();
     }
   }
 };
@@ -93,6 +95,7 @@ class NotePad : public UIComponent {
 public:
   Dimension dimension;
   std::vector<uint8_t> noteMap;
+  std::vector<Color> frame;
   uint16_t c_aligned_scale_map;
   NotePadRuntime* rt;
   bool first_scan = true;
@@ -129,12 +132,13 @@ public:
   void GeneratePianoKeymap();
   void GenerateKeymap();
 
-  bool RenderRootNScale(Point origin);
-  bool RenderColorPerKey(Point origin);
+  bool RenderRootNScale(MatrixOS::LED::Canvas& canvas);
+  bool RenderColorPerKey(MatrixOS::LED::Canvas& canvas);
 
   void FirstScan(Point origin);
 
   virtual bool Render(Point origin) override;
+  virtual bool RenderCanvas(MatrixOS::LED::Canvas canvas) override;
   virtual bool KeyEvent(Point xy, KeypadInfo* keypadInfo) override;
 
   void SetDimension(Dimension dimension);
@@ -5,8 +5,16 @@ void Performance::Setup(const vector<string>& args) {
   canvasLedLayer = MatrixOS::LED::CurrentLayer();
   currentKeymap = 0;
   was_combo_key = 0;
-  sysExOverflow = false;
-  sysExBuffer.clear();
+  sysExPending.clear();
+  sysExSkipping.clear();
+  sysExQueue.clear();
+  sysExQueuedBytes = 0;
+  sysExDropped = 0;
+  if (sysExQueueMutex == nullptr)
+  {
+    sysExQueueMutex = xSemaphoreCreateMutex();
+  }
+  MatrixOS::MIDI::AddSysExHandler(PERFORMANCE_SYSEX_PREFIX, sizeof(PERFORMANCE_SYSEX_PREFIX), SysExCallback, this);
 
   for (uint8_t note = 0; note < 128; note++)
   {
@@ -51,6 +59,19 @@ void Performance::Loop() {
     MidiEventHandler(midiPacket);
     midiPacketsProcessed++;
   }
+
+  ProcessSysEx();
+}
+
+void Performance::End() {
+  // Once removed the MIDI task can't be inside the handler any more, so the queue can go
+  MatrixOS::MIDI::RemoveSysExHandler(SysExCallback, this);
+  if (sysExQueueMutex != nullptr)
+  {
+    vSemaphoreDelete(sysExQueueMutex);
+    sysExQueueMutex = nullptr;
+  }
+  sysExQueue.clear();
 }
 
 void Performance::MidiEventHandler(MidiPacket& midiPacket) {
@@ -65,10 +86,6 @@ void Performance::MidiEventHandler(MidiPacket& midiPacket) {
   case NoteOff:
     NoteHandler(midiPacket.Channel(), midiPacket.Note(), 0);
     break;
-  case SysExData:
-  case SysExEnd:
-    SysExHandler(midiPacket);
-    break;
   default:
     break;
   }
@@ -232,96 +249,156 @@ static void ApplyApolloIndex(uint8_t index, Color color, uint8_t targetLayer) {
   }
 }
 
-void Performance::SysExHandler(MidiPacket midiPacket) {
-  uint8_t packetLength = midiPacket.Length();
-  if (packetLength == 0)
+bool Performance::SysExCallback(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context) {
+  return static_cast<Performance*>(context)->SysExHandler(port, data, length, flags);
+}
+
+// On the MIDI task, hands the chunk over to the app task
+bool Performance::SysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags) {
+  // The MIDI task holds the SysEx assembler while it's in here. Never wait on the app task for long, it may be
+  // suspended by an app exit while holding the queue.
+  if (xSemaphoreTake(sysExQueueMutex, pdMS_TO_TICKS(PERFORMANCE_SYSEX_QUEUE_WAIT_MS)) != pdTRUE)
   {
-    return;
+    sysExDropped++;
+    MLOGW("Performance", "SysEx queue busy, dropped message (%lu dropped)", sysExDropped);
+    return false;
   }
-
-  if (sysExBuffer.capacity() < MAX_PERFORMANCE_SYSEX_SIZE)
+  bool queued = (flags & SYSEX_CHUNK_ABORT) || sysExQueuedBytes + length <= MAX_PERFORMANCE_SYSEX_QUEUED;
+  if (queued)
+  {
+    sysExQueue.push_back({port, flags, vector<uint8_t>(data, data + length)});
+    sysExQueuedBytes += length;
+  }
+  else
   {
-    sysExBuffer.reserve(MAX_PERFORMANCE_SYSEX_SIZE);
+    // Loop is falling behind. Abort the message so the part already queued isn't left hanging.
+    sysExDropped++;
+    MLOGW("Performance", "SysEx queue full, dropped message (%lu dropped)", sysExDropped);
+    sysExQueue.push_back({port, SYSEX_CHUNK_ABORT, {}});
   }
+  xSemaphoreGive(sysExQueueMutex);
+  MatrixOS::SYS::WakeApp();
+  return queued;
+}
 
-  if (sysExOverflow)
+void Performance::ProcessSysEx() {
+  while (true)
   {
-    if (midiPacket.status == SysExEnd)
+    xSemaphoreTake(sysExQueueMutex, portMAX_DELAY);
+    if (sysExQueue.empty())
     {
-      sysExOverflow = false;
+      xSemaphoreGive(sysExQueueMutex);
+      return;
+    }
+    SysExChunk chunk = std::move(sysExQueue.front());
+    sysExQueue.pop_front();
+    sysExQueuedBytes -= chunk.data.size();
+    xSemaphoreGive(sysExQueueMutex);
+
+    // The MIDI task skips the rest of a message once a chunk is refused, the queue may still hold chunks that came before
+    if (chunk.flags & SYSEX_CHUNK_START)
+    {
+      sysExSkipping.erase(chunk.port);
+    }
+    else if (sysExSkipping.count(chunk.port))
+    {
+      continue;
+    }
+
+    if (!ApplySysExChunk(chunk.port, chunk.data.data(), chunk.data.size(), chunk.flags))
+    {
+      sysExSkipping.insert(chunk.port);
     }
-    return;
   }
+}
 
-  if (sysExBuffer.size() + packetLength > MAX_PERFORMANCE_SYSEX_SIZE)
+// Records are applied as soon as they arrive, so messages of any length stream through a small per port buffer.
+// Returns false to skip the rest of the message.
+bool Performance::ApplySysExChunk(uint16_t port, const uint8_t* data, size_t length, uint8_t flags) {
+  if (flags & SYSEX_CHUNK_ABORT)
   {
-    MLOGW("Performance", "Dropped oversized SysEx message");
-    sysExBuffer.clear();
-    sysExOverflow = midiPacket.status != SysExEnd;
-    return;
+    sysExPending.erase(port);
+    return false;
   }
 
-  sysExBuffer.insert(sysExBuffer.end(), midiPacket.data, midiPacket.data + packetLength);
+  vector<uint8_t>& message = sysExPending[port];
+  if (flags & SYSEX_CHUNK_START)
+  {
+    message.clear();
+    data += sizeof(PERFORMANCE_SYSEX_PREFIX);
+    length -= sizeof(PERFORMANCE_SYSEX_PREFIX);
+  }
 
-  if (midiPacket.status != SysExEnd)
+  bool end = flags & SYSEX_CHUNK_END;
+  if (end)
   {
-    return;
+    if (length == 0 || data[length - 1] != MIDIv1_SYSEX_END)
+    {
+      sysExPending.erase(port);
+      return false;
+    }
+    length--;
   }
 
-  if (sysExBuffer.empty() || sysExBuffer.back() != MIDIv1_SYSEX_END)
+  message.insert(message.end(), data, data + length);
+  if (message.empty())
   {
-    sysExBuffer.clear();
-    return;
+    return !end;
   }
 
-  sysExBuffer.pop_back();
-  if (sysExBuffer.empty())
+  // Header is the command byte, plus the sub command and palette for Retina palette writes
+  size_t header = message[0] == 0x41 ? (message.size() >= 2 && message[1] == 0x3D ? 3 : 2) : 1;
+  if (message.size() < header && !end)
   {
-    sysExBuffer.clear();
-    return;
+    return true;
   }
 
-  switch (sysExBuffer[0])
+  size_t parsed = ParseSysEx(message, std::min(header, message.size()), end);
+  if (end)
   {
-  case 0x5f: // Apollo batch fill -
-             // https://github.com/mat1jaczyyy/lpp-performance-cfw/blob/0c2ec2a71030306ab7e5491bd49d72440d8c0199/src/sysex/sysex.c#L54-L120
+    sysExPending.erase(port);
+    return true;
+  }
+
+  if (parsed == SIZE_MAX || message.size() - parsed > MAX_PERFORMANCE_SYSEX_PENDING)
   {
-    // MLOGD("Performance", "Apollo batch Fill");
-    if (sysExBuffer.size() < 5)
-    {
-      break;
-    }
+    MLOGW("Performance", "Dropped malformed SysEx message");
+    sysExPending.erase(port);
+    return false;
+  }
+  message.erase(message.begin() + header, message.begin() + parsed);
+  return true;
+}
 
-    uint8_t targetLayer = uiOpened ? canvasLedLayer : 0;
+// Applies every complete record in message from start on. Returns where the first incomplete record begins, SIZE_MAX to drop the message.
+size_t Performance::ParseSysEx(const vector<uint8_t>& message, size_t start, bool end) {
+  uint8_t targetLayer = uiOpened ? canvasLedLayer : 0;
 
-    uint16_t ptr = 1; // Index 0 is the command 0x5f, we start ptr at 1
-    while (ptr < sysExBuffer.size())
+  switch (message[0])
+  {
+  case 0x5f: // Apollo batch fill -
+             // https://github.com/mat1jaczyyy/lpp-performance-cfw/blob/0c2ec2a71030306ab7e5491bd49d72440d8c0199/src/sysex/sysex.c#L54-L120
+  {
+    size_t ptr = start;
+    while (ptr + 3 <= message.size())
     {
-      if (ptr + 2 >= sysExBuffer.size())
-      {
-        break;
-      }
-
-      Color color = ApolloColorFrom6Bit(sysExBuffer[ptr], sysExBuffer[ptr + 1], sysExBuffer[ptr + 2]);
+      Color color = ApolloColorFrom6Bit(message[ptr], message[ptr + 1], message[ptr + 2]);
 
       // Get how many NN (Note Numbers) follows
-      uint8_t nCount = ((sysExBuffer[ptr] & 0x40) >> 4) | ((sysExBuffer[ptr + 1] & 0x40) >> 5) | ((sysExBuffer[ptr + 2] & 0x40) >> 6);
-
-      ptr += 3; // We finish reading the first 3 bit, inc the ptr by 3
+      uint8_t nCount = ((message[ptr] & 0x40) >> 4) | ((message[ptr + 1] & 0x40) >> 5) | ((message[ptr + 2] & 0x40) >> 6);
+      size_t notes = ptr + 3;
 
       // If nums of NN is 0, then the next byte is the number of NN
       if (nCount == 0)
       {
-        if (ptr >= sysExBuffer.size())
+        if (notes >= message.size())
         {
           break;
         }
-        nCount = sysExBuffer[ptr++];
-      } // If all 3 bits are 0, then it's 64 (0b111111
-
-      // MLOGD("Performance", "Color: #%.2X%.2X%.2X, NN count: %d", color.R, color.G, color.B, nCount);
+        nCount = message[notes++];
+      }
 
-      if (ptr + nCount > sysExBuffer.size())
+      if (notes + nCount > message.size())
       {
         break;
       }
@@ -329,99 +406,95 @@ void Performance::SysExHandler(MidiPacket midiPacket) {
       // Goes through all N
       for (uint16_t n = 0; n < nCount; n++)
       {
-        ApplyApolloIndex(sysExBuffer[ptr], color, targetLayer);
-        ptr++; // Since ptr is the pointer of in vector, we need to read the next NN, inc the ptr by 1
+        ApplyApolloIndex(message[notes + n], color, targetLayer);
       }
+      ptr = notes + nCount;
     }
-    break;
+    return ptr;
   }
   case 0x5e: // Apollo regular fill -
              // https://github.com/mat1jaczyyy/lpp-performance-cfw/blob/0c2ec2a71030306ab7e5491bd49d72440d8c0199/src/sysex/sysex.c#L115
   {
-    // MLOGD("Performance", "Apollo batch Fill");
-    if (sysExBuffer.size() < 5 || ((sysExBuffer.size() - 1) % 4) != 0)
+    size_t ptr = start;
+    while (ptr + 4 <= message.size())
     {
-      break;
-    }
-
-    uint8_t targetLayer = uiOpened ? canvasLedLayer : 0;
-
-    uint16_t ptr = 1; // Index 0 is the command 0x5f, we start ptr at 1
-    while (ptr + 3 < sysExBuffer.size())
-    {
-      uint8_t index = sysExBuffer[ptr];
-      Color color = ApolloColorFrom6Bit(sysExBuffer[ptr + 1], sysExBuffer[ptr + 2], sysExBuffer[ptr + 3]);
-
-      ptr += 4; // We finish reading the first 3 bit, inc the ptr by 3
-
-      // MLOGD("Performance", "Color: #%.2X%.2X%.2X, NN count: %d", color.R, color.G, color.B, nCount);
+      uint8_t index = message[ptr];
+      Color color = ApolloColorFrom6Bit(message[ptr + 1], message[ptr + 2], message[ptr + 3]);
       ApplyApolloIndex(index, color, targetLayer);
+      ptr += 4;
     }
-    break;
+    return ptr;
   }
   case 0x41: // Retina Custom Palette
   {
-    if (sysExBuffer.size() < 2)
+    if (message.size() < 2)
     {
-      break;
+      return start;
     }
 
-    if (sysExBuffer[1] == 0x7B) // Uploading Start
+    if (message[1] == 0x7B) // Uploading Start
     {
-      MLOGD("Performance", "Retina Custom Palette Uploading Start");
       // I really don't think I have to do anything here. I want to set custom_palette_available to false, but I don't think it's necessary
       // & we don't know which palette is gonna be write to
+      if (end)
+      {
+        MLOGD("Performance", "Retina Custom Palette Uploading Start");
+      }
+      return message.size();
     }
-    else if (sysExBuffer[1] == 0x3D) // Uploading Write
+    else if (message[1] == 0x3D) // Uploading Write
     {
-      if (sysExBuffer.size() < 3 || ((sysExBuffer.size() - 3) % 4) != 0)
+      if (message.size() < 3)
       {
-        break;
+        return start;
       }
 
-      MLOGD("Performance", "Retina Custom Palette Uploading Write");
-      uint8_t paletteToWrite = sysExBuffer[2];
+      uint8_t paletteToWrite = message[2];
       if (paletteToWrite >= CUSTOM_PALETTE_COUNT)
       {
-        break;
+        return SIZE_MAX;
       }
 
       // Read 4 byte at once
-      for (uint16_t i = 3; i < sysExBuffer.size(); i += 4)
+      size_t ptr = start;
+      while (ptr + 4 <= message.size())
       {
-        uint8_t index = sysExBuffer[i];
-        if (index >= 128)
+        uint8_t index = message[ptr];
+        if (index < 128)
         {
-          continue;
+          custom_palette[paletteToWrite][index] = ApolloColorFrom6Bit(message[ptr + 1], message[ptr + 2], message[ptr + 3]);
         }
+        ptr += 4;
+      }
 
-        Color color = ApolloColorFrom6Bit(sysExBuffer[i + 1], sysExBuffer[i + 2], sysExBuffer[i + 3]);
-        custom_palette[paletteToWrite][index] = color;
-
-        MLOGD("Performance", "Custom Palette %d Index %d Color %d %d %d", paletteToWrite, index, color.R, color.G, color.B);
+      if (end)
+      {
+        MLOGD("Performance", "Retina Custom Palette %d Uploading Write", paletteToWrite);
+        custom_palette_available[paletteToWrite] = true;
       }
-      custom_palette_available[paletteToWrite] = true;
+      return ptr;
     }
-    else if (sysExBuffer[1] == 0x7D) // Uploading End
+    else if (message[1] == 0x7D) // Uploading End
     {
-      MLOGD("Performance", "Retina Custom Palette Uploading End");
-      for (uint8_t i = 0; i < CUSTOM_PALETTE_COUNT; i++)
+      if (end)
       {
-        if (custom_palette_available[i])
+        MLOGD("Performance", "Retina Custom Palette Uploading End");
+        for (uint8_t i = 0; i < CUSTOM_PALETTE_COUNT; i++)
         {
-          MatrixOS::NVS::SetVariable(custom_palette_nvs_hash[i], custom_palette[i], sizeof(custom_palette[i]));
+          if (custom_palette_available[i])
+          {
+            MatrixOS::NVS::SetVariable(custom_palette_nvs_hash[i], custom_palette[i], sizeof(custom_palette[i]));
+          }
         }
+        MatrixOS::NVS::SetVariable(custom_palette_available_nvs_hash, custom_palette_available, sizeof(custom_palette_available));
       }
-      MatrixOS::NVS::SetVariable(custom_palette_available_nvs_hash, custom_palette_available, sizeof(custom_palette_available));
+      return message.size();
     }
-    break;
+    return SIZE_MAX;
   }
   default:
-    break;
+    return SIZE_MAX;
   }
-
-  // Clear buffer since we are done parsing SysEx
-  sysExBuffer.clear();
 }
 
 void Performance::InputEventHandler(InputEvent& inputEvent) {
@@ -742,6 +815,7 @@ void Performance::ActionMenu() {
       MidiEventHandler(midiPacket);
       midiPacketsProcessed++;
     }
+    ProcessSysEx();
   });
 
   actionMenu.SetInputEventHandler([&](InputEvent* inputEvent) -> bool {
@@ -6,6 +6,9 @@
 
 #include "UINotePad.h"
 
+#include <deque>
+#include <unordered_set>
+
 #define NUMS_OF_KEYMAP 1
 #define STFU_DEFAULT 1
 
@@ -40,18 +43,26 @@ public:
       StaticHash("203 Systems-Performance-Palette1"), StaticHash("203 Systems-Performance-Palette2"),
       StaticHash("203 Systems-Performance-Palette3"), StaticHash("203 Systems-Performance-Palette4")};
 
-static constexpr size_t MAX_PERFORMANCE_SYSEX_SIZE = 768;
+static constexpr uint8_t PERFORMANCE_SYSEX_PREFIX[] = {MIDIv1_SYSEX_START, 0x00, 0x02, 0x03, 0x4D, 0x58}; // Matrix OS application SysEx
+static constexpr size_t MAX_PERFORMANCE_SYSEX_PENDING = 512; // Unparsed bytes kept per port, more than any single record
+static constexpr size_t MAX_PERFORMANCE_SYSEX_QUEUED = 4096;  // SysEx bytes waiting for Loop, further messages are dropped
+static constexpr uint32_t PERFORMANCE_SYSEX_QUEUE_WAIT_MS = 5; // Longest the MIDI task waits on the queue lock before dropping
 static constexpr uint8_t MAX_PERFORMANCE_MIDI_PACKETS_PER_LOOP = 64;
 
   void Setup(const vector<string>& args) override;
   void Loop() override;
+  void End() override;
 
   Point NoteToXY(uint8_t note);
   int8_t XYToNote(Point xy, bool altmap = false);
 
   void MidiEventHandler(MidiPacket& midiPacket);
   void NoteHandler(uint8_t channel, uint8_t note, uint8_t velocity);
-  void SysExHandler(MidiPacket midiPacket);
+  static bool SysExCallback(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
+  bool SysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags);
+  void ProcessSysEx();
+  bool ApplySysExChunk(uint16_t port, const uint8_t* data, size_t length, uint8_t flags);
+  size_t ParseSysEx(const vector<uint8_t>& message, size_t start, bool end);
 
   void InputEventHandler(InputEvent& inputEvent);
 
@@ -358,8 +369,21 @@ static constexpr uint8_t MAX_PERFORMANCE_MIDI_PACKETS_PER_LOOP = 64;
   Color custom_palette[CUSTOM_PALETTE_COUNT][128];
 
 private:
-  vector<uint8_t> sysExBuffer;
-  bool sysExOverflow = false;
+  struct SysExChunk {
+    uint16_t port;
+    uint8_t flags;
+    vector<uint8_t> data;
+  };
+
+  // SysEx streams in on the MIDI task, which only queues it. The app task applies it, as it owns the palettes, LEDs and NVS.
+  SemaphoreHandle_t sysExQueueMutex = nullptr;
+  std::deque<SysExChunk> sysExQueue;
+  size_t sysExQueuedBytes = 0;
+  uint32_t sysExDropped = 0; // MIDI task only. Chunks refused because the queue was full or its lock wasn't free in time.
+
+  // App task only. Per port, the message header and any record that hasn't fully arrived yet, and ports whose message was dropped.
+  std::unordered_map<uint16_t, vector<uint8_t>> sysExPending;
+  std::unordered_set<uint16_t> sysExSkipping;
   int8_t stfuMap[128];
   Timer stfuTimer;
 };
@@ -218,6 +218,7 @@ const char* matrixos_python_get_runtime_debug_json() {
 
 void Python::Setup(const vector<string>& args) {
   activePythonInstance = this;
+  SetPolling(true); // Scripts and the REPL poll their own sources
   MLOGD("Python", "Setup start: args=%d free heap=%d largest block=%d", args.size(), xPortGetFreeHeapSize(), GetLargestRuntimeHeapBlock());
   matrixos_python_clear_input();
   if (!runtime.Init())
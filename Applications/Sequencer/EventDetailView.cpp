@@ -52,20 +52,24 @@ void EventDetailView::RebuildEventList() {
     return;
   }
 
+  RefreshEventRefs();
+}
+
+void EventDetailView::RefreshEventRefs() {
+  eventRefs.clear();
+  if (!pattern)
+  {
+    return;
+  }
+
   uint16_t pulsesPerStep = sequencer->sequence.GetPulsesPerStep();
   uint16_t startTime = position.step * pulsesPerStep;
   uint16_t endTime = startTime + pulsesPerStep - 1;
 
-  bool matchedSelection = false;
-
   auto it = pattern->events.lower_bound(startTime);
   while (it != pattern->events.end() && it->first <= endTime)
   {
     eventRefs.push_back(it);
-    if (selectedEventValid && it == selectedEventIter)
-    {
-      matchedSelection = true;
-    }
     ++it;
   }
 
@@ -73,17 +77,22 @@ void EventDetailView::RebuildEventList() {
   {
     selectedEventValid = false;
     sequencer->SetView(Sequencer::ViewMode::Sequencer);
+    return;
   }
-  else if (!matchedSelection)
+
+  // Selection is kept by position within the step
+  if (!selectedEventValid || selectedEventIndex >= eventRefs.size())
   {
-    selectedEventIter = eventRefs.front();
+    selectedEventIndex = 0;
     selectedEventValid = true;
   }
+  selectedEventIter = eventRefs[selectedEventIndex];
 }
 
 bool EventDetailView::KeyEvent(Point xy, KeypadInfo* keypadInfo) {
   SequenceScopedLock lock(sequencer->sequence);
 
+  RefreshEventRefs();
   if (eventRefs.empty())
   {
     sequencer->SetView(Sequencer::ViewMode::Sequencer);
@@ -137,6 +146,7 @@ bool EventDetailView::KeyEvent(Point xy, KeypadInfo* keypadInfo) {
 bool EventDetailView::Render(Point origin) {
   SequenceScopedLock lock(sequencer->sequence);
 
+  RefreshEventRefs();
   if (eventRefs.empty())
   {
     return false;
@@ -189,7 +199,7 @@ void EventDetailView::RenderEventSelector(Point origin) {
       }
 
       // Highlight selected event
-      if (selectedEventIter == eventRefs[x])
+      if (selectedEventValid && selectedEventIndex == x)
       {
         color = Color::Crossfade(color, Color::White, Fract16(0x9000));
       }
@@ -217,6 +227,7 @@ bool EventDetailView::EventSelectorKeyHandler(Point xy, KeypadInfo* keypadInfo)
         return DeleteEventAtIndex(xy.x);
       }
 
+      selectedEventIndex = xy.x;
       selectedEventIter = eventRefs[xy.x];
       selectedEventValid = true;
 
@@ -288,6 +299,7 @@ bool EventDetailView::DeleteEventAtIndex(uint8_t eventIndex) {
   }
 
   pattern->events.erase(eventIter);
+  pattern->Invalidate();
   selectedEventValid = false;
   sequencer->sequence.SetDirty();
   RebuildEventList();
@@ -349,8 +361,9 @@ bool EventDetailView::MicroStepSelectorKeyHandler(Point xy, KeypadInfo* keypadIn
       SequenceEvent eventData = eventIter->second;
       pattern->events.erase(eventIter);
       auto insertedIter = pattern->events.insert({targetTime, eventData});
+      pattern->Invalidate();
       sequencer->sequence.SetDirty();
-      selectedEventIter = insertedIter;
+      selectedEventIndex = std::distance(pattern->events.lower_bound(stepStartTime), insertedIter);
       selectedEventValid = true;
       RebuildEventList();
     }
@@ -538,6 +551,7 @@ bool EventDetailView::VelocitySelectorKeyHandler(Point xy, KeypadInfo* keypadInf
       noteData.velocity = std::clamp<uint8_t>(slotMin + 7, 1, 127);
     }
 
+    pattern->Invalidate();
     sequencer->sequence.SetDirty();
     return true;
   }
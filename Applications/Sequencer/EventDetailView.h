@@ -12,8 +12,10 @@ class EventDetailView : public UIComponent {
 
   bool wasEnabled = false;
 
-  vector<std::multimap<uint16_t, SequenceEvent>::iterator> eventRefs;
-  std::multimap<uint16_t, SequenceEvent>::iterator selectedEventIter;
+  // Iterators into the pattern are refreshed under the sequence lock before each use, since edits elsewhere invalidate them
+  vector<SequenceEventStore::iterator> eventRefs;
+  SequenceEventStore::iterator selectedEventIter;
+  uint8_t selectedEventIndex = 0;
   bool selectedEventValid = false;
   SequencePosition position;
   SequencePattern* pattern = nullptr;
@@ -36,6 +38,7 @@ public:
 
 private:
   void RebuildEventList();
+  void RefreshEventRefs();
 
   // Event selector (Y=0 row)
   void RenderEventSelector(Point origin);
@@ -125,6 +125,7 @@ bool PatternPad::KeyEvent(Point xy, KeypadInfo* keypadInfo) {
               pattern->events.insert({newTimestamp, it->second});
               ++it;
             }
+            pattern->Invalidate();
           }
           sequencer->SetMessage(SequencerMessage::COPIED);
         }
@@ -256,6 +257,10 @@ bool PatternPad::KeyEvent(Point xy, KeypadInfo* keypadInfo) {
 }
 
 bool PatternPad::Render(Point origin) {
+  return RenderCanvas(MatrixOS::LED::AcquireCanvas().View(origin));
+}
+
+bool PatternPad::RenderCanvas(MatrixOS::LED::Canvas canvas) {
   SequenceScopedLock lock(sequencer->sequence);
 
   uint8_t track = sequencer->track;
@@ -285,10 +290,10 @@ bool PatternPad::Render(Point origin) {
         for (uint8_t row = 0; row < 2; row++)
         {
           Point xy = Point(x, row);
-          MatrixOS::LED::SetColor(origin + xy, Color::Red.DimIfNot(lit));
+          canvas.SetColor(xy, Color::Red.DimIfNot(lit));
           if (TwoPatternMode())
           {
-            MatrixOS::LED::SetColor(origin + xy + Point(0, 2), Color::Red.DimIfNot(lit));
+            canvas.SetColor(xy + Point(0, 2), Color::Red.DimIfNot(lit));
           }
         }
       }
@@ -302,6 +307,12 @@ bool PatternPad::Render(Point origin) {
   uint8_t patternsToRender = TwoPatternMode() ? 2 : 1;
   Color trackColor = sequencer->meta.tracks[track].color;
 
+  SequenceNoteSet selectedNotes;
+  for (const auto& selected : sequencer->noteSelected)
+  {
+    selectedNotes.Set(selected.first);
+  }
+
   for (uint8_t i = 0; i < patternsToRender; i++)
   {
     uint8_t patternIdx = basePattern + i;
@@ -313,7 +324,7 @@ bool PatternPad::Render(Point origin) {
     }
 
     // Calculate origin for this pattern
-    Point patternOrigin = origin + Point(0, i * 2);
+    MatrixOS::LED::Canvas patternCanvas = canvas.View(Point(0, i * 2));
 
     // Render single pattern
     SequencePattern* pattern = sequencer->sequence.GetPattern(track, clip, patternIdx);
@@ -333,11 +344,9 @@ bool PatternPad::Render(Point origin) {
       whiteBase = true;
     }
 
-    for (uint8_t step = 0; step < pattern->steps; step++)
-    {
-      Point point = Point(step % width, step / width);
-      MatrixOS::LED::SetColor(patternOrigin + point, whiteBase ? Color::White.Dim(32) : trackColor.Dim(32));
-    }
+    Color baseStepColor = whiteBase ? Color::White.Dim(32) : trackColor.Dim(32);
+    patternCanvas.FillRect(Point(0, 0), Dimension(width, pattern->steps / width), baseStepColor);
+    patternCanvas.FillRect(Point(0, pattern->steps / width), Dimension(pattern->steps % width, 1), baseStepColor);
 
     uint16_t hasNote = 0;
 
@@ -345,33 +354,16 @@ bool PatternPad::Render(Point origin) {
     bool copyFilter =
         (sequencer->CopyActive() && sequencer->copySource.Selected() && !sequencer->copySource.IsType(SequenceSelectionType::STEP));
     bool noteFilter = !sequencer->noteSelected.empty();
-    uint16_t pulsesPerStep = sequencer->sequence.GetPulsesPerStep();
+    const SequencePatternSummary& summary = sequencer->sequence.PatternSummary(pattern);
     for (uint8_t slot = 0; slot < pattern->steps; slot++)
     {
-      uint16_t startTime = slot * pulsesPerStep;
-      uint16_t endTime = startTime + pulsesPerStep - 1;
-
-      bool hasEventInSlot = sequencer->sequence.PatternHasEventInRange(pattern, startTime, endTime, SequenceEventType::NoteEvent);
+      bool hasEventInSlot = summary.HasNote(slot);
       bool shouldRender = false;
 
       // If notes are selected, only render events with matching notes
       if (noteFilter && !copyFilter)
       {
-        // Check if any event in this slot has a note that's selected
-        auto it = pattern->events.lower_bound(startTime);
-        while (it != pattern->events.end() && it->first <= endTime)
-        {
-          if (it->second.eventType == SequenceEventType::NoteEvent)
-          {
-            const SequenceEventNote& noteData = std::get<SequenceEventNote>(it->second.data);
-            if (sequencer->noteSelected.find(noteData.note) != sequencer->noteSelected.end())
-            {
-              shouldRender = true;
-              break;
-            }
-          }
-          ++it;
-        }
+        shouldRender = summary.HasAnyNote(slot, selectedNotes);
       }
       else
       {
@@ -392,13 +384,13 @@ bool PatternPad::Render(Point origin) {
           color = Color::Green;
         }
         Point point = Point(slot % width, slot / width);
-        MatrixOS::LED::SetColor(patternOrigin + point, color);
+        patternCanvas.SetColor(point, color);
       }
       else if (noteFilter && hasEventInSlot)
       {
         // Event exists but not in current filter; dim the track color
         Point point = Point(slot % width, slot / width);
-        MatrixOS::LED::SetColor(patternOrigin + point, Color::Crossfade(trackColor, Color::White, Fract16(0xA000)).Scale(127));
+        patternCanvas.SetColor(point, Color::Crossfade(trackColor, Color::White, Fract16(0xA000)).Scale(127));
       }
     }
 
@@ -411,7 +403,7 @@ bool PatternPad::Render(Point origin) {
         {
           uint8_t selectedStep = selection.second;
           Point point = Point(selectedStep % width, selectedStep / width);
-          MatrixOS::LED::SetColor(patternOrigin + point, Color::White);
+          patternCanvas.SetColor(point, Color::White);
         }
       }
     }
@@ -428,7 +420,7 @@ bool PatternPad::Render(Point origin) {
         if (sequencer->sequence.RecordEnabled() && sequencer->sequence.ShouldRecord(track))
         {
           Color baseColor = hasNote & (1 << slot) ? Color(0xFF0040) : Color(0xFF0000);
-          MatrixOS::LED::SetColor(patternOrigin + point, baseColor);
+          patternCanvas.SetColor(point, baseColor);
         }
         else
         {
@@ -441,7 +433,7 @@ bool PatternPad::Render(Point origin) {
           {
             color = Color::Crossfade(trackColor, Color::White, Fract16(0xA000));
           }
-          MatrixOS::LED::SetColor(patternOrigin + point, color);
+          patternCanvas.SetColor(point, color);
         }
       }
     }
@@ -452,7 +444,7 @@ bool PatternPad::Render(Point origin) {
     {
       uint8_t slot = sequencer->copySource.step;
       Point point = Point(slot % width, slot / width);
-      MatrixOS::LED::SetColor(patternOrigin + point, Color::White);
+      patternCanvas.SetColor(point, Color::White);
     }
   }
 
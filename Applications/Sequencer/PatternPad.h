@@ -16,6 +16,7 @@ public:
   Dimension GetSize();
   virtual bool KeyEvent(Point xy, KeypadInfo* keypadInfo);
   virtual bool Render(Point origin);
+  virtual bool RenderCanvas(MatrixOS::LED::Canvas canvas);
   virtual bool IsEnabled();
   bool TwoPatternMode();
 };
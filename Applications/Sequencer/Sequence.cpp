@@ -16,6 +16,11 @@ Sequence::~Sequence() {
     vSemaphoreDelete(sequenceMutex);
     sequenceMutex = nullptr;
   }
+  if (scheduleMutex)
+  {
+    vSemaphoreDelete(scheduleMutex);
+    scheduleMutex = nullptr;
+  }
 }
 
 void Sequence::EnsureMutex() const {
@@ -23,6 +28,10 @@ void Sequence::EnsureMutex() const {
   {
     sequenceMutex = xSemaphoreCreateRecursiveMutex();
   }
+  if (scheduleMutex == nullptr)
+  {
+    scheduleMutex = xSemaphoreCreateMutex();
+  }
 }
 
 void Sequence::Lock() const {
@@ -69,6 +78,12 @@ void Sequence::ResetPlaybackState(uint8_t tracks) {
   currentClock = 0;
   lastRecordLayer = 0;
   currentRecordLayer = 0;
+
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  scheduleHead = 0;
+  scheduleCount = 0;
+  scheduleSpill.clear();
+  xSemaphoreGive(scheduleMutex);
 }
 
 void Sequence::New(uint8_t tracks) {
@@ -180,17 +195,11 @@ void Sequence::SetData(const SequenceData& newData) {
         }
 
         uint32_t maxPulse = pattern.steps * loadedPulsesPerStep;
-        for (auto evIt = pattern.events.begin(); evIt != pattern.events.end();)
+        if (maxPulse <= UINT16_MAX)
         {
-          if (evIt->first >= maxPulse)
-          {
-            evIt = pattern.events.erase(evIt);
-          }
-          else
-          {
-            ++evIt;
-          }
+          pattern.events.erase(pattern.events.lower_bound(maxPulse), pattern.events.end());
         }
+        pattern.Invalidate();
       }
       ++it;
     }
@@ -229,32 +238,52 @@ void Sequence::SetData(const SequenceData& newData) {
 }
 
 void Sequence::Tick() {
-  SequenceScopedLock lock(*this);
+  // Skip this round if another task holds the sequence, packets already scheduled still go out on time
+  EnsureMutex();
+  if (xSemaphoreTakeRecursive(sequenceMutex, 0) != pdTRUE)
+  {
+    return;
+  }
 
-  uint32_t now = MatrixOS::SYS::Micros();
+  Advance((uint32_t)MatrixOS::SYS::Micros() + SEQUENCE_LOOKAHEAD_US);
+  Unlock();
+}
 
-  // Anchor clock on first tick
+void Sequence::AnchorClock(uint32_t now) {
   if (lastClockTime == 0)
   {
     lastClockTime = now;
   }
+}
+
+void Sequence::Advance(uint32_t horizon) {
+  uint32_t now = MatrixOS::SYS::Micros();
 
-  // Single loop: advance clock and pulses until nothing is due
+  // Anchor clock on first tick, or the first after Idle()
+  AnchorClock(now);
+
+  // Single loop: advance clock and pulses until nothing is due before the horizon
   while (true)
   {
-    now = MatrixOS::SYS::Micros();
     bool progressed = false;
 
+    // Leave room in the schedule for what a pulse usually produces, and wait for held back note offs to go out
+    if (!ScheduleHasRoom())
+    {
+      break;
+    }
+
     // Handle MIDI clock output and start countdown
-    if ((now - lastClockTime) >= usPerClock)
+    if ((horizon - lastClockTime) >= usPerClock)
     {
+      lastClockTime += usPerClock; // advance by period to maintain phase
+
       if (clockOutput)
       {
-        MatrixOS::MIDI::Send(MidiPacket::Clock(), MIDI_PORT_ALL); // MIDI Clock message
+        scheduleTime = lastClockTime;
+        Schedule(MidiPacket::Clock()); // MIDI Clock message
       }
 
-      lastClockTime += usPerClock; // advance by period to maintain phase
-
       // Update MIDI clock counter (24 PPQN)
       currentClock = (currentClock + 1) % 24;
 
@@ -286,7 +315,7 @@ void Sequence::Tick() {
 
     // Handle pulse advance
     uint16_t period = usPerPulse[currentStep % 2];
-    if ((now - lastPulseTime) >= period)
+    if ((horizon - lastPulseTime) >= period)
     {
       lastPulseTime += period; // advance by exact period
 
@@ -311,6 +340,7 @@ void Sequence::Tick() {
         currentStep = 0;
       }
 
+      scheduleTime = lastPulseTime;
       for (uint8_t track = 0; track < trackPlayback.size(); track++)
       {
         ProcessTrack(track);
@@ -326,6 +356,213 @@ void Sequence::Tick() {
   }
 }
 
+void Sequence::Schedule(const MidiPacket& packet) {
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  ScheduledPacket entry = {scheduleTime, packet};
+  if (scheduleCount < SEQUENCE_SCHEDULE_SIZE && scheduleSpill.empty())
+  {
+    InsertScheduled(entry);
+  }
+  else if (packet.status == NoteOff)
+  {
+    // Dropping it would leave the note hanging. Anything scheduled after it is dropped until it's in, so a note
+    // retriggered on the same pulse can't go out ahead of its own note off.
+    scheduleSpill.push_back(entry);
+    clockStats.spilled++;
+  }
+  else
+  {
+    // Sending it now would put it ahead of packets that are due first
+    clockStats.overflowed++;
+  }
+  xSemaphoreGive(scheduleMutex);
+}
+
+// Keep the schedule sorted by time. Clocks and pulses interleave, so the slot is at or next to the tail.
+// Called with scheduleMutex held and a free slot.
+void Sequence::InsertScheduled(const ScheduledPacket& entry) {
+  uint16_t pos = scheduleCount;
+  while (pos > 0)
+  {
+    ScheduledPacket& prev = schedule[(scheduleHead + pos - 1) % SEQUENCE_SCHEDULE_SIZE];
+    if ((int32_t)(entry.time - prev.time) >= 0)
+    {
+      break;
+    }
+    schedule[(scheduleHead + pos) % SEQUENCE_SCHEDULE_SIZE] = prev;
+    pos--;
+  }
+  schedule[(scheduleHead + pos) % SEQUENCE_SCHEDULE_SIZE] = entry;
+  scheduleCount++;
+}
+
+// Called with scheduleMutex held
+void Sequence::RefillFromSpill() {
+  while (!scheduleSpill.empty() && scheduleCount < SEQUENCE_SCHEDULE_SIZE)
+  {
+    InsertScheduled(scheduleSpill.front());
+    scheduleSpill.pop_front();
+  }
+}
+
+bool Sequence::ScheduleHasRoom() {
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  bool room = scheduleSpill.empty() && scheduleCount <= SEQUENCE_SCHEDULE_SIZE / 2;
+  xSemaphoreGive(scheduleMutex);
+  return room;
+}
+
+// Drop scheduled channel messages, sending note offs right away so nothing is left hanging.
+// channel < 0 flushes every channel plus a pending Start/Continue. Clocks are kept so clock output stays steady.
+void Sequence::FlushSchedule(int16_t channel) {
+  vector<MidiPacket> noteOffs;
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  uint16_t kept = 0;
+  for (uint16_t i = 0; i < scheduleCount; i++)
+  {
+    ScheduledPacket& entry = schedule[(scheduleHead + i) % SEQUENCE_SCHEDULE_SIZE];
+    EMidiStatus status = entry.packet.status;
+    bool channelMessage = status >= NoteOff && status <= PitchChange;
+    bool flush = channelMessage ? (channel < 0 || entry.packet.Channel() == channel) : (channel < 0 && (status == Start || status == Continue));
+    if (!flush)
+    {
+      schedule[(scheduleHead + kept) % SEQUENCE_SCHEDULE_SIZE] = entry;
+      kept++;
+      continue;
+    }
+    if (status == NoteOff)
+    {
+      noteOffs.push_back(entry.packet);
+    }
+  }
+  scheduleCount = kept;
+  for (auto it = scheduleSpill.begin(); it != scheduleSpill.end();)
+  {
+    if (channel < 0 || it->packet.Channel() == channel)
+    {
+      noteOffs.push_back(it->packet);
+      it = scheduleSpill.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  RefillFromSpill();
+  xSemaphoreGive(scheduleMutex);
+
+  if (!noteOffs.empty())
+  {
+    MatrixOS::MIDI::SendBatch(noteOffs.data(), noteOffs.size(), MIDI_PORT_ALL);
+  }
+}
+
+static const uint32_t jitterBucketLimits[SEQUENCE_JITTER_BUCKETS - 1] = {50, 100, 200, 500, 1000, 2000, 5000};
+
+void Sequence::EmitScheduled() {
+  EnsureMutex();
+  // Everything due now (a whole step across tracks) goes out in bursts, sent after the schedule is unlocked
+  // so a slow port never holds up Tick() scheduling the next pulses
+  MidiPacket burst[SEQUENCE_EMIT_BATCH_SIZE];
+  uint16_t burstSize;
+  do
+  {
+    burstSize = TakeDue(burst, SEQUENCE_EMIT_BATCH_SIZE);
+    if (burstSize > 0)
+    {
+      MatrixOS::MIDI::SendBatch(burst, burstSize, MIDI_PORT_ALL);
+    }
+  } while (burstSize == SEQUENCE_EMIT_BATCH_SIZE);
+}
+
+// Moves up to max due packets out of the schedule into packets, and records how late they are
+uint16_t Sequence::TakeDue(MidiPacket* packets, uint16_t max) {
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  uint16_t count = 0;
+  while (scheduleCount > 0 && count < max)
+  {
+    ScheduledPacket& entry = schedule[scheduleHead];
+    int32_t late = (int32_t)((uint32_t)MatrixOS::SYS::Micros() - entry.time);
+    if (late < 0)
+    {
+      break;
+    }
+
+    packets[count++] = entry.packet;
+
+    uint8_t bucket = 0;
+    while (bucket < SEQUENCE_JITTER_BUCKETS - 1 && (uint32_t)late >= jitterBucketLimits[bucket])
+    {
+      bucket++;
+    }
+    clockStats.histogram[bucket]++;
+    clockStats.emitted++;
+    if ((uint32_t)late > clockStats.maxLateUs)
+    {
+      clockStats.maxLateUs = late;
+    }
+
+    scheduleHead = (scheduleHead + 1) % SEQUENCE_SCHEDULE_SIZE;
+    scheduleCount--;
+    RefillFromSpill();
+  }
+  xSemaphoreGive(scheduleMutex);
+  return count;
+}
+
+uint32_t Sequence::UsUntilNextEmit() {
+  EnsureMutex();
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  uint32_t wait = UINT32_MAX;
+  if (scheduleCount > 0)
+  {
+    int32_t remaining = (int32_t)(schedule[scheduleHead].time - (uint32_t)MatrixOS::SYS::Micros());
+    wait = remaining > 0 ? remaining : 0;
+  }
+  xSemaphoreGive(scheduleMutex);
+  return wait;
+}
+
+bool Sequence::Idle() {
+  SequenceScopedLock lock(*this);
+
+  if (playing || record || clockOutput || UsUntilNextEmit() != UINT32_MAX)
+  {
+    return false;
+  }
+  lastClockTime = 0;
+  return true;
+}
+
+void Sequence::SetTickTask(TaskHandle_t task) {
+  SequenceScopedLock lock(*this);
+
+  tickTask = task;
+}
+
+// Called under the sequence lock
+void Sequence::WakeTick() {
+  if (tickTask)
+  {
+    xTaskNotifyGive(tickTask);
+  }
+}
+
+SequenceClockStats Sequence::GetClockStats() {
+  EnsureMutex();
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  SequenceClockStats stats = clockStats;
+  xSemaphoreGive(scheduleMutex);
+  return stats;
+}
+
+void Sequence::ResetClockStats() {
+  EnsureMutex();
+  xSemaphoreTake(scheduleMutex, portMAX_DELAY);
+  clockStats = SequenceClockStats();
+  xSemaphoreGive(scheduleMutex);
+}
+
 void Sequence::UpdateTiming() {
   // Update Step Division
   pulsesPerStep = (PPQN * 4) / stepDivision; // stepDivision: 4=quarter, 8=eighth, 16=sixteenth
@@ -413,7 +650,11 @@ void Sequence::PlayClip(uint8_t track, uint8_t clip) {
       trackPlayback[i].noteOffQueue.clear();
     }
 
-    MatrixOS::MIDI::Send(MidiPacket::Start(), MIDI_PORT_ALL);
+    // Goes out after the clocks already scheduled, so the first clock following it is the first played pulse
+    AnchorClock(MatrixOS::SYS::Micros());
+    scheduleTime = lastClockTime;
+    Schedule(MidiPacket::Start());
+    WakeTick();
   }
 
   // Terminate recorded notes on this track before switching
@@ -463,6 +704,7 @@ void Sequence::PlayFrom(uint8_t track, uint8_t clip, uint8_t pattern, uint8_t st
     currentPulse = UINT16_MAX;
     pulseSinceStart = 0;
     currentRecordLayer = 0;
+    WakeTick();
 
     for (uint8_t i = 0; i < trackPlayback.size(); i++)
     {
@@ -541,7 +783,10 @@ void Sequence::Resume() {
     }
   }
 
-  MatrixOS::MIDI::Send(MidiPacket::Continue(), MIDI_PORT_ALL);
+  AnchorClock(MatrixOS::SYS::Micros());
+  scheduleTime = lastClockTime;
+  Schedule(MidiPacket::Continue());
+  WakeTick();
 }
 
 bool Sequence::CanResume() {
@@ -576,6 +821,7 @@ bool Sequence::Playing(uint8_t track) {
 void Sequence::Stop() {
   SequenceScopedLock lock(*this);
 
+  FlushSchedule();
   playing = false;
   record = false;
   uint8_t sessionLayer = currentRecordLayer;
@@ -636,6 +882,7 @@ void Sequence::Stop(uint8_t track) {
 
   // Send note-off for all queued notes on this track before clearing
   uint8_t channel = GetChannel(track);
+  FlushSchedule(channel);
   TerminateRecordedNotes(track);
   for (const auto& [note, tick] : trackPlayback[track].noteOffMap)
   {
@@ -686,6 +933,10 @@ void Sequence::EnableRecord(bool val) {
   SequenceScopedLock lock(*this);
 
   record = val;
+  if (record)
+  {
+    WakeTick();
+  }
 }
 
 bool Sequence::RecordEnabled() {
@@ -699,6 +950,10 @@ void Sequence::EnableClockOutput(bool val) {
   SequenceScopedLock lock(*this);
 
   clockOutput = val;
+  if (clockOutput)
+  {
+    WakeTick();
+  }
 }
 
 bool Sequence::ClockOutputEnabled() {
@@ -902,6 +1157,7 @@ bool Sequence::PatternClearAll(SequencePattern* pattern) {
   if (!pattern->events.empty())
   {
     pattern->events.clear();
+    pattern->Invalidate();
     dirty = true;
   }
   return true;
@@ -916,6 +1172,7 @@ bool Sequence::PatternAddEvent(SequencePattern* pattern, uint16_t timestamp, con
   if (timestamp >= patternLimit)
     return false;
   pattern->events.insert({timestamp, event});
+  pattern->AddToSummary(timestamp, event);
   dirty = true;
   return true;
 }
@@ -937,28 +1194,24 @@ bool Sequence::PatternHasEventInRange(SequencePattern* pattern, uint16_t startTi
   return false;
 }
 
+const SequencePatternSummary& Sequence::PatternSummary(SequencePattern* pattern) {
+  SequenceScopedLock lock(*this);
+  return pattern->Summary(pulsesPerStep);
+}
+
 bool Sequence::PatternClearNotesInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, uint8_t note) {
   SequenceScopedLock lock(*this);
 
   if (!pattern)
     return false;
-  bool removed = false;
-  for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime;)
-  {
-    if (it->second.eventType == SequenceEventType::NoteEvent)
-    {
-      const SequenceEventNote& n = std::get<SequenceEventNote>(it->second.data);
-      if (n.note == note)
-      {
-        it = pattern->events.erase(it);
-        removed = true;
-        continue;
-      }
-    }
-    ++it;
-  }
+  bool removed = SequenceEraseIf(pattern->events, pattern->events.lower_bound(startTime), pattern->events.upper_bound(endTime),
+                                 [note](const SequenceEventStore::value_type& entry) {
+                                   return entry.second.eventType == SequenceEventType::NoteEvent &&
+                                          std::get<SequenceEventNote>(entry.second.data).note == note;
+                                 }) > 0;
   if (removed)
   {
+    pattern->Invalidate();
     dirty = true;
   }
   return removed;
@@ -970,49 +1223,31 @@ bool Sequence::PatternOffsetNotesInRange(SequencePattern* pattern, uint16_t star
   if (!pattern || offset == 0)
     return false;
 
-  std::vector<std::pair<uint16_t, SequenceEvent>> eventsToModify;
-  std::vector<decltype(pattern->events)::iterator> eventsToRemove;
-
-  // Collect events that need modification
-  for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; ++it)
-  {
-    if (it->second.eventType == SequenceEventType::NoteEvent)
-    {
-      SequenceEventNote noteData = std::get<SequenceEventNote>(it->second.data);
-      int16_t newNote = noteData.note + offset;
-
-      // Delete notes that go out of valid MIDI range (0-127)
-      if (newNote < 0 || newNote > 127)
-      {
-        eventsToRemove.push_back(it);
-      }
-      else
-      {
-        // Update note value
-        noteData.note = (uint8_t)newNote;
-        SequenceEvent modifiedEvent = it->second;
-        modifiedEvent.data = noteData;
-        eventsToModify.push_back({it->first, modifiedEvent});
-        eventsToRemove.push_back(it);
-      }
-    }
+  // Notes pushed out of MIDI range (0-127) are deleted first, the rest are transposed in place since their timestamps
+  // don't change
+  auto outOfRange = [offset](const SequenceEventStore::value_type& entry) {
+    if (entry.second.eventType != SequenceEventType::NoteEvent)
+      return false;
+    int16_t newNote = std::get<SequenceEventNote>(entry.second.data).note + offset;
+    return newNote < 0 || newNote > 127;
+  };
+  bool changed = SequenceEraseIf(pattern->events, pattern->events.lower_bound(startTime), pattern->events.upper_bound(endTime),
+                                 outOfRange) > 0;
+
+  auto last = pattern->events.upper_bound(endTime);
+  for (auto it = pattern->events.lower_bound(startTime); it != last; ++it)
+  {
+    if (it->second.eventType != SequenceEventType::NoteEvent)
+      continue;
+    SequenceEventNote& noteData = std::get<SequenceEventNote>(it->second.data);
+    noteData.note = (uint8_t)(noteData.note + offset);
+    changed = true;
   }
 
-  if (eventsToModify.empty() && eventsToRemove.empty())
+  if (!changed)
     return false;
 
-  // Remove old events
-  for (auto it : eventsToRemove)
-  {
-    pattern->events.erase(it);
-  }
-
-  // Insert modified events
-  for (const auto& [timestamp, event] : eventsToModify)
-  {
-    pattern->events.insert({timestamp, event});
-  }
-
+  pattern->Invalidate();
   dirty = true;
   return true;
 }
@@ -1022,14 +1257,13 @@ bool Sequence::PatternClearEventsInRange(SequencePattern* pattern, uint16_t star
 
   if (!pattern)
     return false;
-  bool removed = false;
-  for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime;)
-  {
-    it = pattern->events.erase(it);
-    removed = true;
-  }
+  auto first = pattern->events.lower_bound(startTime);
+  auto last = pattern->events.upper_bound(endTime);
+  bool removed = first != last;
+  pattern->events.erase(first, last);
   if (removed)
   {
+    pattern->Invalidate();
     dirty = true;
   }
   return removed;
@@ -1081,10 +1315,8 @@ bool Sequence::PatternCopyEventsInRange(SequencePattern* pattern, uint16_t sourc
   }
 
   // Add copied events to destination
-  for (const auto& [timestamp, event] : eventsToCopy)
-  {
-    pattern->events.insert({timestamp, event});
-  }
+  pattern->events.insert(eventsToCopy.begin(), eventsToCopy.end());
+  pattern->Invalidate();
   dirty = true;
   return true;
 }
@@ -1097,19 +1329,13 @@ bool Sequence::PatternSetLength(SequencePattern* pattern, uint8_t steps) {
 
   // Remove any events that now fall beyond the new pattern length
   uint32_t maxPulse = steps * pulsesPerStep;
-  for (auto it = pattern->events.begin(); it != pattern->events.end();)
+  if (maxPulse <= UINT16_MAX)
   {
-    if (it->first >= maxPulse)
-    {
-      it = pattern->events.erase(it);
-    }
-    else
-    {
-      ++it;
-    }
+    pattern->events.erase(pattern->events.lower_bound(maxPulse), pattern->events.end());
   }
 
   pattern->steps = steps;
+  pattern->Invalidate();
   dirty = true;
   return true;
 }
@@ -1122,7 +1348,10 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
 
   int32_t patternLen = pattern->steps * pulsesPerStep;
 
-  std::multimap<uint16_t, SequenceEvent> currentQuantized;
+  // Collect first and insert as one batch so the event store is rebuilt once
+  vector<std::pair<uint16_t, SequenceEvent>> currentQuantized;
+  vector<std::pair<uint16_t, SequenceEvent>> nextQuantized;
+  currentQuantized.reserve(pattern->events.size());
   bool changed = false;
 
   auto quantizeVal = [stepPulse](uint16_t val) -> uint16_t { return (val + stepPulse / 2) / stepPulse * stepPulse; };
@@ -1156,25 +1385,33 @@ bool Sequence::PatternQuantize(SequencePattern* pattern, SequencePattern* patter
 
         if (patternNext == pattern)
         {
-          // Loop to Self: Insert into TEMP map
-          currentQuantized.insert({overflowTimestamp, newEvent});
+          // Loop to Self: Insert into TEMP list
+          currentQuantized.push_back({overflowTimestamp, newEvent});
         }
         else
         {
-          // Distinct patternNext: Safe to insert directly
-          patternNext->events.insert({overflowTimestamp, newEvent});
+          nextQuantized.push_back({overflowTimestamp, newEvent});
         }
       }
     }
     else
     {
-      currentQuantized.insert({newTimestamp, newEvent});
+      currentQuantized.push_back({newTimestamp, newEvent});
     }
   }
 
+  if (!nextQuantized.empty())
+  {
+    patternNext->events.insert(nextQuantized.begin(), nextQuantized.end());
+    patternNext->Invalidate();
+  }
+
   if (changed)
   {
-    pattern->events.swap(currentQuantized);
+    SequenceEventStore quantized;
+    quantized.insert(currentQuantized.begin(), currentQuantized.end());
+    pattern->events.swap(quantized);
+    pattern->Invalidate();
     dirty = true;
   }
 
@@ -1213,14 +1450,18 @@ bool Sequence::PatternNudge(SequencePattern* pattern, int16_t offsetPulse) {
     normalized += patternLengthPulses;
   }
 
-  std::multimap<uint16_t, SequenceEvent> shifted;
+  vector<std::pair<uint16_t, SequenceEvent>> shiftedEvents;
+  shiftedEvents.reserve(pattern->events.size());
   for (const auto& [timestamp, ev] : pattern->events)
   {
     int32_t shiftedTs = (timestamp + normalized) % patternLengthPulses;
-    shifted.insert({shiftedTs, ev});
+    shiftedEvents.push_back({(uint16_t)shiftedTs, ev});
   }
 
+  SequenceEventStore shifted;
+  shifted.insert(shiftedEvents.begin(), shiftedEvents.end());
   pattern->events.swap(shifted);
+  pattern->Invalidate();
   dirty = true;
   return true;
 }
@@ -1255,8 +1496,8 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
   }
 
   // Temporary storage for the new state of both patterns
-  std::multimap<uint16_t, SequenceEvent> newEvents1;
-  std::multimap<uint16_t, SequenceEvent> newEvents2;
+  vector<std::pair<uint16_t, SequenceEvent>> newEvents1;
+  vector<std::pair<uint16_t, SequenceEvent>> newEvents2;
 
   // --- Process Pattern 1 Events ---
   // These exist virtually from [0 to len1)
@@ -1268,12 +1509,12 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
     if (newAbsTs < len1)
     {
       // It lands back inside Pattern 1
-      newEvents1.insert({(uint16_t)newAbsTs, ev});
+      newEvents1.push_back({(uint16_t)newAbsTs, ev});
     }
     else
     {
       // It lands inside Pattern 2 (subtract len1 to get local P2 time)
-      newEvents2.insert({(uint16_t)(newAbsTs - len1), ev});
+      newEvents2.push_back({(uint16_t)(newAbsTs - len1), ev});
     }
   }
 
@@ -1290,18 +1531,24 @@ bool Sequence::DualPatternNudge(SequencePattern* pattern1, SequencePattern* patt
     if (newAbsTs < len1)
     {
       // It wraps around to Pattern 1
-      newEvents1.insert({(uint16_t)newAbsTs, ev});
+      newEvents1.push_back({(uint16_t)newAbsTs, ev});
     }
     else
     {
       // It stays/lands in Pattern 2
-      newEvents2.insert({(uint16_t)(newAbsTs - len1), ev});
+      newEvents2.push_back({(uint16_t)(newAbsTs - len1), ev});
     }
   }
 
   // Apply changes
-  pattern1->events.swap(newEvents1);
-  pattern2->events.swap(newEvents2);
+  SequenceEventStore shifted1;
+  SequenceEventStore shifted2;
+  shifted1.insert(newEvents1.begin(), newEvents1.end());
+  shifted2.insert(newEvents2.begin(), newEvents2.end());
+  pattern1->events.swap(shifted1);
+  pattern2->events.swap(shifted2);
+  pattern1->Invalidate();
+  pattern2->Invalidate();
   dirty = true;
 
   return true;
@@ -1319,11 +1566,17 @@ bool Sequence::PatternNudgeInRange(SequencePattern* pattern, uint16_t startTime,
     return false;
 
   uint16_t endTime = startTime + length - 1;
-  std::vector<std::pair<uint16_t, SequenceEvent>> eventsToMove;
-  std::vector<decltype(pattern->events)::iterator> eventsToRemove;
+  vector<std::pair<uint16_t, SequenceEvent>> eventsToMove;
+  vector<std::pair<uint16_t, SequenceEvent>> eventsToPrev;
+  vector<std::pair<uint16_t, SequenceEvent>> eventsToNext;
+
+  // Every event in the range leaves its slot: it moves within the pattern, to a neighbour, or is discarded
+  auto first = pattern->events.lower_bound(startTime);
+  auto last = pattern->events.upper_bound(endTime);
+  if (first == last)
+    return false;
 
-  // Collect events in the specified range
-  for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; ++it)
+  for (auto it = first; it != last; ++it)
   {
     int32_t newTimestamp = (int32_t)it->first + offsetPulse;
 
@@ -1331,60 +1584,43 @@ bool Sequence::PatternNudgeInRange(SequencePattern* pattern, uint16_t startTime,
     if (newTimestamp >= 0 && newTimestamp < patternLengthPulses)
     {
       eventsToMove.push_back({(uint16_t)newTimestamp, it->second});
-      eventsToRemove.push_back(it);
     }
-    // Check if event goes to previous pattern
+    // Check if event goes to previous pattern, discard if it can't fit
     else if (newTimestamp < 0 && prevPattern != nullptr)
     {
       int32_t prevPatternLength = prevPattern->steps * pulsesPerStep;
       int32_t prevTimestamp = prevPatternLength + newTimestamp;
       if (prevTimestamp >= 0 && prevTimestamp < prevPatternLength)
       {
-        prevPattern->events.insert({(uint16_t)prevTimestamp, it->second});
-        eventsToRemove.push_back(it);
-      }
-      // Discard if can't fit in previous pattern
-      else
-      {
-        eventsToRemove.push_back(it);
+        eventsToPrev.push_back({(uint16_t)prevTimestamp, it->second});
       }
     }
-    // Check if event goes to next pattern
+    // Check if event goes to next pattern, discard if it can't fit
     else if (newTimestamp >= patternLengthPulses && nextPattern != nullptr)
     {
       int32_t nextTimestamp = newTimestamp - patternLengthPulses;
       int32_t nextPatternLength = nextPattern->steps * pulsesPerStep;
       if (nextTimestamp >= 0 && nextTimestamp < nextPatternLength)
       {
-        nextPattern->events.insert({(uint16_t)nextTimestamp, it->second});
-        eventsToRemove.push_back(it);
-      }
-      // Discard if can't fit in next pattern
-      else
-      {
-        eventsToRemove.push_back(it);
+        eventsToNext.push_back({(uint16_t)nextTimestamp, it->second});
       }
     }
     // Discard if overflow and no prev/next pattern
-    else
-    {
-      eventsToRemove.push_back(it);
-    }
   }
 
-  if (eventsToMove.empty() && eventsToRemove.empty())
-    return false;
-
-  // Remove old events
-  for (auto it : eventsToRemove)
+  // Remove old events, then insert each destination as one batch
+  pattern->events.erase(first, last);
+  pattern->events.insert(eventsToMove.begin(), eventsToMove.end());
+  pattern->Invalidate();
+  if (prevPattern != nullptr)
   {
-    pattern->events.erase(it);
+    prevPattern->events.insert(eventsToPrev.begin(), eventsToPrev.end());
+    prevPattern->Invalidate();
   }
-
-  // Insert moved events back into current pattern
-  for (const auto& [timestamp, event] : eventsToMove)
+  if (nextPattern != nullptr)
   {
-    pattern->events.insert({timestamp, event});
+    nextPattern->events.insert(eventsToNext.begin(), eventsToNext.end());
+    nextPattern->Invalidate();
   }
 
   dirty = true;
@@ -1452,6 +1688,7 @@ void Sequence::CopyPattern(uint8_t sourceTrack, uint8_t sourceClip, uint8_t sour
     SequencePattern& dest = destPatterns.back();
     dest.steps = source.steps;
     dest.events = source.events;
+    dest.Invalidate();
   }
   else
   {
@@ -1462,6 +1699,7 @@ void Sequence::CopyPattern(uint8_t sourceTrack, uint8_t sourceClip, uint8_t sour
     SequencePattern& dest = destPatterns[destPattern];
     dest.steps = source.steps;
     dest.events = source.events;
+    dest.Invalidate();
   }
   dirty = true;
 }
@@ -1998,12 +2236,13 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track) {
       {
         Sequence::TrackPlayback::RecordedNote prev = prevIt->second;
         pending.erase(prevIt);
-        if (prev.eventPtr != nullptr)
+        SequenceEvent* prevEvent = FindRecordedNote(prev, note);
+        if (prevEvent != nullptr)
         {
           uint32_t prevLen = (pulseSinceStart > prev.startPulse) ? (pulseSinceStart - prev.startPulse) : 1;
           if (prevLen == 0)
             prevLen = 1;
-          SequenceEventNote& prevNoteData = std::get<SequenceEventNote>(prev.eventPtr->data);
+          SequenceEventNote& prevNoteData = std::get<SequenceEventNote>(prevEvent->data);
           if (prevLen > UINT16_MAX)
             prevLen = UINT16_MAX;
           prevNoteData.length = (uint16_t)prevLen;
@@ -2011,15 +2250,14 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track) {
         }
       }
 
-      auto evIt = pattern->events.insert({(uint16_t)currentTick, SequenceEvent::Note(note, velocity, false, 0)});
-      SequenceEvent& evRef = evIt->second;
-      if (evRef.eventType == SequenceEventType::NoteEvent)
-      {
-        evRef.recordLayer = currentRecordLayer;
-      }
+      SequenceEvent event = SequenceEvent::Note(note, velocity, false, 0);
+      event.recordLayer = currentRecordLayer;
+      pattern->events.insert({(uint16_t)currentTick, event});
+      pattern->AddToSummary((uint16_t)currentTick, event);
       Sequence::TrackPlayback::RecordedNote info;
       info.startPulse = clampToStart ? 0 : pulseSinceStart;
-      info.eventPtr = &evRef;
+      info.pattern = pattern;
+      info.timestamp = (uint16_t)currentTick;
       pending[note] = info;
       dirty = true;
     }
@@ -2032,7 +2270,8 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track) {
       Sequence::TrackPlayback::RecordedNote info = itPending->second;
       pending.erase(itPending);
 
-      if (info.eventPtr == nullptr)
+      SequenceEvent* event = FindRecordedNote(info, note);
+      if (event == nullptr)
         continue;
 
       uint32_t length = (pulseSinceStart > info.startPulse) ? (pulseSinceStart - info.startPulse) : 1;
@@ -2041,7 +2280,7 @@ void Sequence::RecordEvent(MidiPacket packet, uint8_t track) {
       if (length == 0)
         length = 1;
 
-      SequenceEventNote& noteData = std::get<SequenceEventNote>(info.eventPtr->data);
+      SequenceEventNote& noteData = std::get<SequenceEventNote>(event->data);
       noteData.length = (uint16_t)length;
       dirty = true;
     }
@@ -2073,15 +2312,12 @@ void Sequence::UndoLastRecorded() {
     {
       for (auto& pattern : clipPair.second.patterns)
       {
-        for (auto it = pattern.events.begin(); it != pattern.events.end();)
+        uint8_t layer = lastRecordLayer;
+        if (SequenceEraseIf(pattern.events, pattern.events.begin(), pattern.events.end(),
+                            [layer](const SequenceEventStore::value_type& entry) { return entry.second.recordLayer == layer; }) > 0)
         {
-          if (it->second.recordLayer == lastRecordLayer)
-          {
-            it = pattern.events.erase(it);
-            removed = true;
-            continue;
-          }
-          ++it;
+          pattern.Invalidate();
+          removed = true;
         }
       }
     }
@@ -2098,6 +2334,25 @@ void Sequence::UndoLastRecorded() {
   }
 }
 
+SequenceEvent* Sequence::FindRecordedNote(const TrackPlayback::RecordedNote& info, uint8_t note) {
+  if (info.pattern == nullptr)
+    return nullptr;
+
+  // Pending notes are stored with length 0 until their note off arrives
+  auto range = info.pattern->events.equal_range(info.timestamp);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second.eventType != SequenceEventType::NoteEvent)
+      continue;
+    const SequenceEventNote& noteData = std::get<SequenceEventNote>(it->second.data);
+    if (noteData.note == note && noteData.length == 0)
+    {
+      return &it->second;
+    }
+  }
+  return nullptr;
+}
+
 void Sequence::TerminateRecordedNotes(uint8_t track) {
   SequenceScopedLock lock(*this);
 
@@ -2114,7 +2369,8 @@ void Sequence::TerminateRecordedNotes(uint8_t track) {
   for (auto& entry : recordedNotes)
   {
     const auto& info = entry.second;
-    if (info.eventPtr == nullptr)
+    SequenceEvent* event = FindRecordedNote(info, entry.first);
+    if (event == nullptr)
       continue;
 
     uint32_t length = (currentPulseGlobal > info.startPulse) ? (currentPulseGlobal - info.startPulse) : 1;
@@ -2123,7 +2379,7 @@ void Sequence::TerminateRecordedNotes(uint8_t track) {
     if (length > UINT16_MAX)
       length = UINT16_MAX;
 
-    SequenceEventNote& noteData = std::get<SequenceEventNote>(info.eventPtr->data);
+    SequenceEventNote& noteData = std::get<SequenceEventNote>(event->data);
     noteData.length = (uint16_t)length;
     updated = true;
   }
@@ -2234,11 +2490,11 @@ void Sequence::ProcessTrack(uint8_t track) {
         uint8_t channel = data.tracks[track].channel;
         if (noteData.aftertouch)
         {
-          MatrixOS::MIDI::Send(MidiPacket::AfterTouch(channel, noteData.note, noteData.velocity), MIDI_PORT_ALL);
+          Schedule(MidiPacket::AfterTouch(channel, noteData.note, noteData.velocity));
         }
         else
         {
-          MatrixOS::MIDI::Send(MidiPacket::NoteOn(channel, noteData.note, noteData.velocity), MIDI_PORT_ALL);
+          Schedule(MidiPacket::NoteOn(channel, noteData.note, noteData.velocity));
         }
 
         uint8_t note = noteData.note;
@@ -2274,7 +2530,7 @@ void Sequence::ProcessTrack(uint8_t track) {
       case SequenceEventType::ControlChangeEvent: {
         const SequenceEventCC& ccEvent = std::get<SequenceEventCC>(ev.data);
         uint8_t channel = data.tracks[track].channel;
-        MatrixOS::MIDI::Send(MidiPacket::ControlChange(channel, ccEvent.param, ccEvent.value), MIDI_PORT_ALL);
+        Schedule(MidiPacket::ControlChange(channel, ccEvent.param, ccEvent.value));
         break;
       }
       default:
@@ -2293,7 +2549,7 @@ void Sequence::ProcessTrack(uint8_t track) {
     if (trackEnabled)
     {
       uint8_t channel = GetChannel(track);
-      MatrixOS::MIDI::Send(MidiPacket::NoteOff(channel, note, 0), MIDI_PORT_ALL);
+      Schedule(MidiPacket::NoteOff(channel, note, 0));
     }
 
     trackPlayback[track].noteOffMap.erase(note);
@@ -2,8 +2,23 @@
 
 #include "SequenceData.h"
 #include "SequenceMeta.h"
+#include <deque>
 #include <unordered_map>
 
+#define SEQUENCE_LOOKAHEAD_US 4000   // How far ahead of real time pulses are computed and their MIDI scheduled
+#define SEQUENCE_SCHEDULE_SIZE 128   // Scheduled MIDI packets waiting for their emit time
+#define SEQUENCE_EMIT_BATCH_SIZE 32  // Due packets sent per MIDI burst
+#define SEQUENCE_JITTER_BUCKETS 8
+
+// Emit timing of scheduled MIDI, late = actual send time - scheduled time
+struct SequenceClockStats {
+  uint32_t emitted = 0;
+  uint32_t overflowed = 0; // Packets dropped because the schedule was full, never note offs
+  uint32_t spilled = 0;    // Note offs held back until the full schedule had room
+  uint32_t maxLateUs = 0;
+  uint32_t histogram[SEQUENCE_JITTER_BUCKETS] = {0}; // Late by <50us, <100, <200, <500, <1ms, <2ms, <5ms, >=5ms
+};
+
 struct SequencePosition {
   uint8_t clip = 0;
   uint8_t pattern = 0;
@@ -43,6 +58,21 @@ private:
   uint8_t currentClock = 0;   // Counter for clocks (0-23, wraps at 24)
   uint32_t usPerClock;        // Microseconds per clock pulse (24 PPQN)
 
+  // Lookahead schedule. Tick() runs pulses up to SEQUENCE_LOOKAHEAD_US early and queues their MIDI here sorted by time,
+  // EmitScheduled() sends each packet when it is due. Has its own mutex so emitting never waits on the sequence lock.
+  struct ScheduledPacket {
+    uint32_t time;
+    MidiPacket packet;
+  };
+  ScheduledPacket schedule[SEQUENCE_SCHEDULE_SIZE];
+  uint16_t scheduleHead = 0;
+  uint16_t scheduleCount = 0;
+  std::deque<ScheduledPacket> scheduleSpill; // Note offs that didn't fit, moved into the schedule as it drains
+  uint32_t scheduleTime = 0; // Emit time for packets produced by the clock or pulse being processed
+  mutable SemaphoreHandle_t scheduleMutex = nullptr;
+  SequenceClockStats clockStats;
+  TaskHandle_t tickTask = nullptr; // Woken when playback, recording or clock output starts
+
   // Playback state per track
   struct TrackPlayback {
     bool playing = false;                     // Is this track playing
@@ -55,7 +85,8 @@ private:
     multimap<uint32_t, uint8_t> noteOffQueue; // tick -> note (for efficient processing)
     struct RecordedNote {
       uint32_t startPulse = 0;
-      SequenceEvent* eventPtr = nullptr;
+      SequencePattern* pattern = nullptr; // Event is looked up again on note off, pointers into the event store don't survive inserts
+      uint16_t timestamp = 0;
     };
     std::unordered_map<uint8_t, RecordedNote> recordedNotes; // note -> pending event info
   };
@@ -65,7 +96,16 @@ private:
   void EnsureMutex() const;
   void ResetPlaybackState(uint8_t tracks);
   void UpdateTiming();
+  void AnchorClock(uint32_t now);
+  void Advance(uint32_t horizon);
   void ProcessTrack(uint8_t track);
+  void Schedule(const MidiPacket& packet);
+  void InsertScheduled(const ScheduledPacket& entry);
+  void RefillFromSpill();
+  bool ScheduleHasRoom();
+  void FlushSchedule(int16_t channel = -1);
+  uint16_t TakeDue(MidiPacket* packets, uint16_t max);
+  void WakeTick();
 
 public:
   const static uint16_t PPQN = 96;
@@ -78,7 +118,16 @@ public:
 
   void New(uint8_t tracks = 8);
 
+  // Called by the clock task. Tick() computes due pulses ahead of time, EmitScheduled() sends their MIDI on time.
   void Tick();
+  void EmitScheduled();
+  uint32_t UsUntilNextEmit(); // UINT32_MAX if nothing is scheduled
+  // True when nothing plays, records or clocks out, the clock task can sleep until it is notified.
+  // Drops the clock phase, the next Tick() anchors it again.
+  bool Idle();
+  void SetTickTask(TaskHandle_t task);
+  SequenceClockStats GetClockStats();
+  void ResetClockStats();
 
   void Play();
   void Play(uint8_t track);
@@ -130,6 +179,7 @@ public:
   bool PatternAddEvent(SequencePattern* pattern, uint16_t timestamp, const SequenceEvent& event);
   bool PatternHasEventInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime,
                               SequenceEventType type = SequenceEventType::Invalid);
+  const SequencePatternSummary& PatternSummary(SequencePattern* pattern); // Hold the sequence lock while reading it
   bool PatternClearNotesInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, uint8_t note);
   bool PatternOffsetNotesInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime, int8_t offset);
   bool PatternClearEventsInRange(SequencePattern* pattern, uint16_t startTime, uint16_t endTime);
@@ -211,6 +261,7 @@ public:
 
 private:
   void TerminateRecordedNotes(uint8_t track);
+  SequenceEvent* FindRecordedNote(const TrackPlayback::RecordedNote& info, uint8_t note);
 };
 
 class SequenceScopedLock {
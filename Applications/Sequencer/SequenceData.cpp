@@ -8,7 +8,6 @@ using std::string;
 using std::vector;
 
 static constexpr uint8_t SEQUENCE_MAX_TRACK_COUNT = 8;
-static constexpr uint8_t SEQUENCE_MAX_PATTERN_LENGTH = 64;
 
 static bool IsValidStepDivision(uint8_t stepDivision) {
   return stepDivision == 1 || stepDivision == 2 || stepDivision == 4 || stepDivision == 8 || stepDivision == 16 ||
@@ -85,15 +84,60 @@ static bool ValidateSequenceData(const SequenceData& data) {
 
 void SequencePattern::Clear() {
   events.clear();
+  Invalidate();
 }
 
 void SequencePattern::ClearStepEvents(uint8_t step, uint16_t pulsesPerStep) {
   uint16_t startTime = step * pulsesPerStep;
   uint16_t endTime = startTime + pulsesPerStep - 1;
-  auto it = events.lower_bound(startTime);
-  while (it != events.end() && it->first <= endTime)
+  events.erase(events.lower_bound(startTime), events.upper_bound(endTime));
+  Invalidate();
+}
+
+void SequencePatternSummary::Add(uint16_t timestamp, const SequenceEvent& event) {
+  uint16_t step = timestamp / pulsesPerStep;
+  if (step >= SEQUENCE_MAX_PATTERN_LENGTH)
+    return;
+
+  eventSteps |= 1ULL << step;
+  if (event.eventType != SequenceEventType::NoteEvent)
+    return;
+
+  const SequenceEventNote& noteData = std::get<SequenceEventNote>(event.data);
+  noteSteps |= 1ULL << step;
+  if (step >= stepNotes.size())
+  {
+    stepNotes.resize(step + 1);
+  }
+  stepNotes[step].Set(noteData.note);
+  notes.Set(noteData.note);
+  velocityMin = std::min(velocityMin, noteData.velocity);
+  velocityMax = std::max(velocityMax, noteData.velocity);
+}
+
+const SequencePatternSummary& SequencePattern::Summary(uint16_t pulsesPerStep) {
+  if (summaryValid && summary.pulsesPerStep == pulsesPerStep)
+  {
+    return summary;
+  }
+
+  summary = SequencePatternSummary();
+  summary.pulsesPerStep = pulsesPerStep;
+  if (pulsesPerStep > 0)
+  {
+    for (const auto& [timestamp, event] : events)
+    {
+      summary.Add(timestamp, event);
+    }
+  }
+  summaryValid = true;
+  return summary;
+}
+
+void SequencePattern::AddToSummary(uint16_t timestamp, const SequenceEvent& event) {
+  if (summaryValid && summary.pulsesPerStep > 0)
   {
-    it = events.erase(it);
+    summary.Add(timestamp, event);
   }
 }
 
@@ -410,6 +454,7 @@ static bool ParsePattern(cb0r_s node, uint8_t trackId, uint8_t clipId, uint8_t p
   SequencePattern& pat = clip.patterns[patternId];
   pat.steps = steps;
   pat.events.clear();
+  pat.Invalidate();
 
   for (size_t i = 0; i < item.length; i++)
   {
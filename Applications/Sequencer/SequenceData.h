@@ -2,21 +2,108 @@
 
 #include "MatrixOS.h"
 #include "SequenceEvent.h"
+#include "SequenceEventList.h"
 #include <vector>
 #include <cstdint>
+#include <map>
 #include <unordered_map>
 
 #define SEQUENCE_VERSION 4
 #define MIN_SUPPORTED_SEQUENCE_VERSION 3
 
+// Pattern event storage. Set to 1 to build with the previous std::multimap storage for A/B comparison.
+#ifndef SEQUENCE_EVENT_STORAGE_MULTIMAP
+#define SEQUENCE_EVENT_STORAGE_MULTIMAP 0
+#endif
+
+#if SEQUENCE_EVENT_STORAGE_MULTIMAP
+using SequenceEventStore = std::multimap<uint16_t, SequenceEvent>;
+#else
+using SequenceEventStore = SequenceEventList;
+#endif
+
+#define SEQUENCE_MAX_PATTERN_LENGTH 64
+
+// The 128 MIDI notes as a bitset
+struct SequenceNoteSet {
+  uint32_t bits[4] = {0, 0, 0, 0};
+
+  void Set(uint8_t note) {
+    bits[(note >> 5) & 3] |= 1UL << (note & 31);
+  }
+  bool Test(uint8_t note) const {
+    return (bits[(note >> 5) & 3] >> (note & 31)) & 1;
+  }
+  bool Intersects(const SequenceNoteSet& other) const {
+    return (bits[0] & other.bits[0]) | (bits[1] & other.bits[1]) | (bits[2] & other.bits[2]) | (bits[3] & other.bits[3]);
+  }
+};
+
+// What rendering needs to know about a pattern's events, so a frame doesn't have to query the event store per step.
+// Built on first use after the events change, events added through Sequence::PatternAddEvent or recording keep it current.
+struct SequencePatternSummary {
+  uint16_t pulsesPerStep = 0;        // Step size it was built at
+  uint64_t noteSteps = 0;            // Bit n set if a note event starts in step n
+  uint64_t eventSteps = 0;           // Bit n set if any event starts in step n
+  vector<SequenceNoteSet> stepNotes; // Notes starting in each step, up to the last step holding a note
+  SequenceNoteSet notes;             // Every note in the pattern
+  uint8_t velocityMin = 127;         // Over every note event, only meaningful if noteSteps is not 0
+  uint8_t velocityMax = 0;
+
+  void Add(uint16_t timestamp, const SequenceEvent& event);
+
+  bool HasNote(uint8_t step) const {
+    return step < SEQUENCE_MAX_PATTERN_LENGTH && ((noteSteps >> step) & 1);
+  }
+  bool HasEvent(uint8_t step) const {
+    return step < SEQUENCE_MAX_PATTERN_LENGTH && ((eventSteps >> step) & 1);
+  }
+  bool HasAnyNote(uint8_t step, const SequenceNoteSet& filter) const {
+    return step < stepNotes.size() && stepNotes[step].Intersects(filter);
+  }
+};
+
 struct SequencePattern {
   uint8_t steps = 16;
-  std::multimap<uint16_t, SequenceEvent> events;
+  SequenceEventStore events;
+
+  // Derived from events. Code that changes events directly instead of through the Sequence::Pattern* helpers calls Invalidate().
+  SequencePatternSummary summary;
+  bool summaryValid = false;
 
   void Clear();
   void ClearStepEvents(uint8_t step, uint16_t pulsesPerStep);
+
+  void Invalidate() {
+    summaryValid = false;
+  }
+  const SequencePatternSummary& Summary(uint16_t pulsesPerStep);
+  void AddToSummary(uint16_t timestamp, const SequenceEvent& event); // For an event just inserted, keeps a built summary current
 };
 
+// Erase events in [first, last) for which pred(event) is true. Returns the number erased.
+template <typename Pred>
+size_t SequenceEraseIf(SequenceEventStore& events, SequenceEventStore::iterator first, SequenceEventStore::iterator last, Pred pred) {
+#if SEQUENCE_EVENT_STORAGE_MULTIMAP
+  size_t removed = 0;
+  while (first != last)
+  {
+    if (pred(*first))
+    {
+      first = events.erase(first);
+      removed++;
+    }
+    else
+    {
+      ++first;
+    }
+  }
+  return removed;
+#else
+  return events.erase_if(first, last, pred);
+#endif
+}
+
 #define SEQUENCE_MAX_PATTERN_COUNT 16
 
 struct SequenceClip {
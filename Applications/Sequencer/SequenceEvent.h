@@ -7,7 +7,7 @@
 // Forward declaration
 struct SequenceData;
 
-enum class SequenceEventType {
+enum class SequenceEventType : uint8_t {
   Invalid = 0x00,
   NoteEvent = 0x10,
   ControlChangeEvent = 0x20,
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "MatrixOS.h"
+#include "SequenceEvent.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// Pattern events kept in one contiguous array sorted by timestamp.
+// Exposes the subset of the std::multimap interface the sequencer uses, so call sites work with either backend.
+// Events with equal timestamps keep insertion order, same as multimap.
+// Unlike multimap, inserting or erasing invalidates iterators and pointers to later events.
+class SequenceEventList {
+public:
+  using key_type = uint16_t;
+  using value_type = std::pair<uint16_t, SequenceEvent>;
+  using iterator = std::vector<value_type>::iterator;
+  using const_iterator = std::vector<value_type>::const_iterator;
+
+  iterator begin() {
+    return events.begin();
+  }
+  iterator end() {
+    return events.end();
+  }
+  const_iterator begin() const {
+    return events.begin();
+  }
+  const_iterator end() const {
+    return events.end();
+  }
+
+  size_t size() const {
+    return events.size();
+  }
+  bool empty() const {
+    return events.empty();
+  }
+  void clear() {
+    events.clear();
+  }
+  void reserve(size_t count) {
+    events.reserve(count);
+  }
+  void swap(SequenceEventList& other) {
+    events.swap(other.events);
+  }
+
+  iterator lower_bound(uint16_t timestamp) {
+    return std::lower_bound(events.begin(), events.end(), timestamp, KeyLess);
+  }
+  const_iterator lower_bound(uint16_t timestamp) const {
+    return std::lower_bound(events.begin(), events.end(), timestamp, KeyLess);
+  }
+  iterator upper_bound(uint16_t timestamp) {
+    return std::upper_bound(events.begin(), events.end(), timestamp, KeyGreater);
+  }
+  const_iterator upper_bound(uint16_t timestamp) const {
+    return std::upper_bound(events.begin(), events.end(), timestamp, KeyGreater);
+  }
+  std::pair<iterator, iterator> equal_range(uint16_t timestamp) {
+    return {lower_bound(timestamp), upper_bound(timestamp)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(uint16_t timestamp) const {
+    return {lower_bound(timestamp), upper_bound(timestamp)};
+  }
+
+  // Insert after any events with the same timestamp. Appending in time order is O(1).
+  iterator insert(const value_type& event) {
+    if (events.empty() || events.back().first <= event.first)
+    {
+      events.push_back(event);
+      return events.end() - 1;
+    }
+    return events.insert(upper_bound(event.first), event);
+  }
+
+  // Batch insert: append, sort the new run and merge it in once instead of shifting the array per event
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    size_t oldSize = events.size();
+    events.insert(events.end(), first, last);
+    if (events.size() == oldSize)
+    {
+      return;
+    }
+    std::stable_sort(events.begin() + oldSize, events.end(), EventLess);
+    if (oldSize > 0 && events[oldSize].first < events[oldSize - 1].first)
+    {
+      std::inplace_merge(events.begin(), events.begin() + oldSize, events.end(), EventLess);
+    }
+  }
+
+  iterator erase(const_iterator pos) {
+    return events.erase(pos);
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    return events.erase(first, last);
+  }
+
+  // Batch erase of events in [first, last) matching pred, compacting the array once. Returns the number erased.
+  template <typename Pred>
+  size_t erase_if(iterator first, iterator last, Pred pred) {
+    iterator newLast = std::remove_if(first, last, pred);
+    size_t removed = last - newLast;
+    events.erase(newLast, last);
+    return removed;
+  }
+
+private:
+  std::vector<value_type> events;
+
+  static bool KeyLess(const value_type& event, uint16_t timestamp) {
+    return event.first < timestamp;
+  }
+  static bool KeyGreater(uint16_t timestamp, const value_type& event) {
+    return timestamp < event.first;
+  }
+  static bool EventLess(const value_type& a, const value_type& b) {
+    return a.first < b.first;
+  }
+};
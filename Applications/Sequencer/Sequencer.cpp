@@ -20,7 +20,7 @@
 
 void Sequencer::SequenceTask(void* ctx) {
   Sequencer* self = static_cast<Sequencer*>(ctx);
-  for (;;)
+  while (!self->tickTaskExit)
   {
     MidiPacket midiPacket;
     while (MatrixOS::MIDI::Get(&midiPacket))
@@ -28,8 +28,41 @@ void Sequencer::SequenceTask(void* ctx) {
       self->sequence.RecordEvent(midiPacket);
     }
     self->sequence.Tick();
-    taskYIELD();
+    self->sequence.EmitScheduled();
+
+    // Nothing to play, record or clock out. Sleep until the sequence or End() notifies.
+    if (self->sequence.Idle())
+    {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      // Arrived while nothing was recording, don't let it land in a recording started now
+      while (MatrixOS::MIDI::Get(&midiPacket))
+      {
+      }
+      continue;
+    }
+
+    // Block until the next tick, or until the wake timer fires if the next packet is due before then.
+    // Tick() runs SEQUENCE_LOOKAHEAD_US ahead, so packets are queued well before the task wakes for them.
+    uint32_t wait = self->sequence.UsUntilNextEmit();
+    if (wait == 0)
+    {
+      continue;
+    }
+    if (wait < portTICK_PERIOD_MS * 1000 && self->wakeTimer)
+    {
+      Device::WakeTimer::Start(self->wakeTimer, wait);
+    }
+    ulTaskNotifyTake(pdTRUE, 1);
+  }
+
+  // The timer is only started from here, so it can go before End() moves on
+  if (self->wakeTimer)
+  {
+    Device::WakeTimer::Delete(self->wakeTimer);
+    self->wakeTimer = nullptr;
   }
+  xSemaphoreGive(self->tickTaskExited);
+  vTaskDelete(NULL);
 }
 
 void Sequencer::Setup(const vector<string>& args) {
@@ -44,7 +77,12 @@ void Sequencer::Setup(const vector<string>& args) {
 
   if (tickTaskHandle == nullptr)
   {
-    xTaskCreate(SequenceTask, "SeqTick", configMINIMAL_STACK_SIZE * 2, this, 1, &tickTaskHandle);
+    // Above the app and UI so render load can't delay clock output, below the USB and MIDI port tasks that carry it
+    tickTaskExit = false;
+    tickTaskExited = xSemaphoreCreateBinary();
+    xTaskCreate(SequenceTask, "SeqTick", configMINIMAL_STACK_SIZE * 2, this, configMAX_PRIORITIES - 3, &tickTaskHandle);
+    wakeTimer = Device::WakeTimer::Create(tickTaskHandle);
+    sequence.SetTickTask(tickTaskHandle);
   }
 
   SequencerUI();
@@ -54,7 +92,13 @@ void Sequencer::End() {
   sequence.Stop();
   if (tickTaskHandle)
   {
-    vTaskDelete(tickTaskHandle);
+    // Let the tick task finish its pass and exit on its own, it may be mid-pass on the other core
+    sequence.SetTickTask(nullptr);
+    tickTaskExit = true;
+    xTaskNotifyGive(tickTaskHandle);
+    xSemaphoreTake(tickTaskExited, portMAX_DELAY);
+    vSemaphoreDelete(tickTaskExited);
+    tickTaskExited = nullptr;
     tickTaskHandle = nullptr;
   }
 }
@@ -2,6 +2,7 @@
 
 #include "MatrixOS.h"
 #include "Application.h"
+#include <atomic>
 #include <set>
 
 #include "Sequence.h"
@@ -72,6 +73,9 @@ public:
   SequenceMeta meta;
   Sequence sequence;
   TaskHandle_t tickTaskHandle = nullptr;
+  void* wakeTimer = nullptr; // Wakes the tick task for packets due sooner than a FreeRTOS tick
+  std::atomic<bool> tickTaskExit = false;
+  SemaphoreHandle_t tickTaskExited = nullptr; // Given by the tick task right before it deletes itself
 
   uint8_t track = 0;
 
@@ -250,7 +250,7 @@ void Setting::ResetConfirm() {
   confirmResetBtn.SetColor(Color(0xFF0000));
   confirmResetBtn.SetSize(Dimension(2, 2));
   confirmResetBtn.OnPress([]() -> void {
-    Device::NVS::Clear();
+    MatrixOS::NVS::Clear(); // Drops the NVS cache too, or Reboot() would flush its pending writes back
     MatrixOS::SYS::Reboot();
   });
   confirmResetUI.AddUIComponent(confirmResetBtn, Point(5, 5));
@@ -39,6 +39,15 @@ void Log(string& format, va_list& valst);
 
 string GetSerial();
 
+// One-shot timer that wakes a task with a task notification, for waits finer than a FreeRTOS tick.
+// Starting it again before it fired restarts it.
+namespace WakeTimer
+{
+void* Create(TaskHandle_t task);
+void Start(void* timer, uint32_t delayUs);
+void Delete(void* timer);
+} // namespace WakeTimer
+
 namespace LED
 {
 extern const uint16_t fps;
@@ -143,4 +152,9 @@ namespace Input
 {
 bool NewEvent(const InputEvent& event);
 }
+
+namespace NVS
+{
+void Clear(); // Use this instead of Device::NVS::Clear() so the NVS cache is dropped as well
+}
 } // namespace MatrixOS
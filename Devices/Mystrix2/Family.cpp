@@ -3,7 +3,7 @@
 #include "UI/UI.h"
 
 #include "esp_private/system_internal.h" // For esp_reset_reason_set_hint
-#include "esp_timer.h"                   // esp_timer_get_time
+#include "esp_timer.h"                   // esp_timer_get_time, wake timers
 
 #include "esp_efuse.h"
 #include "esp_efuse_table.h"
@@ -265,7 +265,7 @@ void DeviceStart() {
     MatrixOS::LED::SetColor(Point(5, 5), Color(0xFF00FF));
     MatrixOS::LED::Update();
     MatrixOS::SYS::DelayMs(1500);
-    Device::NVS::Clear();
+    MatrixOS::NVS::Clear();
     MatrixOS::SYS::Reboot();
   }
 }
@@ -380,6 +380,37 @@ void ErrorHandler() {}
 uint64_t Micros() {
   return (uint64_t)esp_timer_get_time();
 }
+
+namespace WakeTimer
+{
+static void Fire(void* task) {
+  xTaskNotifyGive((TaskHandle_t)task);
+}
+
+void* Create(TaskHandle_t task) {
+  esp_timer_create_args_t args = {};
+  args.callback = Fire;
+  args.arg = task;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "Wake Timer";
+  esp_timer_handle_t timer = nullptr;
+  if (esp_timer_create(&args, &timer) != ESP_OK)
+  {
+    return nullptr;
+  }
+  return timer;
+}
+
+void Start(void* timer, uint32_t delayUs) {
+  esp_timer_stop((esp_timer_handle_t)timer); // Fails harmlessly if it isn't pending
+  esp_timer_start_once((esp_timer_handle_t)timer, delayUs);
+}
+
+void Delete(void* timer) {
+  esp_timer_stop((esp_timer_handle_t)timer);
+  esp_timer_delete((esp_timer_handle_t)timer);
+}
+} // namespace WakeTimer
 } // namespace Device
 
 namespace MatrixOS::SYS
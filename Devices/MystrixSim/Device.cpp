@@ -3,6 +3,7 @@
 // Rebuilt for OS4.0 Input architecture (InputCluster / InputId / InputEvent).
 
 #include "Device.h"
+#include "Headless.h"
 #include "HostIO.h"
 #include "MatrixOS.h"
 #include "../../Applications/Application.h"
@@ -45,13 +46,13 @@ struct KeyState {
 
 KeyState fnState;
 KeyState gridState[X_SIZE * Y_SIZE];
-KeyState touchbarLeftState[8];
-KeyState touchbarRightState[8];
+KeyState touchbarLeftState[TOUCHBAR_SIZE];
+KeyState touchbarRightState[TOUCHBAR_SIZE];
 
 Direction deviceRotation = TOP;
 
 // LED framebuffer visible to WASM host
-Color ledFrameBuffer[64 + 32];
+Color ledFrameBuffer[X_SIZE * Y_SIZE + UNDERGLOW_SIZE];
 std::mutex ledMutex;
 
 // Rotation-aware LED index mapping (rebuilt on rotation change)
@@ -309,11 +310,11 @@ KeyState* GetKeyState(InputId id) {
   {
     return &gridState[id.memberId];
   }
-  if (id.clusterId == 2 && id.memberId < 8)
+  if (id.clusterId == 2 && id.memberId < TOUCHBAR_SIZE)
   {
     return &touchbarLeftState[id.memberId];
   }
-  if (id.clusterId == 3 && id.memberId < 8)
+  if (id.clusterId == 3 && id.memberId < TOUCHBAR_SIZE)
   {
     return &touchbarRightState[id.memberId];
   }
@@ -341,7 +342,13 @@ bool EmitKeyEvent(InputId id, KeyState* ks) {
   event.id = id;
   event.inputClass = InputClass::Keypad;
   event.keypad = ks->info;
-  bool emitted = MatrixOS::Input::NewEvent(event);
+  bool emitted;
+  {
+    // The OS input ring is single producer; host key, touch bar and tick calls can come from different threads.
+    static std::mutex inputProducerMutex;
+    std::lock_guard<std::mutex> lock(inputProducerMutex);
+    emitted = MatrixOS::Input::NewEvent(event);
+  }
   if (ks->info.state == KeypadState::Released)
   {
     ks->info.state = KeypadState::Idle;
@@ -473,7 +480,7 @@ static Point GetTouchBarPhysicalPoint(uint8_t clusterId, uint16_t memberId) {
 
 static void GetTouchBarBounds(uint8_t clusterId, Point* rootPoint, Dimension* dimension) {
   const Point physicalStart = (clusterId == 2) ? Point(-1, 0) : Point(X_SIZE, 0);
-  const Point physicalEnd = (clusterId == 2) ? Point(-1, 7) : Point(X_SIZE, 7);
+  const Point physicalEnd = (clusterId == 2) ? Point(-1, TOUCHBAR_SIZE - 1) : Point(X_SIZE, TOUCHBAR_SIZE - 1);
   const Point rotatedStart = RotatePhysicalPoint(physicalStart);
   const Point rotatedEnd = RotatePhysicalPoint(physicalEnd);
   rootPoint->x = std::min(rotatedStart.x, rotatedEnd.x);
@@ -604,7 +611,7 @@ void RegisterInputClusters() {
   touchbarLeftCluster.name = "TouchBarLeft";
   touchbarLeftCluster.inputClass = InputClass::Keypad;
   touchbarLeftCluster.shape = InputClusterShape::Linear1D;
-  touchbarLeftCluster.inputCount = 8;
+  touchbarLeftCluster.inputCount = TOUCHBAR_SIZE;
   Input::GetTouchBarBounds(2, &touchbarLeftCluster.rootPoint, &touchbarLeftCluster.dimension);
   touchbarLeftCluster.getPosition = Input::TouchBarGetPosition;
   touchbarLeftCluster.tryGetMemberId = Input::TouchBarTryGetMemberId;
@@ -616,7 +623,7 @@ void RegisterInputClusters() {
   touchbarRightCluster.name = "TouchBarRight";
   touchbarRightCluster.inputClass = InputClass::Keypad;
   touchbarRightCluster.shape = InputClusterShape::Linear1D;
-  touchbarRightCluster.inputCount = 8;
+  touchbarRightCluster.inputCount = TOUCHBAR_SIZE;
   Input::GetTouchBarBounds(3, &touchbarRightCluster.rootPoint, &touchbarRightCluster.dimension);
   touchbarRightCluster.getPosition = Input::TouchBarGetPosition;
   touchbarRightCluster.tryGetMemberId = Input::TouchBarTryGetMemberId;
@@ -630,10 +637,13 @@ namespace LED
 void Update(Color* frameBuffer, vector<uint8_t>& brightness) {
   std::lock_guard<std::mutex> lock(ledMutex);
   uint16_t totalLEDs = Device::LED::count;
-  for (uint16_t i = 0; i < totalLEDs && i < (64 + 32); i++)
+  for (uint16_t i = 0; i < totalLEDs && i < X_SIZE * Y_SIZE + UNDERGLOW_SIZE; i++)
   {
     ledFrameBuffer[i] = frameBuffer[i];
   }
+#ifndef __EMSCRIPTEN__
+  MystrixSim::Headless::TapFrame(ledFrameBuffer, std::min<uint16_t>(totalLEDs, X_SIZE * Y_SIZE + UNDERGLOW_SIZE));
+#endif
 }
 
 uint16_t XY2Index(Point xy) {
@@ -771,7 +781,7 @@ void Delay(uint32_t interval) {
 }
 
 uint32_t Millis() {
-  return ((((uint64_t)xTaskGetTickCount()) * 1000) / configTICK_RATE_HZ);
+  return ullSimGetMicros() / 1000;
 }
 
 void Log(string& format, va_list& valst) {
@@ -782,12 +792,35 @@ string GetSerial() {
   return "MYSTRIXSIM000000";
 }
 
-void ErrorHandler() {}
+void ErrorHandler() {
+#ifndef __EMSCRIPTEN__
+  MystrixSim::Headless::SystemError();
+#endif
+}
 
 uint64_t Micros() {
-  return Millis() * 1000ULL;
+  return ullSimGetMicros();
+}
+
+namespace WakeTimer
+{
+static void Fire(TimerHandle_t timer) {
+  xTaskNotifyGive((TaskHandle_t)pvTimerGetTimerID(timer));
 }
 
+void* Create(TaskHandle_t task) {
+  return xTimerCreate("Wake Timer", 1, pdFALSE, task, Fire);
+}
+
+void Start(void* timer, uint32_t delayUs) {
+  xSimTimerStartOnceUs((TimerHandle_t)timer, delayUs);
+}
+
+void Delete(void* timer) {
+  xTimerDelete((TimerHandle_t)timer, 0);
+}
+} // namespace WakeTimer
+
 } // namespace Device
 
 // ---------------------------------------------------------------------------
@@ -871,16 +904,16 @@ void MatrixOS_Wasm_KeypadTick(void) {
     TickHoldEvent(id, &gridState[keyIndex], now);
   }
 
-  for (uint16_t i = 0; i < 8; i++)
+  for (uint16_t i = 0; i < TOUCHBAR_SIZE; i++)
   {
     TickHoldEvent({2, i}, &touchbarLeftState[i], now);
     TickHoldEvent({3, i}, &touchbarRightState[i], now);
   }
 }
 
-// side: 0 = left (cluster 2), 1 = right (cluster 3); index: 0..7
+// side: 0 = left (cluster 2), 1 = right (cluster 3); index: 0..TOUCHBAR_SIZE - 1
 void MatrixOS_Wasm_TouchBarEvent(uint8_t side, uint16_t index, bool pressed) {
-  if (index >= 8)
+  if (index >= TOUCHBAR_SIZE)
     return;
   uint8_t clusterId = (side == 0) ? 2 : 3;
   KeyState* ks = (side == 0) ? &touchbarLeftState[index] : &touchbarRightState[index];
@@ -1113,6 +1146,7 @@ uint8_t MatrixOS_Wasm_SerialInjectRx(const char* data, uint32_t length) {
 // ---- NVS exports ----
 
 uint32_t MatrixOS_Wasm_NvsGetCount(void) {
+  MatrixOS::NVS::Flush(); // Include writes still pending in the cache
   std::lock_guard<std::mutex> lock(nvsMutex);
   return nvsStore.size();
 }
@@ -1120,6 +1154,7 @@ uint32_t MatrixOS_Wasm_NvsGetCount(void) {
 static uint32_t nvsHashBuffer[256];
 
 uint32_t* MatrixOS_Wasm_NvsGetHashes(void) {
+  MatrixOS::NVS::Flush(); // Variables only written to the cache so far aren't in the store yet
   std::lock_guard<std::mutex> lock(nvsMutex);
   uint32_t i = 0;
   for (const auto& [hash, data] : nvsStore) {
@@ -1129,14 +1164,15 @@ uint32_t* MatrixOS_Wasm_NvsGetHashes(void) {
   return nvsHashBuffer;
 }
 
+// Reads go through the OS NVS cache too, the store lags behind it until the next flush
 uint32_t MatrixOS_Wasm_NvsGetSize(uint32_t hash) {
-  return Device::NVS::Size(hash);
+  return MatrixOS::NVS::GetSize(hash);
 }
 
 static char nvsReadBuffer[4096];
 
 uint8_t* MatrixOS_Wasm_NvsGetData(uint32_t hash) {
-  auto data = Device::NVS::Read(hash);
+  auto data = MatrixOS::NVS::GetVariable(hash);
   if (data.empty()) return nullptr;
   uint32_t len = data.size();
   if (len > sizeof(nvsReadBuffer)) len = sizeof(nvsReadBuffer);
@@ -1144,21 +1180,27 @@ uint8_t* MatrixOS_Wasm_NvsGetData(uint32_t hash) {
   return reinterpret_cast<uint8_t*>(nvsReadBuffer);
 }
 
+// Edits from the host go through the OS NVS cache so it never serves stale values
 bool MatrixOS_Wasm_NvsWrite(uint32_t hash, uint8_t* data, uint16_t length) {
-  return Device::NVS::Write(hash, data, length);
+  bool success = MatrixOS::NVS::SetVariable(hash, data, length);
+  MatrixOS::NVS::Flush();
+  return success;
 }
 
 bool MatrixOS_Wasm_NvsDelete(uint32_t hash) {
-  return Device::NVS::Delete(hash);
+  bool success = MatrixOS::NVS::DeleteVariable(hash);
+  MatrixOS::NVS::Flush();
+  return success;
 }
 
 void MatrixOS_Wasm_NvsClear(void) {
-  Device::NVS::Clear();
+  MatrixOS::NVS::Clear();
 }
 
 static vector<uint8_t> nvsExportBuffer;
 
 uint8_t* MatrixOS_Wasm_NvsExport(void) {
+  MatrixOS::NVS::Flush(); // Include writes still pending in the cache
   std::lock_guard<std::mutex> lock(nvsMutex);
   nvsExportBuffer.clear();
   uint32_t count = nvsStore.size();
@@ -1178,8 +1220,8 @@ uint32_t MatrixOS_Wasm_NvsExportSize(void) {
 }
 
 void MatrixOS_Wasm_NvsImport(uint8_t* data, uint32_t totalLength) {
+  MatrixOS::NVS::Clear();
   std::lock_guard<std::mutex> lock(nvsMutex);
-  nvsStore.clear();
   if (totalLength < 4) return;
   uint32_t count;
   memcpy(&count, data, 4);
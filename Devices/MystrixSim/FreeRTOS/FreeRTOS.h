@@ -49,12 +49,19 @@ typedef enum {
 
 #define tskIDLE_PRIORITY 0
 #define configMAX_PRIORITIES 8
+#define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1)
 #define configMINIMAL_STACK_SIZE 128
 #define configTOTAL_HEAP_SIZE (1024 * 1024)
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
 
 #define portMAX_DELAY 0xffffffffu
 
+// Run time counters are host CPU microseconds, not available in the browser
+#ifndef __EMSCRIPTEN__
+#define configGENERATE_RUN_TIME_STATS 1
+#define portGET_RUN_TIME_COUNTER_VALUE() ulSimGetRunTimeCounterValue()
+#endif
+
 #ifndef IRAM_ATTR
 #define IRAM_ATTR
 #endif
@@ -5,23 +5,39 @@
 #include "task.h"
 #include "timers.h"
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <csetjmp>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <deque>
+#include <memory>
 #include <mutex>
+#include <queue>
 #include <thread>
 #include <unordered_map>
+
+#include <pthread.h>
+#include <time.h>
 #include <vector>
 
 namespace
 {
+  constexpr uint64_t FOREVER = UINT64_MAX;
+
+  // Virtual time a yield costs, so a task spinning on the clock still sees it move
+  constexpr uint64_t VIRTUAL_YIELD_US = 10;
+
   struct TaskControl {
     TaskFunction_t function = nullptr;
     void* parameter = nullptr;
+    UBaseType_t priority = 0;
+    UBaseType_t stack_depth = 0;
+    std::thread::id thread_id; // Set under g_task_mutex once the thread starts
+    pthread_t native_thread{};
     std::atomic<bool> running{false};
     std::atomic<bool> deleted{false};
     std::atomic<bool> suspended{false};
@@ -39,14 +55,28 @@ namespace
     bool selfDeleteJmpSet = false;
 
     void* tls[configNUM_THREAD_LOCAL_STORAGE_POINTERS] = {};
+
+    // Virtual time scheduling, guarded by the scheduler mutex
+    bool scheduled = false; // Created in virtual time, only runs while it holds the baton
+    bool has_baton = false;
+    bool ready = false;
+    bool blocked = false;
+    const void* block_object = nullptr;
+    uint64_t block_deadline = FOREVER;
+    std::condition_variable baton_cv;
   };
 
+  // Fixed-slot ring sized at creation, so sending and receiving never allocate (matches xQueueCreate on device)
   struct QueueControl {
     size_t item_size = 0;
     size_t capacity = 0;
-    std::deque<std::vector<uint8_t>> items;
+    std::unique_ptr<uint8_t[]> storage;
+    size_t head = 0;
+    size_t count = 0;
     std::mutex mutex;
-    std::condition_variable cv;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    SimQueueStats stats = {};
   };
 
   struct SemaphoreControl {
@@ -61,10 +91,20 @@ namespace
   struct TimerControl {
     TickType_t period_ticks = 0;
     BaseType_t auto_reload = pdFALSE;
+    bool once = false; // Started by xSimTimerStartOnceUs, doesn't reload
     void* id = nullptr;
     TimerCallbackFunction_t callback = nullptr;
-    std::atomic<bool> active{false};
-    std::thread worker;
+    bool active = false;
+    bool delete_pending = false; // Deleted while its callback ran, freed once it returns
+    uint32_t generation = 0; // Bumped on every start and stop so stale heap entries are skipped
+  };
+
+  struct TimerDeadline {
+    uint64_t deadline; // Microseconds on the stub clock
+    uint32_t generation;
+    TimerControl* timer;
+
+    bool operator>(const TimerDeadline& other) const { return deadline > other.deadline; }
   };
 
   struct MessageBufferControl {
@@ -79,6 +119,48 @@ namespace
   std::unordered_map<std::thread::id, TaskControl*> g_tasks;
   thread_local TaskControl* g_current_task = nullptr;
 
+  std::mutex g_queue_registry_mutex;
+  std::vector<QueueControl*> g_queues;
+
+  // All software timers are serviced by one daemon task from a deadline heap, like the FreeRTOS timer task.
+  // Never destroyed, the daemon is still waiting on it at exit.
+  struct TimerService {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::priority_queue<TimerDeadline, std::vector<TimerDeadline>, std::greater<TimerDeadline>> heap;
+    bool changed = false; // A timer was started since the daemon last looked at the heap
+    bool daemon_started = false;
+    TaskHandle_t daemon = nullptr;
+    TimerControl* firing = nullptr; // Timer whose callback is running, outside the mutex
+  };
+
+  TimerService& Timers()
+  {
+    static TimerService* service = new TimerService();
+    return *service;
+  }
+
+  // Virtual time: one task runs at a time and hands the baton on whenever it blocks, highest priority first.
+  // The clock only moves once every task is blocked, straight to the earliest deadline, so a run is reproducible
+  // and idle time costs nothing. Never destroyed, tasks are still parked on it at exit.
+  struct Scheduler {
+    std::mutex mutex;
+    std::condition_variable idle_cv;
+    TaskControl* running = nullptr;
+    std::vector<TaskControl*> ready; // In the order they became ready
+    std::vector<TaskControl*> blocked;
+    uint64_t horizon = FOREVER; // Stepped mode, the clock doesn't pass this until the host steps again
+  };
+
+  Scheduler& Sched()
+  {
+    static Scheduler* scheduler = new Scheduler();
+    return *scheduler;
+  }
+
+  std::atomic<bool> g_virtual_time{false};
+  std::atomic<uint64_t> g_virtual_now{0};
+
   std::atomic<eTaskSchedulerState> g_scheduler_state{taskSCHEDULER_NOT_STARTED};
   auto g_start_time = std::chrono::steady_clock::now();
 
@@ -91,10 +173,353 @@ namespace
     return g_current_task;
   }
 
-  TickType_t MsToTicks(uint32_t ms)
+  uint64_t NowMicros()
+  {
+    if (g_virtual_time.load())
+    {
+      return g_virtual_now.load();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - g_start_time;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  }
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+  uint32_t CpuClockMicros(clockid_t clock)
+  {
+    timespec time;
+    if (clock_gettime(clock, &time) != 0)
+    {
+      return 0;
+    }
+    return static_cast<uint32_t>(static_cast<uint64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000);
+  }
+#endif
+
+  uint64_t DeadlineAfter(TickType_t ticks)
+  {
+    if (ticks == portMAX_DELAY)
+    {
+      return FOREVER;
+    }
+    return NowMicros() + static_cast<uint64_t>(ticks) * portTICK_PERIOD_MS * 1000;
+  }
+
+  // Scheduler helpers below expect the scheduler mutex to be held
+  void MakeReady(Scheduler& sched, TaskControl* task)
+  {
+    if (task->blocked)
+    {
+      task->blocked = false;
+      sched.blocked.erase(std::find(sched.blocked.begin(), sched.blocked.end(), task));
+    }
+    if (!task->ready && !task->has_baton)
+    {
+      task->ready = true;
+      sched.ready.push_back(task);
+    }
+  }
+
+  void Forget(Scheduler& sched, TaskControl* task)
+  {
+    if (task->blocked)
+    {
+      task->blocked = false;
+      sched.blocked.erase(std::find(sched.blocked.begin(), sched.blocked.end(), task));
+    }
+    if (task->ready)
+    {
+      task->ready = false;
+      sched.ready.erase(std::find(sched.ready.begin(), sched.ready.end(), task));
+    }
+    task->has_baton = false;
+    if (sched.running == task)
+    {
+      sched.running = nullptr;
+    }
+  }
+
+  // Hands the baton to the next ready task. With nothing ready, moves the clock to the earliest deadline.
+  void Dispatch(Scheduler& sched)
+  {
+    while (sched.running == nullptr)
+    {
+      if (!sched.ready.empty())
+      {
+        auto next = sched.ready.begin();
+        for (auto it = sched.ready.begin(); it != sched.ready.end(); it++)
+        {
+          if ((*it)->priority > (*next)->priority)
+          {
+            next = it;
+          }
+        }
+        TaskControl* task = *next;
+        sched.ready.erase(next);
+        task->ready = false;
+        task->has_baton = true;
+        sched.running = task;
+        task->baton_cv.notify_one();
+        return;
+      }
+
+      uint64_t deadline = FOREVER;
+      for (TaskControl* task : sched.blocked)
+      {
+        deadline = std::min(deadline, task->block_deadline);
+      }
+      if (deadline == FOREVER || deadline > sched.horizon)
+      {
+        if (sched.horizon != FOREVER && g_virtual_now.load() < sched.horizon)
+        {
+          g_virtual_now = sched.horizon;
+        }
+        sched.idle_cv.notify_all();
+        return;
+      }
+
+      if (deadline > g_virtual_now.load())
+      {
+        g_virtual_now = deadline;
+      }
+      for (size_t i = 0; i < sched.blocked.size();)
+      {
+        TaskControl* task = sched.blocked[i];
+        if (task->block_deadline <= deadline)
+        {
+          MakeReady(sched, task); // Removes it from blocked
+        }
+        else
+        {
+          i++;
+        }
+      }
+    }
+  }
+
+  void Register(Scheduler& sched, TaskControl* task, const void* object, uint64_t deadline)
+  {
+    task->block_object = object;
+    task->block_deadline = deadline;
+    if (!task->blocked)
+    {
+      task->blocked = true;
+      sched.blocked.push_back(task);
+    }
+  }
+
+  // Gives up the baton until the task is made ready again by SimWake(object) or its deadline.
+  // Registered tasks signed up earlier, and keep the baton if they were woken in between.
+  void Block(TaskControl* task, const void* object, uint64_t deadline, bool registered = false)
+  {
+    Scheduler& sched = Sched();
+    std::unique_lock<std::mutex> lock(sched.mutex);
+    if (registered && !task->blocked)
+    {
+      return;
+    }
+    Register(sched, task, object, deadline);
+    task->has_baton = false;
+    if (sched.running == task)
+    {
+      sched.running = nullptr;
+    }
+    Dispatch(sched);
+    task->baton_cv.wait(lock, [task]() { return task->has_baton; });
+  }
+
+  // Readies every task blocked on object. Wakers still notify their condition variable for tasks on real time.
+  void SimWake(const void* object)
+  {
+    if (!g_virtual_time.load())
+    {
+      return;
+    }
+    Scheduler& sched = Sched();
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    for (size_t i = 0; i < sched.blocked.size();)
+    {
+      TaskControl* task = sched.blocked[i];
+      if (task->block_object == object)
+      {
+        MakeReady(sched, task);
+      }
+      else
+      {
+        i++;
+      }
+    }
+    Dispatch(sched);
+  }
+
+  void ExitIfDeleted(TaskControl* control)
+  {
+    if (control && control->deleted.load() && control->selfDeleteJmpSet)
+    {
+      std::longjmp(control->selfDeleteJmp, 1);
+    }
+  }
+
+  // Waits on cv until pred holds or the deadline passes, returns pred. lock is held on entry and on return.
+  // A task on virtual time gives up the baton instead, registered before the lock is dropped so no wake is missed.
+  template <typename Predicate>
+  bool WaitUntil(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, const void* object, uint64_t deadline,
+                 Predicate pred)
+  {
+    TaskControl* control = g_current_task;
+    if (control == nullptr || !control->scheduled)
+    {
+      if (deadline == FOREVER)
+      {
+        cv.wait(lock, pred);
+        return true;
+      }
+      uint64_t now = NowMicros();
+      return cv.wait_for(lock, std::chrono::microseconds(deadline > now ? deadline - now : 0), pred);
+    }
+
+    while (!pred())
+    {
+      if (NowMicros() >= deadline)
+      {
+        return false;
+      }
+      {
+        Scheduler& sched = Sched();
+        std::lock_guard<std::mutex> schedLock(sched.mutex);
+        Register(sched, control, object, deadline);
+      }
+      lock.unlock();
+      Block(control, object, deadline, true);
+      if (control->deleted.load() && control->selfDeleteJmpSet)
+      {
+        std::longjmp(control->selfDeleteJmp, 1);
+      }
+      lock.lock();
+    }
+    return true;
+  }
+
+  void SleepFor(uint64_t microseconds)
+  {
+    TaskControl* control = g_current_task;
+    if (control == nullptr || !control->scheduled)
+    {
+      std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+      return;
+    }
+    Block(control, nullptr, NowMicros() + microseconds);
+    ExitIfDeleted(control);
+  }
+
+  // Check deletion / suspension (mirrors real scheduler preemption points).
+  void PreemptionPoint(TaskControl* control)
+  {
+    if (!control)
+    {
+      return;
+    }
+    ExitIfDeleted(control);
+    if (control->suspended.load())
+    {
+      std::unique_lock<std::mutex> lock(control->suspend_mutex);
+      WaitUntil(lock, control->suspend_cv, &control->suspended, FOREVER,
+                [control]() { return !control->suspended.load() || control->deleted.load(); });
+      lock.unlock();
+      ExitIfDeleted(control);
+    }
+  }
+
+  TickType_t MsToTicks(uint64_t ms)
   {
     return static_cast<TickType_t>(ms / portTICK_PERIOD_MS);
   }
+
+  void TimerDaemon(void*)
+  {
+    TimerService& timers = Timers();
+    std::unique_lock<std::mutex> lock(timers.mutex);
+    while (true)
+    {
+      uint64_t deadline = FOREVER;
+      if (!timers.heap.empty())
+      {
+        TimerDeadline next = timers.heap.top();
+        if (!next.timer->active || next.generation != next.timer->generation)
+        {
+          timers.heap.pop();
+          continue;
+        }
+        deadline = next.deadline;
+      }
+
+      if (NowMicros() < deadline)
+      {
+        // Woken early when a timer is started, recheck the earliest deadline
+        timers.changed = false;
+        WaitUntil(lock, timers.cv, &timers, deadline, [&timers]() { return timers.changed; });
+        continue;
+      }
+
+      TimerDeadline next = timers.heap.top();
+      timers.heap.pop();
+      TimerControl* timer = next.timer;
+
+      if (timer->auto_reload && !timer->once)
+      {
+        // Reload from the deadline so the period doesn't drift, skip periods the callback overran
+        uint64_t period = static_cast<uint64_t>(timer->period_ticks) * portTICK_PERIOD_MS * 1000;
+        uint64_t reload = next.deadline + period;
+        uint64_t now = NowMicros();
+        if (reload <= now)
+        {
+          reload = now + period;
+        }
+        timers.heap.push({reload, timer->generation, timer});
+      }
+      else
+      {
+        timer->active = false;
+      }
+
+      timers.firing = timer;
+      lock.unlock();
+      timer->callback(timer);
+      lock.lock();
+      timers.firing = nullptr;
+      if (timer->delete_pending)
+      {
+        delete timer;
+      }
+    }
+  }
+
+  BaseType_t StartTimer(TimerControl* timer, uint64_t delayMicros, bool once)
+  {
+    if (!timer || !timer->callback)
+    {
+      return pdFALSE;
+    }
+
+    TimerService& timers = Timers();
+    {
+      std::lock_guard<std::mutex> lock(timers.mutex);
+      if (!timers.daemon_started)
+      {
+        xTaskCreate(TimerDaemon, "Timer Service", configMINIMAL_STACK_SIZE, nullptr, configTIMER_TASK_PRIORITY, &timers.daemon);
+        timers.daemon_started = true;
+      }
+
+      // Starting an active timer restarts its period, as on FreeRTOS
+      timer->active = true;
+      timer->once = once;
+      timer->generation++;
+      timers.heap.push({NowMicros() + delayMicros, timer->generation, timer});
+      timers.changed = true;
+    }
+    timers.cv.notify_one();
+    SimWake(&timers);
+    return pdTRUE;
+  }
 }
 
 extern "C" {
@@ -140,8 +565,6 @@ BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint16_t stackDept
                        TaskHandle_t* taskHandle)
 {
   (void)name;
-  (void)stackDepth;
-  (void)priority;
 
   if (!task)
   {
@@ -151,13 +574,32 @@ BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint16_t stackDept
   auto* control = new TaskControl();
   control->function = task;
   control->parameter = params;
+  control->priority = priority;
+  control->stack_depth = stackDepth;
   control->running = true;
 
-  std::thread worker([control]() {
+  Scheduler& sched = Sched();
+  if (g_virtual_time.load())
+  {
+    // Queued now so the order tasks are created in decides who runs first, not thread start up
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    control->scheduled = true;
+    MakeReady(sched, control);
+  }
+
+  std::thread worker([control, &sched]() {
     g_current_task = control;
     {
       std::lock_guard<std::mutex> lock(g_task_mutex);
       g_tasks[std::this_thread::get_id()] = control;
+      control->thread_id = std::this_thread::get_id();
+      control->native_thread = pthread_self();
+    }
+
+    if (control->scheduled)
+    {
+      std::unique_lock<std::mutex> lock(sched.mutex);
+      control->baton_cv.wait(lock, [control]() { return control->has_baton; });
     }
 
     // setjmp returns 0 on initial call; vTaskDelete(self) longjmps back
@@ -165,7 +607,10 @@ BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint16_t stackDept
     if (setjmp(control->selfDeleteJmp) == 0)
     {
       control->selfDeleteJmpSet = true;
-      control->function(control->parameter);
+      if (!control->deleted.load())
+      {
+        control->function(control->parameter);
+      }
     }
 
     control->running = false;
@@ -173,10 +618,23 @@ BaseType_t xTaskCreate(TaskFunction_t task, const char* name, uint16_t stackDept
       std::lock_guard<std::mutex> lock(g_task_mutex);
       g_tasks.erase(std::this_thread::get_id());
     }
+    if (control->scheduled)
+    {
+      std::lock_guard<std::mutex> lock(sched.mutex);
+      Forget(sched, control);
+      Dispatch(sched);
+    }
     g_current_task = nullptr;
   });
   worker.detach();
 
+  if (control->scheduled)
+  {
+    // Picks the new task up straight away when it was created from outside the scheduler
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    Dispatch(sched);
+  }
+
   if (taskHandle)
   {
     *taskHandle = control;
@@ -211,61 +669,47 @@ void vTaskDelete(TaskHandle_t task)
     std::lock_guard<std::mutex> lock(control->notify_mutex);
   }
   control->notify_cv.notify_all();
+
+  if (control->scheduled)
+  {
+    Scheduler& sched = Sched();
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    if (control->blocked)
+    {
+      MakeReady(sched, control);
+    }
+    Dispatch(sched);
+  }
 }
 
 void vTaskDelay(TickType_t ticks)
 {
   // Check deletion / suspension before sleeping (mirrors real scheduler behaviour).
   TaskControl* control = g_current_task;
-  if (control)
+  PreemptionPoint(control);
+  if (ticks == 0 && control && control->scheduled)
   {
-    if (control->deleted.load() && control->selfDeleteJmpSet)
-    {
-      std::longjmp(control->selfDeleteJmp, 1);
-    }
-    if (control->suspended.load())
-    {
-      std::unique_lock<std::mutex> lock(control->suspend_mutex);
-      control->suspend_cv.wait(lock,
-                               [control]() { return !control->suspended.load() || control->deleted.load(); });
-      if (control->deleted.load() && control->selfDeleteJmpSet)
-      {
-        std::longjmp(control->selfDeleteJmp, 1);
-      }
-    }
+    SleepFor(VIRTUAL_YIELD_US);
+    return;
   }
-  std::this_thread::sleep_for(std::chrono::milliseconds(ticks * portTICK_PERIOD_MS));
+  SleepFor(static_cast<uint64_t>(ticks) * portTICK_PERIOD_MS * 1000);
 }
 
 void taskYIELD(void)
 {
-  // Check deletion / suspension (mirrors real scheduler preemption points).
   TaskControl* control = g_current_task;
-  if (control)
+  PreemptionPoint(control);
+  if (control && control->scheduled)
   {
-    if (control->deleted.load() && control->selfDeleteJmpSet)
-    {
-      std::longjmp(control->selfDeleteJmp, 1);
-    }
-    if (control->suspended.load())
-    {
-      std::unique_lock<std::mutex> lock(control->suspend_mutex);
-      control->suspend_cv.wait(lock,
-                               [control]() { return !control->suspended.load() || control->deleted.load(); });
-      if (control->deleted.load() && control->selfDeleteJmpSet)
-      {
-        std::longjmp(control->selfDeleteJmp, 1);
-      }
-    }
+    SleepFor(VIRTUAL_YIELD_US);
+    return;
   }
   std::this_thread::yield();
 }
 
 TickType_t xTaskGetTickCount(void)
 {
-  auto now = std::chrono::steady_clock::now();
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now - g_start_time).count();
-  return static_cast<TickType_t>(MsToTicks(static_cast<uint32_t>(ms)));
+  return MsToTicks(NowMicros() / 1000);
 }
 
 eTaskSchedulerState xTaskGetSchedulerState(void)
@@ -276,6 +720,18 @@ eTaskSchedulerState xTaskGetSchedulerState(void)
 void vTaskStartScheduler(void)
 {
   g_scheduler_state.store(taskSCHEDULER_RUNNING);
+
+  // The thread that turned virtual time on leaves the schedule here, like main() never running again on device
+  TaskControl* control = g_current_task;
+  if (control && control->scheduled)
+  {
+    Scheduler& sched = Sched();
+    std::lock_guard<std::mutex> lock(sched.mutex);
+    Forget(sched, control);
+    control->scheduled = false;
+    Dispatch(sched);
+  }
+
   while (true)
   {
     std::this_thread::sleep_for(std::chrono::seconds(1));
@@ -298,7 +754,8 @@ void vTaskSuspend(TaskHandle_t task)
   control->suspended = true;
   if (control == g_current_task)
   {
-    control->suspend_cv.wait(lock, [control]() { return !control->suspended.load() || control->deleted.load(); });
+    WaitUntil(lock, control->suspend_cv, &control->suspended, FOREVER,
+              [control]() { return !control->suspended.load() || control->deleted.load(); });
     if (control->deleted.load() && control->selfDeleteJmpSet)
     {
       lock.unlock();
@@ -319,6 +776,7 @@ void vTaskResume(TaskHandle_t task)
     control->suspended = false;
   }
   control->suspend_cv.notify_all();
+  SimWake(&control->suspended);
 }
 
 void vTaskSuspendAll(void)
@@ -359,15 +817,8 @@ uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait)
     {
       return 0;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      control->notify_cv.wait(lock, [control]() { return control->notify_count > 0 || control->deleted.load(); });
-    }
-    else
-    {
-      control->notify_cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS),
-                                  [control]() { return control->notify_count > 0 || control->deleted.load(); });
-    }
+    WaitUntil(lock, control->notify_cv, &control->notify_count, DeadlineAfter(ticksToWait),
+              [control]() { return control->notify_count > 0 || control->deleted.load(); });
   }
 
   // Woke due to deletion – terminate the task.
@@ -404,6 +855,7 @@ void xTaskNotifyGive(TaskHandle_t task)
     control->notify_count++;
   }
   control->notify_cv.notify_all();
+  SimWake(&control->notify_count);
 }
 
 void* pvTaskGetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index)
@@ -426,11 +878,123 @@ void vTaskSetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index, void
   control->tls[index] = value;
 }
 
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+  TaskControl* control = ResolveTask(task);
+  return control ? control->priority : tskIDLE_PRIORITY;
+}
+
+// Tasks run on host thread stacks and never touch the one they were given, so all of it is reported free
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  TaskControl* control = ResolveTask(task);
+  return control ? control->stack_depth : 0;
+}
+
+#if (configGENERATE_RUN_TIME_STATS == 1)
+// Host CPU time, so shares stay meaningful on virtual time too
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t task)
+{
+  TaskControl* control = ResolveTask(task);
+  if (!control)
+  {
+    return 0;
+  }
+
+  // The thread can't exit while the lock is held, it has to remove itself from g_tasks first
+  std::lock_guard<std::mutex> lock(g_task_mutex);
+  auto entry = g_tasks.find(control->thread_id);
+  clockid_t clock;
+  if (entry == g_tasks.end() || entry->second != control || pthread_getcpuclockid(control->native_thread, &clock) != 0)
+  {
+    return 0;
+  }
+  return CpuClockMicros(clock);
+}
+
+uint32_t ulSimGetRunTimeCounterValue(void)
+{
+  return CpuClockMicros(CLOCK_PROCESS_CPUTIME_ID);
+}
+#endif
+
+void vSimEnableVirtualTime(BaseType_t stepped)
+{
+  if (g_virtual_time.load())
+  {
+    return;
+  }
+
+  Scheduler& sched = Sched();
+  std::lock_guard<std::mutex> lock(sched.mutex);
+  g_virtual_now = 0; // Every run starts from the same instant
+  sched.horizon = stepped ? g_virtual_now.load() : FOREVER;
+
+  // The calling thread (normally main) becomes a task holding the baton until vTaskStartScheduler
+  TaskControl* control = g_current_task;
+  if (control == nullptr)
+  {
+    control = new TaskControl();
+    control->running = true;
+    g_current_task = control;
+    std::lock_guard<std::mutex> taskLock(g_task_mutex);
+    g_tasks[std::this_thread::get_id()] = control;
+    control->thread_id = std::this_thread::get_id();
+    control->native_thread = pthread_self();
+  }
+  control->scheduled = true;
+  control->has_baton = true;
+  sched.running = control;
+  g_virtual_time = true;
+}
+
+void vSimStep(uint64_t microseconds)
+{
+  if (!g_virtual_time.load())
+  {
+    std::this_thread::sleep_for(std::chrono::microseconds(microseconds));
+    return;
+  }
+
+  // A scheduled thread would wait for itself to go idle. That includes the thread that turned virtual time on, until
+  // it hands off in vTaskStartScheduler, so step from a separate driver thread.
+  TaskControl* caller = g_current_task;
+  if (caller && caller->scheduled)
+  {
+    fprintf(stderr, "vSimStep called from a scheduled thread, it would never return\n");
+    std::abort();
+  }
+
+  Scheduler& sched = Sched();
+  std::unique_lock<std::mutex> lock(sched.mutex);
+  sched.horizon = g_virtual_now.load() + microseconds;
+  Dispatch(sched);
+  sched.idle_cv.wait(lock, [&sched]() {
+    return sched.running == nullptr && sched.ready.empty() && g_virtual_now.load() >= sched.horizon;
+  });
+}
+
+uint64_t ullSimGetMicros(void)
+{
+  return NowMicros();
+}
+
+BaseType_t xSimIsVirtualTime(void)
+{
+  return g_virtual_time.load() ? pdTRUE : pdFALSE;
+}
+
 QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize)
 {
   auto* queue = new QueueControl();
   queue->capacity = length;
   queue->item_size = itemSize;
+  queue->storage.reset(new uint8_t[length * itemSize]);
+  queue->stats.capacity = length;
+  queue->stats.item_size = itemSize;
+
+  std::lock_guard<std::mutex> lock(g_queue_registry_mutex);
+  g_queues.push_back(queue);
   return queue;
 }
 
@@ -443,34 +1007,33 @@ BaseType_t xQueueSend(QueueHandle_t queueHandle, const void* item, TickType_t ti
   }
 
   std::unique_lock<std::mutex> lock(queue->mutex);
-  auto has_space = [queue]() { return queue->items.size() < queue->capacity; };
+  auto has_space = [queue]() { return queue->count < queue->capacity; };
 
   if (!has_space())
   {
     if (ticksToWait == 0)
     {
+      queue->stats.send_failures++;
       return pdFALSE;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      queue->cv.wait(lock, has_space);
-    }
-    else
-    {
-      queue->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), has_space);
-    }
+    queue->stats.send_blocks++;
+    WaitUntil(lock, queue->not_full, &queue->not_full, DeadlineAfter(ticksToWait), has_space);
   }
 
   if (!has_space())
   {
+    queue->stats.send_failures++;
     return pdFALSE;
   }
 
-  std::vector<uint8_t> payload(queue->item_size);
-  std::memcpy(payload.data(), item, queue->item_size);
-  queue->items.push_back(std::move(payload));
+  size_t tail = (queue->head + queue->count) % queue->capacity;
+  std::memcpy(queue->storage.get() + tail * queue->item_size, item, queue->item_size);
+  queue->count++;
+  queue->stats.sends++;
+  queue->stats.high_water_mark = std::max<UBaseType_t>(queue->stats.high_water_mark, queue->count);
   lock.unlock();
-  queue->cv.notify_all();
+  queue->not_empty.notify_one();
+  SimWake(&queue->not_empty);
   return pdTRUE;
 }
 
@@ -483,7 +1046,7 @@ BaseType_t xQueueReceive(QueueHandle_t queueHandle, void* buffer, TickType_t tic
   }
 
   std::unique_lock<std::mutex> lock(queue->mutex);
-  auto has_items = [queue]() { return !queue->items.empty(); };
+  auto has_items = [queue]() { return queue->count > 0; };
 
   if (!has_items())
   {
@@ -491,27 +1054,22 @@ BaseType_t xQueueReceive(QueueHandle_t queueHandle, void* buffer, TickType_t tic
     {
       return pdFALSE;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      queue->cv.wait(lock, has_items);
-    }
-    else
-    {
-      queue->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), has_items);
-    }
+    WaitUntil(lock, queue->not_empty, &queue->not_empty, DeadlineAfter(ticksToWait), has_items);
   }
 
   if (!has_items())
   {
+    queue->stats.receive_timeouts++;
     return pdFALSE;
   }
 
-  std::vector<uint8_t> payload = std::move(queue->items.front());
-  queue->items.pop_front();
+  std::memcpy(buffer, queue->storage.get() + queue->head * queue->item_size, queue->item_size);
+  queue->head = (queue->head + 1) % queue->capacity;
+  queue->count--;
+  queue->stats.receives++;
   lock.unlock();
-  queue->cv.notify_all();
-
-  std::memcpy(buffer, payload.data(), std::min(payload.size(), queue->item_size));
+  queue->not_full.notify_one();
+  SimWake(&queue->not_full);
   return pdTRUE;
 }
 
@@ -522,8 +1080,13 @@ BaseType_t xQueueReset(QueueHandle_t queueHandle)
   {
     return pdFALSE;
   }
-  std::lock_guard<std::mutex> lock(queue->mutex);
-  queue->items.clear();
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->head = 0;
+    queue->count = 0;
+  }
+  queue->not_full.notify_all();
+  SimWake(&queue->not_full);
   return pdTRUE;
 }
 
@@ -535,19 +1098,63 @@ UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queueHandle)
     return 0;
   }
   std::lock_guard<std::mutex> lock(queue->mutex);
-  if (queue->capacity < queue->items.size())
+  return static_cast<UBaseType_t>(queue->capacity - queue->count);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queueHandle)
+{
+  auto* queue = static_cast<QueueControl*>(queueHandle);
+  if (!queue)
   {
     return 0;
   }
-  return static_cast<UBaseType_t>(queue->capacity - queue->items.size());
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return static_cast<UBaseType_t>(queue->count);
 }
 
 void vQueueDelete(QueueHandle_t queueHandle)
 {
   auto* queue = static_cast<QueueControl*>(queueHandle);
+  if (!queue)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(g_queue_registry_mutex);
+    g_queues.erase(std::remove(g_queues.begin(), g_queues.end(), queue), g_queues.end());
+  }
   delete queue;
 }
 
+void vQueueAddToRegistry(QueueHandle_t queueHandle, const char* name)
+{
+  auto* queue = static_cast<QueueControl*>(queueHandle);
+  if (!queue)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->stats.name = name;
+}
+
+UBaseType_t uxQueueGetSimStats(SimQueueStats* stats, UBaseType_t maxCount)
+{
+  std::lock_guard<std::mutex> registryLock(g_queue_registry_mutex);
+  UBaseType_t count = 0;
+  for (QueueControl* queue : g_queues)
+  {
+    if (count == maxCount)
+    {
+      break;
+    }
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    stats[count] = queue->stats;
+    stats[count].waiting = queue->count;
+    count++;
+  }
+  return count;
+}
+
 SemaphoreHandle_t xSemaphoreCreateMutex(void)
 {
   auto* sem = new SemaphoreControl();
@@ -555,6 +1162,13 @@ SemaphoreHandle_t xSemaphoreCreateMutex(void)
   return sem;
 }
 
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  auto* sem = new SemaphoreControl();
+  sem->count = 0; // Created empty, Give caps it at one
+  return sem;
+}
+
 SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
 {
   auto* sem = new SemaphoreControl();
@@ -580,14 +1194,7 @@ BaseType_t xSemaphoreTake(SemaphoreHandle_t semHandle, TickType_t ticksToWait)
     {
       return pdFALSE;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      sem->cv.wait(lock, can_take);
-    }
-    else
-    {
-      sem->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), can_take);
-    }
+    WaitUntil(lock, sem->cv, sem, DeadlineAfter(ticksToWait), can_take);
   }
 
   if (!can_take())
@@ -615,6 +1222,7 @@ BaseType_t xSemaphoreGive(SemaphoreHandle_t semHandle)
     }
   }
   sem->cv.notify_all();
+  SimWake(sem);
   return pdTRUE;
 }
 
@@ -641,14 +1249,7 @@ BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t semHandle, TickType_t ticks
     {
       return pdFALSE;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      sem->cv.wait(lock, can_take);
-    }
-    else
-    {
-      sem->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), can_take);
-    }
+    WaitUntil(lock, sem->cv, sem, DeadlineAfter(ticksToWait), can_take);
   }
 
   if (!can_take())
@@ -690,6 +1291,7 @@ BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t semHandle)
     }
   }
   sem->cv.notify_all();
+  SimWake(sem);
   return pdTRUE;
 }
 
@@ -699,11 +1301,10 @@ void vSemaphoreDelete(SemaphoreHandle_t semHandle)
   delete sem;
 }
 
-TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, BaseType_t autoReload, void* timerId,
-                                 TimerCallbackFunction_t callback, StaticTimer_t* buffer)
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, BaseType_t autoReload, void* timerId,
+                           TimerCallbackFunction_t callback)
 {
   (void)name;
-  (void)buffer;
 
   auto* timer = new TimerControl();
   timer->period_ticks = period == 0 ? 1 : period;
@@ -713,40 +1314,68 @@ TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, BaseType_t
   return timer;
 }
 
-BaseType_t xTimerStart(TimerHandle_t timerHandle, TickType_t ticksToWait)
+TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, BaseType_t autoReload, void* timerId,
+                                 TimerCallbackFunction_t callback, StaticTimer_t* buffer)
+{
+  (void)buffer;
+  return xTimerCreate(name, period, autoReload, timerId, callback);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timerHandle, TickType_t ticksToWait)
 {
   (void)ticksToWait;
   auto* timer = static_cast<TimerControl*>(timerHandle);
-  if (!timer || !timer->callback)
+  if (!timer)
   {
     return pdFALSE;
   }
 
-  if (timer->active.exchange(true))
-  {
-    return pdTRUE;
-  }
+  TimerService& timers = Timers();
+  std::lock_guard<std::mutex> lock(timers.mutex);
+  timer->active = false;
 
-  timer->worker = std::thread([timer]() {
-    while (timer->active)
+  // The daemon reads every entry it pops, so none may point at the freed timer
+  std::vector<TimerDeadline> kept;
+  while (!timers.heap.empty())
+  {
+    if (timers.heap.top().timer != timer)
     {
-      std::this_thread::sleep_for(std::chrono::milliseconds(timer->period_ticks * portTICK_PERIOD_MS));
-      if (!timer->active)
-      {
-        break;
-      }
-      timer->callback(timer);
-      if (!timer->auto_reload)
-      {
-        timer->active = false;
-        break;
-      }
+      kept.push_back(timers.heap.top());
     }
-  });
-  timer->worker.detach();
+    timers.heap.pop();
+  }
+  for (const TimerDeadline& entry : kept)
+  {
+    timers.heap.push(entry);
+  }
+
+  if (timers.firing == timer)
+  {
+    timer->delete_pending = true;
+  }
+  else
+  {
+    delete timer;
+  }
   return pdTRUE;
 }
 
+BaseType_t xTimerStart(TimerHandle_t timerHandle, TickType_t ticksToWait)
+{
+  (void)ticksToWait;
+  auto* timer = static_cast<TimerControl*>(timerHandle);
+  if (!timer)
+  {
+    return pdFALSE;
+  }
+  return StartTimer(timer, static_cast<uint64_t>(timer->period_ticks) * portTICK_PERIOD_MS * 1000, false);
+}
+
+BaseType_t xSimTimerStartOnceUs(TimerHandle_t timerHandle, uint64_t microseconds)
+{
+  return StartTimer(static_cast<TimerControl*>(timerHandle), microseconds, true);
+}
+
 BaseType_t xTimerStop(TimerHandle_t timerHandle, TickType_t ticksToWait)
 {
   (void)ticksToWait;
@@ -755,10 +1384,18 @@ BaseType_t xTimerStop(TimerHandle_t timerHandle, TickType_t ticksToWait)
   {
     return pdFALSE;
   }
+  std::lock_guard<std::mutex> lock(Timers().mutex);
   timer->active = false;
+  timer->generation++;
   return pdTRUE;
 }
 
+TaskHandle_t xTimerGetTimerDaemonTaskHandle(void)
+{
+  std::lock_guard<std::mutex> lock(Timers().mutex);
+  return Timers().daemon;
+}
+
 void* pvTimerGetTimerID(TimerHandle_t timerHandle)
 {
   auto* timer = static_cast<TimerControl*>(timerHandle);
@@ -785,16 +1422,19 @@ size_t xMessageBufferSendFromISR(MessageBufferHandle_t bufferHandle, const void*
     return 0;
   }
 
-  std::lock_guard<std::mutex> lock(buffer->mutex);
-  if (size > buffer->capacity || buffer->used + size > buffer->capacity)
   {
-    return 0;
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    if (size > buffer->capacity || buffer->used + size > buffer->capacity)
+    {
+      return 0;
+    }
+    std::vector<uint8_t> payload(size);
+    std::memcpy(payload.data(), data, size);
+    buffer->messages.push_back(std::move(payload));
+    buffer->used += size;
+    buffer->cv.notify_all();
   }
-  std::vector<uint8_t> payload(size);
-  std::memcpy(payload.data(), data, size);
-  buffer->messages.push_back(std::move(payload));
-  buffer->used += size;
-  buffer->cv.notify_all();
+  SimWake(buffer);
   return size;
 }
 
@@ -815,14 +1455,7 @@ size_t xMessageBufferReceive(MessageBufferHandle_t bufferHandle, void* outBuffer
     {
       return 0;
     }
-    if (ticksToWait == portMAX_DELAY)
-    {
-      buffer->cv.wait(lock, has_messages);
-    }
-    else
-    {
-      buffer->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait * portTICK_PERIOD_MS), has_messages);
-    }
+    WaitUntil(lock, buffer->cv, buffer, DeadlineAfter(ticksToWait), has_messages);
   }
 
   if (!has_messages())
@@ -853,3 +1486,19 @@ BaseType_t xMessageBufferReset(MessageBufferHandle_t bufferHandle)
 }
 
 }  // extern "C"
+
+namespace
+{
+  // MATRIXOS_SIM_VIRTUAL_TIME=1 runs the simulator on virtual time from the start, =step holds the clock for vSimStep
+  struct VirtualTimeFromEnvironment {
+    VirtualTimeFromEnvironment()
+    {
+      const char* mode = std::getenv("MATRIXOS_SIM_VIRTUAL_TIME");
+      if (mode == nullptr || mode[0] == '\0' || std::strcmp(mode, "0") == 0)
+      {
+        return;
+      }
+      vSimEnableVirtualTime(std::strcmp(mode, "step") == 0 ? pdTRUE : pdFALSE);
+    }
+  } g_virtual_time_from_environment;
+}
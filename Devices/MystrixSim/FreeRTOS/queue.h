@@ -6,12 +6,31 @@
 extern "C" {
 #endif
 
+// Simulator only, per queue counters for profiling on the host
+typedef struct SimQueueStats {
+  const char* name; // Set by vQueueAddToRegistry, nullptr otherwise
+  UBaseType_t capacity;
+  UBaseType_t item_size;
+  UBaseType_t waiting;
+  UBaseType_t high_water_mark;
+  uint32_t sends;
+  uint32_t receives;
+  uint32_t send_blocks;      // Sends that had to wait for space
+  uint32_t send_failures;    // Sends that gave up on a full queue
+  uint32_t receive_timeouts; // Receives that gave up on an empty queue
+} SimQueueStats;
+
 QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
 BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticksToWait);
 BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticksToWait);
 BaseType_t xQueueReset(QueueHandle_t queue);
 UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
 void vQueueDelete(QueueHandle_t queue);
+void vQueueAddToRegistry(QueueHandle_t queue, const char* name);
+
+// Copies the stats of up to maxCount live queues, returns how many were copied
+UBaseType_t uxQueueGetSimStats(SimQueueStats* stats, UBaseType_t maxCount);
 
 #ifdef __cplusplus
 }
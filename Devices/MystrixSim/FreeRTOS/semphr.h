@@ -7,6 +7,7 @@ extern "C" {
 #endif
 
 SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
 SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
 BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticksToWait);
 BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
@@ -26,6 +26,22 @@ uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
 void xTaskNotifyGive(TaskHandle_t task);
 void* pvTaskGetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index);
 void vTaskSetThreadLocalStoragePointer(TaskHandle_t task, BaseType_t index, void* value);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+#if (configGENERATE_RUN_TIME_STATS == 1)
+uint32_t ulTaskGetRunTimeCounter(TaskHandle_t task);
+uint32_t ulSimGetRunTimeCounterValue(void);
+#endif
+
+// Simulator only. Virtual time runs one task at a time and only moves the clock once every task is blocked, so runs
+// are fast and reproducible. Turn it on before any task is created (or set MATRIXOS_SIM_VIRTUAL_TIME=1, or =step).
+// Stepped mode holds the clock until vSimStep, which runs every task up to now + microseconds and returns once idle.
+// vSimStep must be called from a thread outside the schedule: not a task, and not the thread that called
+// vSimEnableVirtualTime while it has yet to reach vTaskStartScheduler. It aborts instead of deadlocking.
+void vSimEnableVirtualTime(BaseType_t stepped);
+void vSimStep(uint64_t microseconds);
+uint64_t ullSimGetMicros(void);
+BaseType_t xSimIsVirtualTime(void);
 
 #ifdef __cplusplus
 }
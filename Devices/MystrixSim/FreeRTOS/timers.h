@@ -8,11 +8,19 @@ extern "C" {
 
 typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
 
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, BaseType_t autoReload, void* timerId,
+                           TimerCallbackFunction_t callback);
 TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, BaseType_t autoReload, void* timerId,
                                  TimerCallbackFunction_t callback, StaticTimer_t* buffer);
 BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticksToWait);
 BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticksToWait);
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticksToWait);
 void* pvTimerGetTimerID(TimerHandle_t timer);
+TaskHandle_t xTimerGetTimerDaemonTaskHandle(void);
+
+// Simulator only. Starts the timer once after a delay in microseconds instead of its period, for device code that
+// needs finer than a tick. The timer is stopped after it fires even if it was created auto reloading.
+BaseType_t xSimTimerStartOnceUs(TimerHandle_t timer, uint64_t microseconds);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,609 @@
+#include "Headless.h"
+#include "../../Applications/Application.h"
+#include "System/System.h"
+#include "FileSystem/MassStorage.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+extern "C" {
+uint8_t* MatrixOS_Wasm_GetFrameBuffer(void);
+void MatrixOS_Wasm_KeyEvent(uint16_t x, uint16_t y, bool pressed);
+void MatrixOS_Wasm_FnEvent(bool pressed);
+void MatrixOS_Wasm_KeypadTick(void);
+void MatrixOS_Wasm_TouchBarEvent(uint8_t side, uint16_t index, bool pressed);
+void MatrixOS_Wasm_MidiSend(uint8_t status, uint8_t d0, uint8_t d1, uint8_t d2);
+void MatrixOS_Wasm_RawHidInject(uint8_t* data, uint32_t length);
+uint8_t MatrixOS_Wasm_SerialInjectRx(const char* data, uint32_t length);
+}
+
+namespace MystrixSim::Headless
+{
+namespace
+{
+constexpr uint32_t KEYPAD_TICK_MS = 10; // Hold detection cadence, the WebUI ticks the keypad at about the same rate
+constexpr uint32_t MSC_CHUNK_BYTES = 4096; // CFG_TUD_MSC_EP_BUFSIZE, what TinyUSB hands each READ10/WRITE10 callback
+
+enum class EventType : uint8_t { Key, Fn, Touch, Midi, Hid, Serial, Launch, Msc, ExpectApp, ExpectLed, End };
+
+struct Event {
+  uint32_t timeMs = 0;
+  EventType type = EventType::End;
+  uint16_t line = 0;
+  int16_t x = 0; // Key and LED position, touch bar side and index
+  int16_t y = 0;
+  bool pressed = false; // Also read or write for msc
+  uint32_t lba = 0;
+  uint32_t sectors = 0;
+  vector<uint8_t> bytes;
+  string text; // Serial text, app reference
+  uint32_t color = 0;
+};
+
+std::atomic<bool> active{false};
+std::mutex outputMutex;
+FILE* framesFile = nullptr;
+FILE* midiFile = nullptr;
+FILE* serialFile = nullptr;
+vector<Color> lastFrame;
+
+FILE* OpenOutput(const string& path) {
+  if (path.empty())
+  {
+    return nullptr;
+  }
+  if (path == "-")
+  {
+    return stdout;
+  }
+  return fopen(path.c_str(), "wb");
+}
+
+[[noreturn]] void Finish(ExitCode code) {
+  {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    active = false;
+    for (FILE* file : {framesFile, midiFile, serialFile})
+    {
+      if (file != nullptr && file != stdout)
+      {
+        fclose(file);
+      }
+    }
+    fflush(stdout);
+  }
+  // Tasks are still running, skip static destructors
+  std::_Exit(code);
+}
+
+bool SplitAppReference(const string& reference, string* author, string* name) {
+  size_t slash = reference.find('/');
+  if (slash == string::npos || slash == 0 || slash + 1 == reference.size())
+  {
+    return false;
+  }
+  *author = reference.substr(0, slash);
+  *name = reference.substr(slash + 1);
+  return true;
+}
+
+bool ParseState(const string& word, bool* pressed) {
+  if (word == "press")
+  {
+    *pressed = true;
+    return true;
+  }
+  if (word == "release")
+  {
+    *pressed = false;
+    return true;
+  }
+  return false;
+}
+
+bool ParseHexBytes(std::istringstream& stream, vector<uint8_t>* bytes) {
+  string word;
+  while (stream >> word)
+  {
+    char* end = nullptr;
+    unsigned long value = strtoul(word.c_str(), &end, 16);
+    if (*end != '\0' || value > 0xFF)
+    {
+      return false;
+    }
+    bytes->push_back((uint8_t)value);
+  }
+  return !bytes->empty();
+}
+
+// Returns an empty string on success, otherwise what was wrong with the line
+string ParseEvent(const string& line, Event* event) {
+  std::istringstream stream(line);
+  string command;
+  if (!(stream >> event->timeMs >> command))
+  {
+    return "expected <ms> <command>";
+  }
+
+  string word;
+  if (command == "key")
+  {
+    event->type = EventType::Key;
+    if (!(stream >> event->x >> event->y >> word) || !ParseState(word, &event->pressed) || event->x < 0 ||
+        event->x >= X_SIZE || event->y < 0 || event->y >= Y_SIZE)
+    {
+      return "expected key <x> <y> press|release";
+    }
+  }
+  else if (command == "fn")
+  {
+    event->type = EventType::Fn;
+    if (!(stream >> word) || !ParseState(word, &event->pressed))
+    {
+      return "expected fn press|release";
+    }
+  }
+  else if (command == "touch")
+  {
+    event->type = EventType::Touch;
+    string side;
+    if (!(stream >> side >> event->y >> word) || (side != "left" && side != "right") || !ParseState(word, &event->pressed) ||
+        event->y < 0 || event->y >= TOUCHBAR_SIZE)
+    {
+      return "expected touch left|right <index> press|release";
+    }
+    event->x = side == "left" ? 0 : 1;
+  }
+  else if (command == "midi")
+  {
+    event->type = EventType::Midi;
+    if (!ParseHexBytes(stream, &event->bytes) || event->bytes.size() > 4)
+    {
+      return "expected midi <status> [data...], up to three hex data bytes";
+    }
+  }
+  else if (command == "hid")
+  {
+    event->type = EventType::Hid;
+    if (!ParseHexBytes(stream, &event->bytes) || event->bytes.size() > 63)
+    {
+      return "expected hid <byte> [byte...], up to 63 hex bytes";
+    }
+  }
+  else if (command == "serial")
+  {
+    event->type = EventType::Serial;
+    std::getline(stream >> std::ws, event->text);
+    event->text += "\n";
+  }
+  else if (command == "launch" || command == "expect-app")
+  {
+    event->type = command == "launch" ? EventType::Launch : EventType::ExpectApp;
+    string author, name;
+    std::getline(stream >> std::ws, event->text);
+    if (!SplitAppReference(event->text, &author, &name))
+    {
+      return "expected " + command + " <author>/<name>";
+    }
+  }
+  else if (command == "msc")
+  {
+    event->type = EventType::Msc;
+    if (!(stream >> word >> event->lba >> event->sectors) || (word != "read" && word != "write") || event->sectors == 0)
+    {
+      return "expected msc read|write <lba> <sectors>";
+    }
+    event->pressed = word == "write";
+  }
+  else if (command == "expect-led")
+  {
+    event->type = EventType::ExpectLed;
+    if (!(stream >> event->x >> event->y >> std::hex >> event->color) || event->color > 0xFFFFFF)
+    {
+      return "expected expect-led <x> <y> <rrggbb>";
+    }
+  }
+  else if (command == "end")
+  {
+    event->type = EventType::End;
+  }
+  else
+  {
+    return "unknown command '" + command + "'";
+  }
+  return "";
+}
+
+bool LoadScript(const string& path, vector<Event>* events) {
+  std::ifstream file;
+  std::istream* input = &std::cin;
+  if (path != "-")
+  {
+    file.open(path);
+    if (!file)
+    {
+      fprintf(stderr, "%s: could not open script\n", path.c_str());
+      Finish(EXIT_IO_ERROR);
+    }
+    input = &file;
+  }
+
+  string line;
+  uint16_t lineNumber = 0;
+  while (std::getline(*input, line))
+  {
+    lineNumber++;
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == string::npos || line[start] == '#')
+    {
+      continue;
+    }
+    if (line.back() == '\r')
+    {
+      line.pop_back();
+    }
+
+    Event event;
+    event.line = lineNumber;
+    string error = ParseEvent(line.substr(start), &event);
+    if (error.empty() && !events->empty() && event.timeMs < events->back().timeMs)
+    {
+      error = "time goes backwards";
+    }
+    if (!error.empty())
+    {
+      fprintf(stderr, "%s:%u: %s\n", path.c_str(), lineNumber, error.c_str());
+      return false;
+    }
+    events->push_back(event);
+  }
+  return true;
+}
+
+// Lets every task run until it blocks, so the next event sees a settled system
+void Settle(bool virtualTime) {
+  if (virtualTime)
+  {
+    vSimStep(0);
+  }
+}
+
+void AdvanceTo(uint32_t timeMs, bool virtualTime) {
+  for (uint32_t now = MatrixOS::SYS::Millis(); now < timeMs; now = MatrixOS::SYS::Millis())
+  {
+    uint32_t step = std::min(KEYPAD_TICK_MS, timeMs - now);
+    if (virtualTime)
+    {
+      vSimStep((uint64_t)step * 1000);
+    }
+    else
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(step));
+    }
+    MatrixOS_Wasm_KeypadTick();
+    Settle(virtualTime);
+  }
+}
+
+bool Launch(const string& reference) {
+  string author, name;
+  SplitAppReference(reference, &author, &name);
+  if (GetApplications().find(MatrixOS::SYS::GenerateAPPID(author, name)) == GetApplications().end())
+  {
+    fprintf(stderr, "App '%s' is not registered\n", reference.c_str());
+    return false;
+  }
+  MatrixOS::SYS::ExecuteAPP(author, name);
+  return true;
+}
+
+// Streams sectors through the mass storage engine the way TinyUSB does for a host, timed on the wall clock
+void MscTransfer(void* param) {
+  namespace MassStorage = MatrixOS::FileSystem::MassStorage;
+  const Event* event = static_cast<const Event*>(param);
+  vector<uint8_t> chunk(MSC_CHUNK_BYTES);
+  const uint32_t chunkSectors = MSC_CHUNK_BYTES / 512;
+  MatrixOS::FileSystem::MassStorageStats before = MatrixOS::FileSystem::GetMassStorageStats();
+  auto start = std::chrono::steady_clock::now();
+
+  bool success = true;
+  for (uint32_t done = 0; done < event->sectors && success;)
+  {
+    uint32_t count = std::min(chunkSectors, event->sectors - done);
+    if (event->pressed)
+    {
+      memset(chunk.data(), (uint8_t)(event->lba + done), chunk.size());
+      success = MassStorage::Write(event->lba + done, chunk.data(), count * 512) >= 0;
+    }
+    else
+    {
+      success = MassStorage::Read(event->lba + done, chunk.data(), count * 512) >= 0;
+    }
+    done += count;
+  }
+  if (event->pressed)
+  {
+    MassStorage::WriteComplete();
+    success &= MassStorage::Flush();
+  }
+
+  uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  MatrixOS::FileSystem::MassStorageStats after = MatrixOS::FileSystem::GetMassStorageStats();
+  {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    printf("MSC %s lba=%u sectors=%u %s us=%llu kBps=%llu readahead=%u misses=%u storage_writes=%u wait_us=%llu\n",
+           event->pressed ? "write" : "read", event->lba, event->sectors, success ? "ok" : "failed", (unsigned long long)elapsedUs,
+           (unsigned long long)(elapsedUs ? (uint64_t)event->sectors * 512 * 1000 / elapsedUs : 0),
+           after.readaheadHits - before.readaheadHits, after.readMisses - before.readMisses, after.storageWrites - before.storageWrites,
+           (unsigned long long)(after.waitUs - before.waitUs));
+  }
+  vTaskDelete(NULL);
+}
+
+bool Expect(const Event& event) {
+  if (event.type == EventType::ExpectApp)
+  {
+    const Application_Info* info = MatrixOS::SYS::activeAppInfo;
+    string running = info != nullptr ? info->author + "/" + info->name : "(none)";
+    if (running != event.text)
+    {
+      fprintf(stderr, "line %u: expected app %s, running %s\n", event.line, event.text.c_str(), running.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  uint16_t index = Device::LED::XY2Index(Point(event.x, event.y));
+  if (index == UINT16_MAX)
+  {
+    fprintf(stderr, "line %u: no LED at %d, %d\n", event.line, event.x, event.y);
+    return false;
+  }
+  const Color* frame = reinterpret_cast<const Color*>(MatrixOS_Wasm_GetFrameBuffer());
+  uint32_t color = ((uint32_t)frame[index].R << 16) | ((uint32_t)frame[index].G << 8) | frame[index].B;
+  if (color != event.color)
+  {
+    fprintf(stderr, "line %u: expected LED %d, %d to be %06X, was %06X\n", event.line, event.x, event.y,
+            (unsigned)event.color, (unsigned)color);
+    return false;
+  }
+  return true;
+}
+
+void Apply(Event& event) {
+  switch (event.type)
+  {
+  case EventType::Key:
+    MatrixOS_Wasm_KeyEvent(event.x, event.y, event.pressed);
+    break;
+  case EventType::Fn:
+    MatrixOS_Wasm_FnEvent(event.pressed);
+    break;
+  case EventType::Touch:
+    MatrixOS_Wasm_TouchBarEvent(event.x, event.y, event.pressed);
+    break;
+  case EventType::Midi:
+    event.bytes.resize(4, 0);
+    MatrixOS_Wasm_MidiSend(event.bytes[0], event.bytes[1], event.bytes[2], event.bytes[3]);
+    break;
+  case EventType::Hid:
+    MatrixOS_Wasm_RawHidInject(event.bytes.data(), event.bytes.size());
+    break;
+  case EventType::Serial:
+    MatrixOS_Wasm_SerialInjectRx(event.text.data(), event.text.size());
+    break;
+  case EventType::Launch:
+    if (!Launch(event.text))
+    {
+      Finish(EXIT_APP_NOT_FOUND);
+    }
+    break;
+  case EventType::Msc:
+    xTaskCreate(MscTransfer, "headless_msc", configMINIMAL_STACK_SIZE * 4, &event, 1, NULL);
+    break;
+  case EventType::ExpectApp:
+  case EventType::ExpectLed:
+    if (!Expect(event))
+    {
+      Finish(EXIT_EXPECT_FAILED);
+    }
+    break;
+  case EventType::End:
+    Finish(EXIT_OK);
+  }
+}
+
+void Drive(vector<Event> events, Options options, std::shared_future<void> booted) {
+  // Virtual time holds the first step until main hands off in vTaskStartScheduler, the wall clock needs to wait
+  if (!options.virtualTime)
+  {
+    booted.wait();
+  }
+  Settle(options.virtualTime); // Boot until every task is waiting
+  if (!options.app.empty() && !Launch(options.app))
+  {
+    Finish(EXIT_APP_NOT_FOUND);
+  }
+  Settle(options.virtualTime);
+
+  uint32_t lastMs = 0;
+  for (Event& event : events)
+  {
+    AdvanceTo(event.timeMs, options.virtualTime);
+    Apply(event);
+    Settle(options.virtualTime);
+    lastMs = event.timeMs;
+  }
+  AdvanceTo(lastMs + options.durationMs, options.virtualTime);
+  Finish(EXIT_OK);
+}
+} // namespace
+
+void PrintUsage(const char* program) {
+  fprintf(stderr,
+          "Usage: %s [options]\n"
+          "  --script <file>      Input script, - for stdin\n"
+          "  --app <author/name>  App to launch once booted\n"
+          "  --duration <ms>      Keep running this long after the last event\n"
+          "  --frames <file>      Write LED frames, - for stdout\n"
+          "  --midi <file>        Write MIDI output\n"
+          "  --serial <file>      Write CDC output\n"
+          "  --realtime           Run on the wall clock instead of virtual time\n",
+          program);
+}
+
+bool ParseArguments(int argc, char* argv[], Options* options) {
+  for (int i = 1; i < argc; i++)
+  {
+    string argument = argv[i];
+    if (argument == "--realtime")
+    {
+      options->virtualTime = false;
+      continue;
+    }
+    if (i + 1 >= argc)
+    {
+      return false;
+    }
+
+    string value = argv[++i];
+    if (argument == "--script")
+    {
+      options->scriptPath = value;
+    }
+    else if (argument == "--app")
+    {
+      string author, name;
+      if (!SplitAppReference(value, &author, &name))
+      {
+        return false;
+      }
+      options->app = value;
+    }
+    else if (argument == "--duration")
+    {
+      char* end = nullptr;
+      options->durationMs = strtoul(value.c_str(), &end, 10);
+      if (*end != '\0')
+      {
+        return false;
+      }
+    }
+    else if (argument == "--frames")
+    {
+      options->framesPath = value;
+    }
+    else if (argument == "--midi")
+    {
+      options->midiPath = value;
+    }
+    else if (argument == "--serial")
+    {
+      options->serialPath = value;
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Run(const Options& options) {
+  setvbuf(stdout, nullptr, _IOLBF, 0); // Keep logs in order with the outputs when piped
+  vector<Event> events;
+  if (!options.scriptPath.empty() && !LoadScript(options.scriptPath, &events))
+  {
+    Finish(EXIT_SCRIPT_ERROR);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    framesFile = OpenOutput(options.framesPath);
+    midiFile = OpenOutput(options.midiPath);
+    serialFile = OpenOutput(options.serialPath);
+    if ((!options.framesPath.empty() && framesFile == nullptr) || (!options.midiPath.empty() && midiFile == nullptr) ||
+        (!options.serialPath.empty() && serialFile == nullptr))
+    {
+      fprintf(stderr, "Could not open an output file\n");
+      Finish(EXIT_IO_ERROR);
+    }
+    active = true;
+  }
+
+  if (options.virtualTime)
+  {
+    vSimEnableVirtualTime(pdTRUE);
+  }
+
+  std::promise<void> booted;
+  std::thread(Drive, std::move(events), options, booted.get_future().share()).detach();
+
+  MatrixOS::SYS::Begin();
+  booted.set_value();
+  vTaskStartScheduler();
+  Finish(EXIT_SYSTEM_ERROR); // The scheduler never returns
+}
+
+void TapFrame(const Color* frame, uint16_t count) {
+  if (!active)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(outputMutex);
+  if (framesFile == nullptr || (lastFrame.size() == count && memcmp(lastFrame.data(), frame, count * sizeof(Color)) == 0))
+  {
+    return;
+  }
+  lastFrame.assign(frame, frame + count);
+
+  fprintf(framesFile, "%u", (uint32_t)MatrixOS::SYS::Millis());
+  for (uint16_t i = 0; i < count; i++)
+  {
+    fprintf(framesFile, " %02x%02x%02x", frame[i].R, frame[i].G, frame[i].B);
+  }
+  fputc('\n', framesFile);
+}
+
+void TapMidi(uint16_t srcPort, uint16_t dstPort, const MidiPacket& packet) {
+  if (!active)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(outputMutex);
+  if (midiFile != nullptr)
+  {
+    fprintf(midiFile, "%u %u %u %02x %02x %02x %02x\n", (uint32_t)MatrixOS::SYS::Millis(), srcPort, dstPort, (uint8_t)packet.status,
+            packet.data[0], packet.data[1], packet.data[2]);
+  }
+}
+
+void TapSerial(const string& text) {
+  if (!active)
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(outputMutex);
+  if (serialFile != nullptr)
+  {
+    fwrite(text.data(), 1, text.size(), serialFile);
+  }
+}
+
+void SystemError() {
+  if (active)
+  {
+    fprintf(stderr, "MatrixOS hit ErrorHandler at %u ms\n", (uint32_t)MatrixOS::SYS::Millis());
+    Finish(EXIT_SYSTEM_ERROR);
+  }
+}
+} // namespace MystrixSim::Headless
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+// Native runner for MystrixSim. Replays a timestamped input script against the simulator on virtual time and records
+// what the device sends out, so app hot paths can be profiled and regression tested without a browser.
+//
+// Script, one event per line, blank lines and # comments skipped. Time is in ms since boot and must not go backwards:
+//   <ms> key <x> <y> press|release
+//   <ms> fn press|release
+//   <ms> touch left|right <index> press|release
+//   <ms> midi <status> [data...]          hex bytes, arrives from the USB MIDI port
+//   <ms> hid <byte> [byte...]             hex bytes, one RawHID report
+//   <ms> serial <text>                    rest of the line plus a newline, arrives on CDC
+//   <ms> launch <author>/<name>
+//   <ms> msc read|write <lba> <sectors>   streams sectors through the USB mass storage engine, prints the timing
+//   <ms> expect-app <author>/<name>
+//   <ms> expect-led <x> <y> <rrggbb>
+//   <ms> end
+//
+// Outputs: frames are one line per changed frame ("<ms> rrggbb rrggbb ..." in LED index order), MIDI is one line per
+// packet sent ("<ms> <from port> <to port> <status> <data0> <data1> <data2>"), serial is the raw CDC output.
+// msc lines go to stdout, timed on the wall clock. Writes put a test pattern over the storage image.
+namespace MystrixSim::Headless
+{
+enum ExitCode : int {
+  EXIT_OK = 0,
+  EXIT_USAGE = 1,         // Bad command line
+  EXIT_SCRIPT_ERROR = 2,  // Script could not be parsed
+  EXIT_IO_ERROR = 3,      // Script or an output could not be opened
+  EXIT_APP_NOT_FOUND = 4, // Launch named an app that isn't registered
+  EXIT_SYSTEM_ERROR = 5,  // MatrixOS hit ErrorHandler
+  EXIT_EXPECT_FAILED = 6, // An expect line didn't hold
+};
+
+struct Options {
+  string scriptPath; // "-" reads stdin, empty runs without input
+  string app;        // <author>/<name> to launch once booted
+  string framesPath; // Outputs, "-" writes to stdout
+  string midiPath;
+  string serialPath;
+  uint32_t durationMs = 0; // Keep running this long after the last event
+  bool virtualTime = true;
+};
+
+bool ParseArguments(int argc, char* argv[], Options* options);
+void PrintUsage(const char* program);
+
+// Boots MatrixOS and drives it from the script, exits the process with an ExitCode when done
+[[noreturn]] void Run(const Options& options);
+
+// Taps from the device layer, no-ops unless the runner is active
+void TapFrame(const Color* frame, uint16_t count);
+void TapMidi(uint16_t srcPort, uint16_t dstPort, const MidiPacket& packet);
+void TapSerial(const string& text);
+void SystemError();
+} // namespace MystrixSim::Headless
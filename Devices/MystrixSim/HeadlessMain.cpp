@@ -0,0 +1,12 @@
+// Native entry point for MystrixSim, replaces OS/main.cpp in the MatrixOSHeadless runner.
+#include "Headless.h"
+
+int main(int argc, char* argv[]) {
+  MystrixSim::Headless::Options options;
+  if (!MystrixSim::Headless::ParseArguments(argc, argv, &options))
+  {
+    MystrixSim::Headless::PrintUsage(argv[0]);
+    return MystrixSim::Headless::EXIT_USAGE;
+  }
+  MystrixSim::Headless::Run(options);
+}
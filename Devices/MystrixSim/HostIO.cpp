@@ -1,4 +1,5 @@
 #include "HostIO.h"
+#include "Headless.h"
 
 #include "USB/USB.h"
 #include "message_buffer.h"
@@ -542,8 +543,10 @@ void TapSerial(int direction, const string& text) {
     }, direction, tapStr);
   }
 #else
-  (void)direction;
-  (void)text;
+  if (direction == 1)
+  {
+    Headless::TapSerial(text);
+  }
 #endif
 }
 
@@ -555,10 +558,10 @@ void TapMidi(int direction, uint16_t srcPort, uint16_t dstPort, const MidiPacket
   }, direction, (int)srcPort, (int)dstPort, (int)(uint8_t)midiPacket.status,
      (int)midiPacket.data[0], (int)midiPacket.data[1], (int)midiPacket.data[2]);
 #else
-  (void)direction;
-  (void)srcPort;
-  (void)dstPort;
-  (void)midiPacket;
+  if (direction == 1)
+  {
+    Headless::TapMidi(srcPort, dstPort, midiPacket);
+  }
 #endif
 }
 
@@ -609,7 +612,18 @@ uint32_t Available() {
 
 void Poll() {}
 
+// Output goes straight to the host, there is no ring to fill
+static TxStats txStats;
+
 void Print(string str) {
+  if (str.empty())
+  {
+    return;
+  }
+
+  txStats.bytesQueued += str.length();
+  txStats.bytesSent += str.length();
+  txStats.transfers++;
   MystrixSim::HostIO::TapSerial(1, str);
 }
 
@@ -646,6 +660,14 @@ void VPrintf(string format, va_list valst) {
 
 void Flush() {}
 
+void SetTxOverflowPolicy(TxOverflowPolicy policy) {
+  (void)policy;
+}
+
+TxStats GetTxStats() {
+  return txStats;
+}
+
 int8_t Read() {
   if (!Connected())
   {
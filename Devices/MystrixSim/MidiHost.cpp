@@ -6,6 +6,7 @@
 #include "Framework/Midi/MidiPort.h"
 
 #include "System/System.h"
+#include "System/Telemetry.h"
 
 namespace MatrixOS::MIDI
 {
@@ -14,7 +15,7 @@ static constexpr size_t MATRIXOS_SYSEX_REPLY_OVERHEAD = 3;
 static constexpr uint32_t SYSEX_INACTIVITY_TIMEOUT_MS = 1000;
 static uint32_t droppedAppMidiPackets = 0;
 static uint32_t droppedOversizedSysExMessages = 0;
-static uint32_t timedOutSysExSessions = 0;
+static uint32_t appQueueHighWaterMark = 0;
 
 static bool SendCommandSysExReply(const vector<uint8_t>& reply, bool end, void* context) {
   (void)end;
@@ -56,21 +57,8 @@ static void LogDroppedOversizedSysEx() {
   }
 }
 
-static void LogTimedOutSysExSession() {
-  timedOutSysExSessions++;
-  if (timedOutSysExSessions == 1 || (timedOutSysExSessions % 8) == 0)
-  {
-    MLOGW("MIDI", "Dropped timed out SysEx session(s): %lu", timedOutSysExSessions);
-  }
-}
-
-static void ResetActiveSysExSession(vector<uint8_t>& sysExBuffer, uint16_t& activeSysExPort, SysExState& currentSysExState,
-                                    uint32_t& lastSysExActivityMs) {
-  sysExBuffer.clear();
-  activeSysExPort = MIDI_PORT_INVALID;
-  currentSysExState = SysExState::SYSEX_IDLE;
-  lastSysExActivityMs = 0;
-}
+static bool UniversalSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
+static bool MatrixOSSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
 
 void Init(void) {
   if (!osPort)
@@ -81,11 +69,24 @@ void Init(void) {
   if (!appQueue)
   {
     appQueue = xQueueCreate(MIDI_QUEUE_SIZE, sizeof(MidiPacket));
+    vQueueAddToRegistry(appQueue, "MIDI App");
+  }
+
+  if (!sysExAssembler)
+  {
+    sysExAssembler = new SysExAssembler(SYSEX_INACTIVITY_TIMEOUT_MS);
+    const uint8_t universalPrefix[] = {MIDIv1_SYSEX_START, MIDIv1_UNIVERSAL_NON_REALTIME_ID};
+    const uint8_t commandPrefix[] = {MIDIv1_SYSEX_START, MATRIXOS_SYSEX_REQUEST};
+    const uint8_t appPrefix[] = {MIDIv1_SYSEX_START, SYSEX_MFG_ID[0], SYSEX_MFG_ID[1], SYSEX_MFG_ID[2], SYSEX_FAMILY_ID[0], SYSEX_FAMILY_ID[1]};
+    sysExAssembler->AddHandler(universalPrefix, sizeof(universalPrefix), UniversalSysExHandler, nullptr, true);
+    sysExAssembler->AddHandler(commandPrefix, sizeof(commandPrefix), MatrixOSSysExHandler, nullptr, true);
+    sysExAssembler->AddHandler(appPrefix, sizeof(appPrefix), nullptr, nullptr, true); // Application SysEx, passed to the app after the header
   }
 
   if (!receiveTask && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
   {
     xTaskCreate(ReceiveTask, "MIDI_Receive", 2048, NULL, tskIDLE_PRIORITY + 2, &receiveTask);
+    Telemetry::WatchTask(receiveTask, "MIDI_Receive");
   }
 }
 
@@ -106,96 +107,70 @@ bool Send(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeoutMs) {
   return result;
 }
 
-void ReceiveTask(void* parameters) {
-  static vector<uint8_t> sysExBuffer;
-  static uint16_t activeSysExPort = MIDI_PORT_INVALID;
-  static SysExState currentSysExState = SysExState::SYSEX_IDLE;
-  static uint32_t lastSysExActivityMs = 0;
-
-  MidiPacket packet;
-
-  while (true)
+bool SendBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t targetPort, uint16_t timeoutMs) {
+  if (!osPort)
+    return false;
+  bool result = osPort->SendBatch(midiPackets, count, targetPort, timeoutMs);
+  if (result)
   {
-    if (osPort && osPort->Get(&packet, portMAX_DELAY))
+    for (uint16_t i = 0; i < count; i++)
     {
-      bool shouldForwardToApp = true;
-      uint32_t nowMs = SYS::Millis();
-
-      if (activeSysExPort != MIDI_PORT_INVALID && (uint32_t)(nowMs - lastSysExActivityMs) > SYSEX_INACTIVITY_TIMEOUT_MS)
-      {
-        ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-        LogTimedOutSysExSession();
-      }
-
-      if (packet.SysEx())
-      {
-        if (packet.SysExStart())
-        {
-          if (activeSysExPort != MIDI_PORT_INVALID && packet.port != activeSysExPort)
-          {
-            continue;
-          }
+      MidiPacket midiPacket = midiPackets[i];
+      midiPacket.port = osPort->id;
+      MystrixSim::HostIO::TapMidi(1, midiPacket.port, targetPort, midiPacket);
+    }
+  }
+  return result;
+}
 
-          sysExBuffer.reserve(12);
-          sysExBuffer.clear();
-          activeSysExPort = packet.port;
-          currentSysExState = SysExState::SYSEX_PENDING;
-          lastSysExActivityMs = nowMs;
-        }
-        else
-        {
-          if (activeSysExPort != packet.port)
-          {
-            continue;
-          }
+bool AddSysExHandler(const uint8_t* prefix, uint8_t prefixLength, SysExHandler handler, void* context) {
+  if (!sysExAssembler || handler == nullptr)
+    return false;
+  return sysExAssembler->AddHandler(prefix, prefixLength, handler, context);
+}
 
-          lastSysExActivityMs = nowMs;
+void RemoveSysExHandler(SysExHandler handler, void* context) {
+  if (sysExAssembler)
+    sysExAssembler->RemoveHandler(handler, context);
+}
 
-          if (currentSysExState == SysExState::SYSEX_INVALID)
-          {
-            if (packet.status == SysExEnd)
-            {
-              ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-            }
-            continue;
-          }
-        }
+void RemoveAppSysExHandlers() {
+  if (sysExAssembler)
+    sysExAssembler->RemoveAppHandlers();
+}
 
-        if (currentSysExState != SysExState::SYSEX_RELEASE)
-        {
-          uint8_t packetLength = packet.Length();
-          if (sysExBuffer.size() + packetLength > MAX_SYSTEM_SYSEX_SIZE)
-          {
-            sysExBuffer.clear();
-            LogDroppedOversizedSysEx();
-            if (packet.status == SysExEnd)
-            {
-              ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-            }
-            else
-            {
-              currentSysExState = SysExState::SYSEX_INVALID;
-            }
-            continue;
-          }
+SysExStats GetSysExStats() {
+  if (!sysExAssembler)
+    return SysExStats();
+  return sysExAssembler->GetStats();
+}
 
-          sysExBuffer.insert(sysExBuffer.end(), packet.data, packet.data + packetLength);
-          currentSysExState = ProcessSysEx(packet.port, sysExBuffer, packet.status == SysExEnd);
+MidiQueueStats GetQueueStats() {
+  MidiQueueStats stats;
+  stats.capacity = MIDI_QUEUE_SIZE;
+  stats.pending = appQueue ? uxQueueMessagesWaiting(appQueue) : 0;
+  stats.highWaterMark = appQueueHighWaterMark;
+  stats.droppedPackets = droppedAppMidiPackets;
+  stats.droppedOversizedSysEx = droppedOversizedSysExMessages;
+  return stats;
+}
 
-          if (packet.status == SysExEnd)
-          {
-            ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-          }
-          shouldForwardToApp = false;
-        }
-      }
+void ReceiveTask(void* parameters) {
+  MidiPacket packet;
 
-      if (packet.status == SysExEnd && packet.port == activeSysExPort)
+  while (true)
+  {
+    // Blocking get from OS port
+    if (osPort && osPort->Get(&packet, portMAX_DELAY))
+    {
+      // SysEx is reassembled per port and streamed to its handler, only application SysEx is passed on packet by packet
+      if (packet.SysEx() && sysExAssembler->Receive(packet, SYS::Millis()) == SysExAssembler::SYSEX_CONSUMED)
       {
-        ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
+        continue;
       }
 
-      if (shouldForwardToApp && appQueue)
+      // Forward to application queue
+      if (appQueue)
       {
         if (xQueueSend(appQueue, &packet, 0) != pdTRUE)
         {
@@ -203,7 +178,13 @@ void ReceiveTask(void* parameters) {
         }
         else
         {
+          UBaseType_t pending = uxQueueMessagesWaiting(appQueue);
+          if (pending > appQueueHighWaterMark)
+          {
+            appQueueHighWaterMark = pending;
+          }
           MystrixSim::HostIO::TapMidi(0, packet.port, 0, packet);
+          SYS::WakeApp();
         }
       }
     }
@@ -270,81 +251,68 @@ bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta)
   return true;
 }
 
-SysExState ProcessSysEx(uint16_t port, vector<uint8_t>& sysExBuffer, bool complete) {
-  if (sysExBuffer.empty())
-  {
-    return SysExState::SYSEX_INVALID;
-  }
-
-  if (sysExBuffer[0] != MIDIv1_SYSEX_START)
+static bool UniversalSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context) {
+  (void)context;
+  if (flags != (SYSEX_CHUNK_START | SYSEX_CHUNK_END)) // Only short whole messages are of interest
   {
-    return SysExState::SYSEX_INVALID;
+    return false;
   }
 
-  if (complete)
+  if (length >= 5 && data[3] == USYSEX_GENERAL_INFO && data[4] == USYSEX_GI_ID_REQUEST) // General Info - Identity Request
   {
-    if (sysExBuffer.size() < 2)
-    {
-      return SysExState::SYSEX_INVALID;
-    }
-
-    if (sysExBuffer[1] == MIDIv1_UNIVERSAL_NON_REALTIME_ID)
-    {
-      if (sysExBuffer.size() >= 5 && sysExBuffer[3] == USYSEX_GENERAL_INFO && sysExBuffer[4] == USYSEX_GI_ID_REQUEST)
-      {
 #if MATRIXOS_BUILD_VER == 0
-        uint8_t osReleaseVersion = 0;
+    uint8_t osReleaseVersion = 0;
 #elif (MATRIXOS_BUILD_VER == 4)
-        uint8_t osReleaseVersion = 0x31;
+    uint8_t osReleaseVersion = 0x31;
 #elif (MATRIXOS_RELEASE_VER < 32)
-        uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + MATRIXOS_RELEASE_VER;
+    uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + MATRIXOS_RELEASE_VER;
 #else
-        uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + 0x1F;
+    uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + 0x1F;
 #endif
 
-        uint8_t reply[] = {MIDIv1_SYSEX_START,    MIDIv1_UNIVERSAL_NON_REALTIME_ID,
-                           USYSEX_ALL_CHANNELS,   USYSEX_GENERAL_INFO,
-                           USYSEX_GI_ID_RESPONSE, SYSEX_MFG_ID[0],
-                           SYSEX_MFG_ID[1],       SYSEX_MFG_ID[2],
-                           SYSEX_FAMILY_ID[0],    SYSEX_FAMILY_ID[1],
-                           SYSEX_MODEL_ID[0],     SYSEX_MODEL_ID[1],
-                           MATRIXOS_MAJOR_VER,    MATRIXOS_MINOR_VER,
-                           MATRIXOS_PATCH_VER,    osReleaseVersion,
-                           MIDIv1_SYSEX_END};
-
-        SendSysEx(port, sizeof(reply), reply, false);
-      }
-    }
-    else if (sysExBuffer[1] == MATRIXOS_SYSEX_REQUEST)
-    {
-      if (sysExBuffer.size() >= 3)
-      {
-        HandleMatrixOSSysEx(port, sysExBuffer);
-      }
-    }
-    return SysExState::SYSEX_COMPLETE;
+    uint8_t reply[] = {MIDIv1_SYSEX_START,    MIDIv1_UNIVERSAL_NON_REALTIME_ID,
+                       USYSEX_ALL_CHANNELS,   USYSEX_GENERAL_INFO,
+                       USYSEX_GI_ID_RESPONSE, SYSEX_MFG_ID[0],
+                       SYSEX_MFG_ID[1],       SYSEX_MFG_ID[2],
+                       SYSEX_FAMILY_ID[0],    SYSEX_FAMILY_ID[1],
+                       SYSEX_MODEL_ID[0],     SYSEX_MODEL_ID[1],
+                       MATRIXOS_MAJOR_VER,    MATRIXOS_MINOR_VER,
+                       MATRIXOS_PATCH_VER,    osReleaseVersion,
+                       MIDIv1_SYSEX_END};
+
+    SendSysEx(port, sizeof(reply), reply, false);
   }
-  else if (sysExBuffer.size() >= 6 && sysExBuffer[1] == SYSEX_MFG_ID[0] && sysExBuffer[2] == SYSEX_MFG_ID[1] &&
-           sysExBuffer[3] == SYSEX_MFG_ID[2] && sysExBuffer[4] == SYSEX_FAMILY_ID[0] && sysExBuffer[5] == SYSEX_FAMILY_ID[1])
+  return true;
+}
+
+static bool MatrixOSSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context) {
+  (void)context;
+  if (flags != (SYSEX_CHUNK_START | SYSEX_CHUNK_END)) // Commands are handled whole
   {
-    return SysExState::SYSEX_RELEASE;
+    if (flags & SYSEX_CHUNK_START)
+    {
+      LogDroppedOversizedSysEx();
+    }
+    return false;
   }
-  return SysExState::SYSEX_PENDING;
+
+  HandleMatrixOSSysEx(port, data, length);
+  return true;
 }
 
-void HandleMatrixOSSysEx(uint16_t port, vector<uint8_t>& sysExBuffer) {
-  if (sysExBuffer.size() < 4 || sysExBuffer.back() != MIDIv1_SYSEX_END)
+void HandleMatrixOSSysEx(uint16_t port, const uint8_t* sysEx, size_t length) {
+  if (length < 4 || sysEx[length - 1] != MIDIv1_SYSEX_END)
   {
     return;
   }
 
-  const uint8_t* request = sysExBuffer.data() + 2;
-  size_t requestSize = sysExBuffer.size() - 3;
+  const uint8_t* request = sysEx + 2;
+  size_t requestSize = length - 3;
 
   if (!Command::Submit(Command::Encoding::SysEx7Bit, request, requestSize, MAX_SYSTEM_SYSEX_SIZE - MATRIXOS_SYSEX_REPLY_OVERHEAD,
                        SendCommandSysExReply, port))
   {
-    MLOGE("MIDI", "Dropped MatrixOS SysEx command: %d", sysExBuffer[2]);
+    MLOGE("MIDI", "Dropped MatrixOS SysEx command: %d", sysEx[2]);
   }
 }
 } // namespace MatrixOS::MIDI
@@ -352,39 +320,78 @@ void HandleMatrixOSSysEx(uint16_t port, vector<uint8_t>& sysExBuffer) {
 namespace MatrixOS::USB::MIDI
 {
 std::vector<MidiPort> ports;
-std::vector<TaskHandle_t> portTasks;
-std::vector<string> portTaskNames;
+static TaskHandle_t txTask = nullptr;
+static TransferStats transferStats;
+static CableStats cableStats[USB_MIDI_COUNT];
 
-void portTask(void* param) {
-  uint8_t itf = (uint8_t)(uintptr_t)param;
+// No USB host here, one task drains every cable a burst at a time like the device driver does
+static void TxTask(void* param) {
+  (void)param;
   MidiPacket packet;
   while (true)
   {
-    (void)ports[itf].Get(&packet, portMAX_DELAY);
+    uint16_t packets = 0;
+    for (uint8_t cable = 0; cable < ports.size(); cable++)
+    {
+      uint16_t cablePackets = 0;
+      while (ports[cable].Get(&packet, 0))
+      {
+        cablePackets++;
+      }
+      if (cablePackets > 0)
+      {
+        cableStats[cable].packets += cablePackets;
+        cableStats[cable].transfers++;
+        packets += cablePackets;
+      }
+    }
+    if (packets > 0)
+    {
+      transferStats.transfers++;
+      transferStats.packets += packets;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+TransferStats GetTransferStats() {
+  return transferStats;
+}
+
+vector<CableStats> GetCableStats() {
+  vector<CableStats> stats(cableStats, cableStats + ports.size());
+  for (uint8_t i = 0; i < ports.size(); i++)
+  {
+    stats[i].port = ports[i].id;
   }
+  return stats;
 }
 
 void Init() {
-  for (TaskHandle_t portTaskHandle : portTasks)
+  if (txTask)
   {
-    vTaskDelete(portTaskHandle);
+    Telemetry::UnwatchTask(txTask);
+    vTaskDelete(txTask);
+    txTask = nullptr;
   }
-  portTasks.clear();
-  portTaskNames.clear();
   ports.clear();
+  for (CableStats& stats : cableStats)
+  {
+    stats = CableStats();
+  }
 
   ports.reserve(USB_MIDI_COUNT);
-  portTasks.reserve(USB_MIDI_COUNT);
-
   for (uint8_t i = 0; i < USB_MIDI_COUNT; i++)
   {
     string portname = "USB MIDI " + std::to_string(i + 1);
     ports.emplace_back(portname, MIDI_PORT_USB + i);
+  }
 
-    portTasks.push_back(NULL);
-    portTaskNames.push_back(portname);
-    xTaskCreate(portTask, portTaskNames.back().c_str(), configMINIMAL_STACK_SIZE * 2, (void*)(uintptr_t)i, configMAX_PRIORITIES - 2,
-                &portTasks.back());
+  xTaskCreate(TxTask, "usb_midi_tx", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 2, &txTask);
+  for (MidiPort& port : ports)
+  {
+    port.receiveNotifyTask = txTask;
   }
+  Telemetry::WatchTask(txTask, "usb_midi_tx");
 }
 } // namespace MatrixOS::USB::MIDI
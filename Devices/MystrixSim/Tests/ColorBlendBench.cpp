@@ -0,0 +1,110 @@
+// Times the packed ColorBlend kernels against the plain per-channel math they replace, and checks both agree
+#include "MatrixOS.h"
+#include "TestCheck.h"
+
+#include <chrono>
+#include <random>
+
+static const uint16_t kLEDCount = 96; // A Mystrix frame, 8x8 grid plus the underglow
+static const uint32_t kIterations = 20000;
+
+// Per-channel reference, one channel at a time
+static uint8_t LerpChannel(uint8_t a, uint8_t b, uint16_t weight) {
+  return (a * (256 - weight) + b * weight) >> 8;
+}
+
+static uint8_t AddChannel(uint8_t a, uint8_t b) {
+  return std::min(a + b, 255);
+}
+
+static void ScalarCrossfade(Color* dest, const Color* from, const Color* to, uint16_t count, Fract16 ratio) {
+  uint16_t weight = ColorBlend::Weight(ratio);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i] = Color(LerpChannel(from[i].R, to[i].R, weight), LerpChannel(from[i].G, to[i].G, weight),
+                    LerpChannel(from[i].B, to[i].B, weight), LerpChannel(from[i].W, to[i].W, weight));
+  }
+}
+
+static void ScalarAdd(Color* dest, const Color* src, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i] = Color(AddChannel(dest[i].R, src[i].R), AddChannel(dest[i].G, src[i].G), AddChannel(dest[i].B, src[i].B),
+                    AddChannel(dest[i].W, src[i].W));
+  }
+}
+
+static void ScalarAlphaOver(Color* dest, const Color* src, uint16_t count, uint8_t alpha) {
+  uint16_t weight = alpha + (alpha >> 7);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i] = Color(LerpChannel(dest[i].R, src[i].R, weight), LerpChannel(dest[i].G, src[i].G, weight),
+                    LerpChannel(dest[i].B, src[i].B, weight), LerpChannel(dest[i].W, src[i].W, weight));
+  }
+}
+
+static Color a[kLEDCount];
+static Color b[kLEDCount];
+static Color scalar[kLEDCount];
+static Color packed[kLEDCount];
+
+static void CheckSame() {
+  for (uint16_t i = 0; i < kLEDCount; i++)
+  {
+    CHECK(scalar[i] == packed[i]);
+  }
+}
+
+// Average ns per frame of kernel, which gets the iteration index to vary its input
+template <typename F> static double Time(F&& kernel) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kIterations; i++)
+  {
+    kernel(i);
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / kIterations;
+}
+
+static void Report(const char* name, double scalarNs, double packedNs) {
+  std::printf("%-10s scalar %7.1f ns  packed %7.1f ns  %.2fx\n", name, scalarNs, packedNs, scalarNs / packedNs);
+}
+
+int main() {
+  std::mt19937 random(1);
+  for (uint16_t i = 0; i < kLEDCount; i++)
+  {
+    a[i].SetPacked(random());
+    b[i].SetPacked(random());
+  }
+
+  // Same results first, over every ratio and alpha
+  for (uint32_t ratio = 0; ratio <= 0xFFFF; ratio += 0x101)
+  {
+    ScalarCrossfade(scalar, a, b, kLEDCount, Fract16(ratio));
+    ColorBlend::Crossfade(packed, a, b, kLEDCount, Fract16(ratio));
+    CheckSame();
+  }
+  for (uint16_t alpha = 0; alpha < 256; alpha++)
+  {
+    std::copy(a, a + kLEDCount, scalar);
+    std::copy(a, a + kLEDCount, packed);
+    ScalarAlphaOver(scalar, b, kLEDCount, alpha);
+    ColorBlend::AlphaOver(packed, b, kLEDCount, alpha);
+    CheckSame();
+  }
+  std::copy(a, a + kLEDCount, scalar);
+  std::copy(a, a + kLEDCount, packed);
+  ScalarAdd(scalar, b, kLEDCount);
+  ColorBlend::Add(packed, b, kLEDCount);
+  CheckSame();
+
+  std::printf("%u LEDs per frame, %u frames\n", kLEDCount, kIterations);
+  Report("Crossfade", Time([](uint32_t i) { ScalarCrossfade(scalar, a, b, kLEDCount, Fract16(i * 7)); }),
+         Time([](uint32_t i) { ColorBlend::Crossfade(packed, a, b, kLEDCount, Fract16(i * 7)); }));
+  Report("Add", Time([](uint32_t) { ScalarAdd(scalar, b, kLEDCount); }),
+         Time([](uint32_t) { ColorBlend::Add(packed, b, kLEDCount); }));
+  Report("AlphaOver", Time([](uint32_t i) { ScalarAlphaOver(scalar, b, kLEDCount, i); }),
+         Time([](uint32_t i) { ColorBlend::AlphaOver(packed, b, kLEDCount, i); }));
+  return 0;
+}
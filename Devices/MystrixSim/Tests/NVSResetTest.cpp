@@ -0,0 +1,28 @@
+// Factory reset must not let the NVS cache write a dirty variable back after the store is wiped
+#include "MatrixOS.h"
+#include "Device.h"
+#include "TestCheck.h"
+
+int main() {
+  const uint32_t hash = 0x12345678;
+  uint32_t value = 42;
+
+  // Flushed variable, then a newer value still pending in the cache
+  CHECK(MatrixOS::NVS::SetVariable(hash, &value, sizeof(value)));
+  MatrixOS::NVS::Flush();
+  CHECK(Device::NVS::Size(hash) == sizeof(value));
+  value = 43;
+  CHECK(MatrixOS::NVS::SetVariable(hash, &value, sizeof(value)));
+  CHECK(MatrixOS::NVS::GetCacheStats().pendingWrites == 1);
+
+  // What the factory reset does, Reboot() flushes right after
+  MatrixOS::NVS::Clear();
+  MatrixOS::NVS::Flush();
+
+  CHECK(Device::NVS::Size(hash) == 0);
+  CHECK(MatrixOS::NVS::GetSize(hash) == 0);
+  CHECK(MatrixOS::NVS::GetCacheStats().pendingWrites == 0);
+
+  std::printf("NVSResetTest passed\n");
+  return 0;
+}
@@ -0,0 +1,133 @@
+// Sector cache against a file-backed image, with write failures injected to check nothing dirty is lost
+#include "MatrixOS.h"
+#include "Device.h"
+#include "SectorCache.h"
+#include "FatFS/ff.h"
+#include "TestCheck.h"
+
+#include <cstring>
+
+namespace SectorCache = MatrixOS::FileSystem::SectorCache;
+
+static const uint32_t kSectorCount = 256;
+static std::FILE* image = nullptr;
+static bool failWrites = false;
+static uint32_t deviceWrites = 0;
+static Device::Storage::StorageStatus status = {true, false, kSectorCount, FF_MAX_SS, 1};
+
+// The cache is the only code under test, it gets its own storage instead of the simulator's in-memory one
+namespace Device::Storage
+{
+bool Available() {
+  return true;
+}
+
+const StorageStatus* Status() {
+  return &status;
+}
+
+bool ReadSectors(uint32_t lba, uint32_t sectorCount, void* dest) {
+  std::fseek(image, (long)lba * FF_MAX_SS, SEEK_SET);
+  return std::fread(dest, FF_MAX_SS, sectorCount, image) == sectorCount;
+}
+
+bool WriteSectors(uint32_t lba, uint32_t sectorCount, const void* src) {
+  if (failWrites)
+  {
+    return false;
+  }
+  deviceWrites++;
+  std::fseek(image, (long)lba * FF_MAX_SS, SEEK_SET);
+  return std::fwrite(src, FF_MAX_SS, sectorCount, image) == sectorCount && std::fflush(image) == 0;
+}
+} // namespace Device::Storage
+
+namespace MatrixOS::Logging
+{
+void LogError(const string& tag, const string& format, ...) {
+  std::fprintf(stderr, "[%s] %s\n", tag.c_str(), format.c_str());
+}
+} // namespace MatrixOS::Logging
+
+static void Fill(uint8_t* sector, uint8_t value) {
+  memset(sector, value, FF_MAX_SS);
+}
+
+// What's in the image file right now, bypassing the cache
+static uint8_t OnDisk(uint32_t lba) {
+  uint8_t sector[FF_MAX_SS];
+  std::fseek(image, (long)lba * FF_MAX_SS, SEEK_SET);
+  CHECK(std::fread(sector, FF_MAX_SS, 1, image) == 1);
+  return sector[0];
+}
+
+static void SetOnDisk(uint32_t lba, uint8_t value) {
+  uint8_t sector[FF_MAX_SS];
+  Fill(sector, value);
+  CHECK(Device::Storage::WriteSectors(lba, 1, sector));
+}
+
+int main() {
+  image = std::tmpfile();
+  CHECK(image != nullptr);
+  uint8_t sector[FF_MAX_SS];
+  Fill(sector, 0);
+  for (uint32_t lba = 0; lba < kSectorCount; lba++)
+  {
+    CHECK(std::fwrite(sector, FF_MAX_SS, 1, image) == 1);
+  }
+
+  // Read-through: a miss loads from the image, the second read is a hit
+  SetOnDisk(100, 0xA1);
+  CHECK(SectorCache::Read(100, 1, sector) && sector[0] == 0xA1);
+  CHECK(SectorCache::Read(100, 1, sector) && sector[0] == 0xA1);
+  MatrixOS::FileSystem::SectorCacheStats stats = MatrixOS::FileSystem::GetCacheStats();
+  CHECK(stats.misses == 1 && stats.hits == 1);
+
+  // Write-back: single sector writes stay in the cache until Sync, but reads already see them
+  Fill(sector, 0xB2);
+  CHECK(SectorCache::Write(100, 1, sector));
+  CHECK(OnDisk(100) == 0xA1);
+  uint8_t range[4][FF_MAX_SS];
+  CHECK(SectorCache::Read(99, 4, range) && range[1][0] == 0xB2);
+  CHECK(SectorCache::Sync());
+  CHECK(OnDisk(100) == 0xB2);
+
+  // Eviction: filling every slot with other dirty sectors writes back the least recently used one
+  Fill(sector, 0xC3);
+  CHECK(SectorCache::Write(10, 1, sector));
+  CHECK(OnDisk(10) == 0);
+  for (uint32_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    Fill(sector, 0xD0 + i % 16);
+    CHECK(SectorCache::Write(20 + i * 2, 1, sector));
+  }
+  CHECK(OnDisk(10) == 0xC3);
+  CHECK(SectorCache::Sync());
+  for (uint32_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    CHECK(OnDisk(20 + i * 2) == 0xD0 + i % 16);
+  }
+
+  // Sync failure: the error is reported and the sector stays dirty until a later Sync gets it out
+  Fill(sector, 0xE4);
+  CHECK(SectorCache::Write(200, 1, sector));
+  failWrites = true;
+  CHECK(!SectorCache::Sync());
+  CHECK(SectorCache::Read(200, 1, sector) && sector[0] == 0xE4);
+  failWrites = false;
+  CHECK(OnDisk(200) == 0);
+  uint32_t writesBefore = deviceWrites;
+  CHECK(SectorCache::Sync());
+  CHECK(OnDisk(200) == 0xE4);
+  CHECK(deviceWrites == writesBefore + 1);
+
+  // Nothing is dirty any more
+  writesBefore = deviceWrites;
+  CHECK(SectorCache::Sync());
+  CHECK(deviceWrites == writesBefore);
+
+  std::fclose(image);
+  std::printf("SectorCacheTest passed\n");
+  return 0;
+}
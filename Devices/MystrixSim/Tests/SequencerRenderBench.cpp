@@ -0,0 +1,114 @@
+// Pattern pad render cost on a dense pattern, walking the events per step (the old way) vs the pattern summary cache
+#include "MatrixOS.h"
+#include "Sequencer/Sequence.h"
+#include "TestCheck.h"
+
+#include <chrono>
+#include <unordered_map>
+
+static const uint32_t kFrames = 20000;
+
+// What PatternPad did per step before the summary: range query the events, then walk them when notes are selected
+static uint32_t WalkEvents(Sequence& sequence, SequencePattern* pattern, std::unordered_map<uint8_t, uint8_t>& noteSelected) {
+  SequenceScopedLock lock(sequence);
+  uint32_t lit = 0;
+  uint16_t pulsesPerStep = sequence.GetPulsesPerStep();
+  for (uint8_t step = 0; step < pattern->steps; step++)
+  {
+    uint16_t startTime = step * pulsesPerStep;
+    uint16_t endTime = startTime + pulsesPerStep - 1;
+    bool shouldRender = false;
+    if (noteSelected.empty())
+    {
+      shouldRender = sequence.PatternHasEventInRange(pattern, startTime, endTime, SequenceEventType::NoteEvent);
+    }
+    else
+    {
+      for (auto it = pattern->events.lower_bound(startTime); it != pattern->events.end() && it->first <= endTime; ++it)
+      {
+        if (it->second.eventType == SequenceEventType::NoteEvent &&
+            noteSelected.count(std::get<SequenceEventNote>(it->second.data).note))
+        {
+          shouldRender = true;
+          break;
+        }
+      }
+    }
+    lit += shouldRender;
+  }
+  return lit;
+}
+
+// What PatternPad does now
+static uint32_t ReadSummary(Sequence& sequence, SequencePattern* pattern, std::unordered_map<uint8_t, uint8_t>& noteSelected) {
+  SequenceScopedLock lock(sequence);
+  SequenceNoteSet selectedNotes;
+  for (const auto& selected : noteSelected)
+  {
+    selectedNotes.Set(selected.first);
+  }
+  const SequencePatternSummary& summary = sequence.PatternSummary(pattern);
+  uint32_t lit = 0;
+  for (uint8_t step = 0; step < pattern->steps; step++)
+  {
+    lit += noteSelected.empty() ? summary.HasNote(step) : summary.HasAnyNote(step, selectedNotes);
+  }
+  return lit;
+}
+
+// Average us per frame, and the steps lit in the last frame
+template <typename F> static double Time(F&& frame, uint32_t frames, uint32_t* lit) {
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < frames; i++)
+  {
+    *lit = frame();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::micro>(elapsed).count() / frames;
+}
+
+int main() {
+  Sequence sequence(8);
+  uint16_t pulsesPerStep = sequence.GetPulsesPerStep();
+  SequencePattern* pattern = sequence.GetPattern(0, 0, 0);
+
+  // Dense: 6 microstep positions per step, each a 4 note chord plus a CC
+  for (uint8_t step = 0; step < pattern->steps; step++)
+  {
+    for (uint8_t micro = 0; micro < 6; micro++)
+    {
+      uint16_t time = step * pulsesPerStep + micro * (pulsesPerStep / 6);
+      for (uint8_t note = 0; note < 4; note++)
+      {
+        sequence.PatternAddEvent(pattern, time, SequenceEvent::Note(36 + (step * 7 + micro * 3 + note * 4) % 60, 100, false, pulsesPerStep));
+      }
+      sequence.PatternAddEvent(pattern, time, SequenceEvent::ControlChange(1, micro));
+    }
+  }
+  std::printf("%zu events over %u steps, %u frames\n", pattern->events.size(), pattern->steps, kFrames);
+
+  for (bool filter : {false, true})
+  {
+    // Selected notes that aren't in the pattern, the walk has to look at every event
+    std::unordered_map<uint8_t, uint8_t> noteSelected;
+    if (filter)
+    {
+      noteSelected[126] = 100;
+      noteSelected[127] = 100;
+    }
+
+    uint32_t walkLit, summaryLit, rebuildLit;
+    double walkUs = Time([&] { return WalkEvents(sequence, pattern, noteSelected); }, kFrames, &walkLit);
+    double summaryUs = Time([&] { return ReadSummary(sequence, pattern, noteSelected); }, kFrames, &summaryLit);
+    // Worst case for the cache, the pattern is edited every frame
+    double rebuildUs = Time([&] {
+      pattern->Invalidate();
+      return ReadSummary(sequence, pattern, noteSelected);
+    }, kFrames / 10, &rebuildLit);
+    CHECK(walkLit == summaryLit && walkLit == rebuildLit);
+
+    std::printf("%-11s walk %7.2f us  summary %6.3f us  summary rebuilt every frame %6.2f us  (%u steps lit)\n",
+                filter ? "note filter" : "no filter", walkUs, summaryUs, rebuildUs, walkLit);
+  }
+  return 0;
+}
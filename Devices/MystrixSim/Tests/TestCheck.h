@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Minimal check macro for the host tests, prints the failing expression and exits non-zero
+#define CHECK(expr)                                                         \
+  do                                                                        \
+  {                                                                         \
+    if (!(expr))                                                            \
+    {                                                                       \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+      std::exit(1);                                                         \
+    }                                                                       \
+  } while (0)
@@ -3,6 +3,7 @@
 
 #include "../../Applications/Application.h"
 #include "../System/System.h"
+#include "../System/Telemetry.h"
 
 namespace MatrixOS::Command
 {
@@ -89,11 +90,13 @@ void Init() {
   if (requestQueue == nullptr)
   {
     requestQueue = xQueueCreate(QUEUE_DEPTH, sizeof(QueuedRequest));
+    vQueueAddToRegistry(requestQueue, "Command");
   }
 
   if (commandTask == nullptr)
   {
     commandTask = xTaskCreateStatic(CommandTask, "cmd_handler", TASK_STACK_SIZE, nullptr, 1, commandTaskStack, &commandTaskDef);
+    Telemetry::WatchTask(commandTask, "cmd_handler");
   }
 }
 
@@ -410,6 +413,161 @@ static bool HandleLedFillPartition(const uint8_t* request, size_t size, Encoding
   return MatrixOS::LED::FillPartition(Device::LED::partitions[partitionIndex].name, color, layer);
 }
 
+// Frame staged by LED stream segments, written to its layer on commit
+static vector<Color> streamFrame;
+static bool streamStarted = false;
+static uint8_t streamNextSequence = 0;
+static LedStreamStats streamStats;
+static constexpr size_t STREAM_COLOR_SIZE = 3;
+
+static Color DecodeStreamColor(const uint8_t* data, Encoding encoding) {
+  if (encoding == Encoding::HID)
+  {
+    return Color(data[0], data[1], data[2]);
+  }
+  // Stretch 7 bit to the full 8 bit range so 0x7F is full brightness
+  return Color((data[0] << 1) | (data[0] >> 6), (data[1] << 1) | (data[1] >> 6), (data[2] << 1) | (data[2] >> 6));
+}
+
+static bool DecodeStreamRGB(const uint8_t* payload, size_t size, uint16_t offset, Encoding encoding) {
+  if (size % STREAM_COLOR_SIZE != 0 || offset + size / STREAM_COLOR_SIZE > streamFrame.size())
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < size; i += STREAM_COLOR_SIZE)
+  {
+    streamFrame[offset++] = DecodeStreamColor(payload + i, encoding);
+  }
+  return true;
+}
+
+static bool DecodeStreamBitmap(const uint8_t* payload, size_t size, uint16_t offset, Encoding encoding) {
+  if (size < 1 || size < 1 + (size_t)payload[0])
+  {
+    return false;
+  }
+
+  const uint8_t* bitmap = payload + 1;
+  uint8_t bitmapLength = payload[0];
+  uint8_t bitsPerByte = encoding == Encoding::HID ? 8 : 7;
+  size_t colorOffset = 1 + bitmapLength;
+
+  for (uint16_t byte = 0; byte < bitmapLength; byte++)
+  {
+    for (uint8_t bit = 0; bit < bitsPerByte; bit++)
+    {
+      if ((bitmap[byte] & (1 << bit)) == 0)
+      {
+        continue;
+      }
+
+      size_t index = offset + byte * bitsPerByte + bit;
+      if (index >= streamFrame.size() || colorOffset + STREAM_COLOR_SIZE > size)
+      {
+        return false;
+      }
+      streamFrame[index] = DecodeStreamColor(payload + colorOffset, encoding);
+      colorOffset += STREAM_COLOR_SIZE;
+    }
+  }
+  return colorOffset == size;
+}
+
+static bool DecodeStreamRLE(const uint8_t* payload, size_t size, uint16_t offset, Encoding encoding) {
+  size_t recordSize = 2 + STREAM_COLOR_SIZE;
+  if (size % recordSize != 0)
+  {
+    return false;
+  }
+
+  size_t index = offset;
+  for (size_t i = 0; i < size; i += recordSize)
+  {
+    index += payload[i];
+    uint8_t run = payload[i + 1];
+    if (index + run > streamFrame.size())
+    {
+      return false;
+    }
+    std::fill_n(streamFrame.begin() + index, run, DecodeStreamColor(payload + i + 2, encoding));
+    index += run;
+  }
+  return true;
+}
+
+static bool HandleLedStreamFrame(uint8_t command, const uint8_t* request, size_t size, Encoding encoding, size_t maxReplyLength,
+                                 ReplyCallback replyCallback, void* replyContext) {
+  size_t payloadOffset = 0;
+  uint16_t offset = 0;
+  if (size < 4 || (encoding == Encoding::SysEx7Bit && !Is7BitData(request + 1, size - 1)) ||
+      !DecodeUInt16(request, size, 4, encoding, &offset, &payloadOffset))
+  {
+    streamStats.rejectedSegments++;
+    return false;
+  }
+
+  uint8_t flags = request[1];
+  uint8_t sequence = request[2];
+  uint8_t layer = request[3] == LED_STREAM_LAYER_TOP ? DEFAULT_LAYER : request[3];
+  if (layer != DEFAULT_LAYER && layer > MatrixOS::LED::CurrentLayer())
+  {
+    streamStats.rejectedSegments++;
+    return false;
+  }
+
+  if (streamFrame.size() != MatrixOS::LED::GetLEDCount())
+  {
+    streamFrame.assign(MatrixOS::LED::GetLEDCount(), Color(0));
+  }
+
+  const uint8_t* payload = request + payloadOffset;
+  size_t payloadSize = size - payloadOffset;
+  bool decoded = false;
+  switch (flags & LED_STREAM_ENCODING)
+  {
+  case LED_STREAM_RGB:
+    decoded = DecodeStreamRGB(payload, payloadSize, offset, encoding);
+    break;
+  case LED_STREAM_BITMAP:
+    decoded = DecodeStreamBitmap(payload, payloadSize, offset, encoding);
+    break;
+  case LED_STREAM_RLE:
+    decoded = DecodeStreamRLE(payload, payloadSize, offset, encoding);
+    break;
+  }
+
+  if (!decoded)
+  {
+    streamStats.rejectedSegments++;
+    return false;
+  }
+
+  if ((flags & LED_STREAM_COMMIT) == 0)
+  {
+    return true;
+  }
+
+  MatrixOS::LED::SetColors(0, streamFrame.data(), streamFrame.size(), layer);
+  MatrixOS::LED::Update(layer);
+
+  uint8_t sequenceMask = encoding == Encoding::HID ? 0xFF : 0x7F;
+  if (streamStarted)
+  {
+    streamStats.droppedFrames += (sequence - streamNextSequence) & sequenceMask;
+  }
+  streamStarted = true;
+  streamNextSequence = (sequence + 1) & sequenceMask;
+  streamStats.lastSequence = sequence;
+  streamStats.frames++;
+
+  if (flags & LED_STREAM_ACK)
+  {
+    return SendReply(vector<uint8_t>{ResponseCommand(command, encoding), sequence}, maxReplyLength, replyCallback, replyContext);
+  }
+  return true;
+}
+
 static bool HandleKeypadGetKeyXY(uint8_t command, const uint8_t* request, size_t size, Encoding encoding, size_t maxReplyLength,
                                  ReplyCallback replyCallback, void* replyContext) {
   if (size < 3 || (encoding == Encoding::SysEx7Bit && !Is7BitData(request + 1, 2)))
@@ -470,6 +628,54 @@ static bool HandleKeypadGetKeyID(uint8_t command, const uint8_t* request, size_t
   return SendReply(reply, maxReplyLength, replyCallback, replyContext);
 }
 
+static Telemetry::Snapshot telemetry; // Baseline for the CPU shares, only touched by the command task
+
+static bool HandleTelemetry(uint8_t command, Encoding encoding, size_t maxReplyLength, ReplyCallback replyCallback, void* replyContext) {
+  vector<uint8_t> reply = {ResponseCommand(command, encoding)};
+  if (command == MATRIXOS_COMMAND_GET_TASK_STATS)
+  {
+    Telemetry::Sample(&telemetry);
+    AppendUInt32(&reply, telemetry.timestamp, encoding);
+    AppendUInt32(&reply, telemetry.freeHeap, encoding);
+    AppendUInt32(&reply, telemetry.minimumFreeHeap, encoding);
+    reply.push_back((uint8_t)telemetry.tasks.size());
+    for (const Telemetry::TaskStats& task : telemetry.tasks)
+    {
+      AppendString(&reply, task.name);
+      reply.push_back(task.priority);
+      AppendUInt32(&reply, task.stackFree, encoding);
+      AppendUInt32(&reply, task.runTime, encoding);
+      AppendUInt16(&reply, task.cpuPermille, encoding);
+    }
+    return SendReply(reply, maxReplyLength, replyCallback, replyContext);
+  }
+
+  Telemetry::Snapshot snapshot;
+  Telemetry::Sample(&snapshot);
+  if (command == MATRIXOS_COMMAND_GET_QUEUE_STATS)
+  {
+    reply.push_back((uint8_t)snapshot.queues.size());
+    for (const Telemetry::QueueStats& queue : snapshot.queues)
+    {
+      AppendString(&reply, queue.name);
+      AppendUInt32(&reply, queue.capacity, encoding);
+      AppendUInt32(&reply, queue.pending, encoding);
+      AppendUInt32(&reply, queue.highWaterMark, encoding);
+      AppendUInt32(&reply, queue.dropped, encoding);
+    }
+  }
+  else
+  {
+    reply.push_back((uint8_t)snapshot.drops.size());
+    for (const Telemetry::Counter& counter : snapshot.drops)
+    {
+      AppendString(&reply, counter.name);
+      AppendUInt32(&reply, counter.value, encoding);
+    }
+  }
+  return SendReply(reply, maxReplyLength, replyCallback, replyContext);
+}
+
 static bool SendReply(const vector<uint8_t>& reply, size_t maxReplyLength, ReplyCallback replyCallback, void* replyContext) {
   if (replyCallback == nullptr || maxReplyLength == 0)
   {
@@ -569,6 +775,11 @@ bool Handle(const uint8_t* request, size_t size, Encoding encoding, size_t maxRe
     SYS::ExecuteAPP(appId);
     return true;
   }
+  case MATRIXOS_COMMAND_GET_TASK_STATS:
+  case MATRIXOS_COMMAND_GET_QUEUE_STATS:
+  case MATRIXOS_COMMAND_GET_DROP_COUNTERS: {
+    return HandleTelemetry(command, encoding, maxReplyLength, replyCallback, replyContext);
+  }
   case MATRIXOS_COMMAND_QUIT_APP:
   case MATRIXOS_COMMAND_BOOTLOADER:
   case MATRIXOS_COMMAND_REBOOT:
@@ -671,6 +882,16 @@ bool Handle(const uint8_t* request, size_t size, Encoding encoding, size_t maxRe
     MatrixOS::LED::Fade(crossfade);
     return true;
   }
+  case MATRIXOS_COMMAND_LED_STREAM_FRAME: {
+    return HandleLedStreamFrame(command, request, size, encoding, maxReplyLength, replyCallback, replyContext);
+  }
+  case MATRIXOS_COMMAND_LED_STREAM_STATS: {
+    vector<uint8_t> reply = {ResponseCommand(command, encoding), streamStats.lastSequence};
+    AppendUInt32(&reply, streamStats.frames, encoding);
+    AppendUInt32(&reply, streamStats.droppedFrames, encoding);
+    AppendUInt32(&reply, streamStats.rejectedSegments, encoding);
+    return SendReply(reply, maxReplyLength, replyCallback, replyContext);
+  }
   case MATRIXOS_COMMAND_GET_LED_CURRENT_LAYER: {
     return SendReply(vector<uint8_t>{ResponseCommand(command, encoding), (uint8_t)MatrixOS::LED::CurrentLayer()}, maxReplyLength,
                      replyCallback, replyContext);
@@ -690,4 +911,8 @@ bool Handle(const uint8_t* request, size_t size, Encoding encoding, size_t maxRe
   }
   }
 }
+
+LedStreamStats GetLedStreamStats() {
+  return streamStats;
+}
 } // namespace MatrixOS::Command
@@ -6,9 +6,17 @@ namespace MatrixOS::Command
 {
 enum class Encoding : uint8_t { HID, SysEx7Bit };
 
+struct LedStreamStats {
+  uint8_t lastSequence = 0;
+  uint32_t frames = 0;           // Frames committed to a layer
+  uint32_t droppedFrames = 0;    // Sequence numbers skipped between committed frames
+  uint32_t rejectedSegments = 0; // Malformed segments
+};
+
 using ReplyCallback = bool (*)(const vector<uint8_t>& reply, bool end, void* context);
 
 void Init();
 bool Submit(Encoding encoding, const uint8_t* request, size_t size, size_t maxReplyLength, ReplyCallback replyCallback, uint16_t replyPort = 0);
 bool Handle(const uint8_t* request, size_t size, Encoding encoding, size_t maxReplyLength, ReplyCallback replyCallback, void* replyContext);
+LedStreamStats GetLedStreamStats();
 } // namespace MatrixOS::Command
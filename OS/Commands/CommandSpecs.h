@@ -32,6 +32,18 @@
   0x18 // [MATRIXOS_COMMAND_ENTER_APP, app_id] Enters the app with the given app_id. Returns ack.
 #define MATRIXOS_COMMAND_QUIT_APP 0x1F // [MATRIXOS_COMMAND_QUIT_APP] Quits the current app. Returns ack.
 
+// Telemetry, sampled on request. uint32 values are 4 bytes over HID and 5 bytes of 7 bits over SysEx, uint16 are 2 and 3.
+// CPU shares are since the previous GET_TASK_STATS, so poll it at a steady rate. run_time is 0xFFFFFFFF when the build
+// doesn't keep FreeRTOS run time stats.
+#define MATRIXOS_COMMAND_GET_TASK_STATS                                                                                                    \
+  0x20 // Returns [MATRIXOS_COMMAND_GET_TASK_STATS, uptime_ms, free_heap, min_free_heap, task_count, tasks...] each task as
+       // [name as null terminated array, priority, stack_free in bytes, run_time, cpu_permille as uint16]
+#define MATRIXOS_COMMAND_GET_QUEUE_STATS                                                                                                   \
+  0x21 // Returns [MATRIXOS_COMMAND_GET_QUEUE_STATS, queue_count, queues...] each queue as
+       // [name as null terminated array, capacity, pending, high_water_mark, dropped]
+#define MATRIXOS_COMMAND_GET_DROP_COUNTERS                                                                                                 \
+  0x22 // Returns [MATRIXOS_COMMAND_GET_DROP_COUNTERS, counter_count, counters...] each counter as [name as null terminated array, value]
+
 #define MATRIXOS_COMMAND_BOOTLOADER 0x40          // [MATRIXOS_COMMAND_BOOTLOADER] Enters the bootloader. Returns ack.
 #define MATRIXOS_COMMAND_REBOOT 0x41              // [MATRIXOS_COMMAND_REBOOT] Reboots the device. Returns ack.
 #define MATRIXOS_COMMAND_SLEEP 0x42               // [MATRIXOS_COMMAND_SLEEP] Sleeps briefly. Returns ack.
@@ -57,13 +69,32 @@
   0x56 // [MATRIXOS_COMMAND_LED_COPYLAYER, from_layer, to_layer] Copies the content of from_layer to to_layer
 #define MATRIXOS_COMMAND_LED_DESTROYLAYER                                                                                                \
   0x57 // [MATRIXOS_COMMAND_LED_DESTROYLAYER, crossfade as optional] Destroys the current layer and returns whether it was destroyed
+#define MATRIXOS_COMMAND_LED_STREAM_FRAME                                                                                                  \
+  0x58 // [MATRIXOS_COMMAND_LED_STREAM_FRAME, flags, sequence, layer, offset, payload] Writes a full or delta frame segment, see below
 #define MATRIXOS_COMMAND_LED_SET_BRIGHTNESS 0x59 // [MATRIXOS_COMMAND_LED_SET_BRIGHTNESS, brightness] Sets the brightness of the screen
 #define MATRIXOS_COMMAND_LED_FADE                                                                                                          \
   0x5A // [MATRIXOS_COMMAND_LED_FADE, crossfade as optional] Fades from the previous layer buffer to the current layer buffer
+#define MATRIXOS_COMMAND_LED_STREAM_STATS                                                                                                  \
+  0x5B // Returns [MATRIXOS_COMMAND_LED_STREAM_STATS, last_sequence, frames, dropped_frames, rejected_segments] as uint32 counters
 #define MATRIXOS_COMMAND_GET_LED_CURRENT_LAYER                                                                                             \
   0x5C                                           // Returns [MATRIXOS_COMMAND_LED_GET_CURRENT_LAYER, current_layer] Gets the current layer
 #define MATRIXOS_COMMAND_GET_LED_BRIGHTNESS 0x5D // Returns [MATRIXOS_COMMAND_GET_BRIGHTNESS, brightness] Gets the brightness of the screen
 
+// LED frame streaming
+// Segments are staged in a frame buffer (LED index order, GET_DEVICE_LED_COUNT long) that persists between frames. The segment with
+// LED_STREAM_COMMIT writes the whole staged frame to the layer with a single Update. Segments of one frame share its sequence number,
+// which counts up per frame and wraps at 128 over SysEx and 256 over HID. Skipped sequence numbers are counted as dropped frames.
+// layer 0x7F is the current top layer. offset is the first LED index (uint16). Colors are 3 bytes R G B, 7 bit over SysEx and 8 bit
+// over HID. Deltas apply on top of the staged frame, so send a full frame to resync after a drop.
+#define LED_STREAM_COMMIT 0x01     // Last segment of the frame, write it to the layer and update
+#define LED_STREAM_ACK 0x02        // Reply [MATRIXOS_COMMAND_LED_STREAM_FRAME, sequence] once committed, for round trip timing
+#define LED_STREAM_ENCODING 0x0C   // Payload encoding mask
+#define LED_STREAM_RGB 0x00        // Colors for consecutive LEDs from offset
+#define LED_STREAM_BITMAP 0x04     // [bitmap_length, bitmap, colors] Changed LEDs from offset, LSB first, 7 per byte over SysEx and 8 over
+                                   // HID, followed by a color for each set bit
+#define LED_STREAM_RLE 0x08        // [skip, run, color]... Leaves skip LEDs as they are, then sets run LEDs to color
+#define LED_STREAM_LAYER_TOP 0x7F
+
 #define MATRIXOS_COMMAND_KEYPAD_GET_KEY_XY 0x60 // [MATRIXOS_COMMAND_KEYPAD_GET_KEY_XY, x, y] Gets the key at x, y
 #define MATRIXOS_COMMAND_KEYPAD_GET_KEY_ID 0x61 // [MATRIXOS_COMMAND_KEYPAD_GET_KEY_ID, id] Gets the key at id
 
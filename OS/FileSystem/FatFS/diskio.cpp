@@ -7,6 +7,7 @@
 #include "ff.h"     /* Obtains integer types */
 #include "diskio.h" /* Declarations of disk functions */
 #include "Device.h" /* MatrixOS Device layer interface */
+#include "SectorCache.h"
 
 extern "C" {
 
@@ -61,7 +62,7 @@ DRESULT disk_read (
 )
 {
 #if DEVICE_STORAGE == 1
-  bool result = Device::Storage::ReadSectors(sector, count, buff);
+  bool result = MatrixOS::FileSystem::SectorCache::Read(sector, count, buff);
   return result ? RES_OK : RES_ERROR;
 #else
   return RES_NOTRDY;
@@ -82,7 +83,7 @@ DRESULT disk_write (
 )
 {
 #if DEVICE_STORAGE == 1
-  bool result = Device::Storage::WriteSectors(sector, count, buff);
+  bool result = MatrixOS::FileSystem::SectorCache::Write(sector, count, buff);
   return result ? RES_OK : RES_ERROR;
 #else
   return RES_NOTRDY;
@@ -107,7 +108,7 @@ DRESULT disk_ioctl (
   switch (cmd)
   {
     case 0: // CTRL_SYNC
-      return RES_OK; // Always successful for SDMMC
+      return MatrixOS::FileSystem::SectorCache::Sync() ? RES_OK : RES_ERROR;
 
     case 1: // GET_SECTOR_COUNT
       if (status->available && buff)
@@ -66,4 +66,6 @@ namespace MatrixOS::FileSystem
   bool RemoveDir(const string& path) { return false; }
   bool Rename(const string& from, const string& to) { return false; }
   vector<string> ListDir(const string& path) { return {}; }
+  SectorCacheStats GetCacheStats() { return {}; }
+  MassStorageStats GetMassStorageStats() { return {}; }
 }
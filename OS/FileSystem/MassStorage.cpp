@@ -0,0 +1,254 @@
+#include "MassStorage.h"
+#include "SectorCache.h"
+#include "Device.h"
+#include "FatFS/ff.h"
+#include "../System/Telemetry.h"
+
+#include <algorithm>
+
+static_assert(MSC_TRANSFER_SECTORS > 0, "Mass storage needs at least one sector per transfer buffer");
+
+namespace MatrixOS::FileSystem::MassStorage
+{
+enum class Mode : uint8_t { Idle, Reading, Writing };
+enum class Job : uint8_t { Fill, Drain };
+
+struct Buffer {
+  uint8_t data[MSC_TRANSFER_SECTORS][FF_MAX_SS];
+  uint32_t lba = 0;
+  uint32_t count = 0;      // Sectors held
+  uint32_t generation = 0; // SectorCache generation a fill was read at
+};
+
+struct Request {
+  Job job;
+  Buffer* buffer;
+};
+
+static Buffer buffers[2];
+static Buffer* front = &buffers[0]; // Read window being served, or writes being coalesced
+static Buffer* back = &buffers[1];  // Handed to the storage task while backBusy
+static bool backBusy = false;
+static Job backJob = Job::Fill;
+static Mode mode = Mode::Idle;
+static uint32_t nextReadSector = UINT32_MAX;
+static bool writeFailed = false; // A background write failed and the host hasn't been told yet
+
+static QueueHandle_t requests = nullptr;
+static QueueHandle_t results = nullptr;
+static TaskHandle_t storageTask = nullptr;
+
+static MassStorageStats stats;
+
+static bool Fill(Buffer* buffer) {
+  buffer->generation = SectorCache::Generation();
+  SectorCache::Sync(); // Let the host see sectors the file system still holds in cache
+  return Device::Storage::ReadSectors(buffer->lba, buffer->count, buffer->data);
+}
+
+static bool Drain(Buffer* buffer) {
+  bool written = Device::Storage::WriteSectors(buffer->lba, buffer->count, buffer->data);
+  SectorCache::Invalidate(buffer->lba, buffer->count); // Host wrote behind the file system's back
+  return written;
+}
+
+static void StorageTask(void* param) {
+  (void)param;
+  Request request;
+  while (true)
+  {
+    xQueueReceive(requests, &request, portMAX_DELAY);
+    bool success = request.job == Job::Fill ? Fill(request.buffer) : Drain(request.buffer);
+    xQueueSend(results, &success, portMAX_DELAY);
+  }
+}
+
+static void Start() {
+  if (storageTask != nullptr)
+  {
+    return;
+  }
+  requests = xQueueCreate(1, sizeof(Request));
+  results = xQueueCreate(1, sizeof(bool));
+  xTaskCreate(StorageTask, "msc_storage", configMINIMAL_STACK_SIZE * 4, NULL, configMAX_PRIORITIES - 1, &storageTask);
+  Telemetry::WatchTask(storageTask, "msc_storage");
+}
+
+static void Submit(Job job) {
+  Request request = {job, back};
+  backJob = job;
+  backBusy = true;
+  xQueueSend(requests, &request, portMAX_DELAY);
+}
+
+// Waits for the back buffer, a failed fill just leaves it empty
+static void WaitBack() {
+  if (!backBusy)
+  {
+    return;
+  }
+
+  uint64_t start = SYS::Micros();
+  bool success;
+  xQueueReceive(results, &success, portMAX_DELAY);
+  stats.waitUs += SYS::Micros() - start;
+  backBusy = false;
+
+  if (!success && backJob == Job::Drain)
+  {
+    writeFailed = true;
+    stats.writeErrors++;
+  }
+  if (!success || backJob == Job::Drain)
+  {
+    back->count = 0;
+  }
+}
+
+static bool Holds(const Buffer* buffer, uint32_t sector) {
+  return buffer->count > 0 && sector >= buffer->lba && sector - buffer->lba < buffer->count &&
+         buffer->generation == SectorCache::Generation();
+}
+
+static uint32_t WindowSize(uint32_t sector) {
+  uint32_t sectorCount = Device::Storage::Status()->sectorCount;
+  return sector < sectorCount ? std::min<uint32_t>(MSC_TRANSFER_SECTORS, sectorCount - sector) : 0;
+}
+
+// Hands the coalesced writes to the storage task, once it is done with the previous ones
+static void StartWrite() {
+  WaitBack();
+  std::swap(front, back);
+  front->count = 0;
+  stats.storageWrites++;
+  Submit(Job::Drain);
+}
+
+static bool TakeWriteFailure() {
+  bool failed = writeFailed;
+  writeFailed = false;
+  return failed;
+}
+
+bool Flush() {
+  Start();
+  if (mode == Mode::Writing && front->count > 0)
+  {
+    StartWrite();
+  }
+  WaitBack();
+  return !TakeWriteFailure();
+}
+
+int32_t Read(uint32_t lba, void* dest, uint32_t length) {
+  Start();
+  if (mode == Mode::Writing && !Flush())
+  {
+    return -1;
+  }
+  mode = Mode::Reading;
+
+  uint32_t count = length / FF_MAX_SS;
+  bool sequential = lba == nextReadSector;
+  uint8_t* out = (uint8_t*)dest;
+  for (uint32_t done = 0; done < count;)
+  {
+    uint32_t sector = lba + done;
+    if (!Holds(front, sector))
+    {
+      WaitBack();
+      if (Holds(back, sector))
+      {
+        std::swap(front, back);
+        back->count = 0;
+        stats.readaheadHits++;
+      }
+      else
+      {
+        front->lba = sector;
+        front->count = WindowSize(sector);
+        if (front->count == 0 || !Fill(front))
+        {
+          front->count = 0;
+          return -1;
+        }
+        stats.readMisses++;
+      }
+    }
+
+    uint32_t span = std::min(count - done, front->lba + front->count - sector);
+    memcpy(out + done * FF_MAX_SS, front->data[sector - front->lba], span * FF_MAX_SS);
+    done += span;
+  }
+  stats.sectorsRead += count;
+  nextReadSector = lba + count;
+
+  // Keep the next window coming while USB streams this one
+  uint32_t nextWindow = front->lba + front->count;
+  if (sequential && !backBusy && !Holds(back, nextWindow) && WindowSize(nextWindow) > 0)
+  {
+    back->lba = nextWindow;
+    back->count = WindowSize(nextWindow);
+    Submit(Job::Fill);
+  }
+  return length;
+}
+
+int32_t Write(uint32_t lba, const void* src, uint32_t length) {
+  Start();
+  if (TakeWriteFailure())
+  {
+    return -1;
+  }
+  if (mode == Mode::Reading)
+  {
+    // Read windows would go stale
+    WaitBack();
+    front->count = 0;
+    back->count = 0;
+    nextReadSector = UINT32_MAX;
+  }
+  mode = Mode::Writing;
+
+  uint32_t count = length / FF_MAX_SS;
+  const uint8_t* in = (const uint8_t*)src;
+  for (uint32_t done = 0; done < count;)
+  {
+    uint32_t sector = lba + done;
+    if (front->count > 0 && (sector != front->lba + front->count || front->count == MSC_TRANSFER_SECTORS))
+    {
+      StartWrite();
+    }
+    if (front->count == 0)
+    {
+      front->lba = sector;
+    }
+
+    uint32_t span = std::min<uint32_t>(count - done, MSC_TRANSFER_SECTORS - front->count);
+    memcpy(front->data[front->count], in + done * FF_MAX_SS, span * FF_MAX_SS);
+    front->count += span;
+    done += span;
+  }
+  stats.sectorsWritten += count;
+
+  if (front->count == MSC_TRANSFER_SECTORS)
+  {
+    StartWrite();
+  }
+  return length;
+}
+
+void WriteComplete() {
+  if (mode == Mode::Writing && front->count > 0)
+  {
+    StartWrite();
+  }
+}
+} // namespace MatrixOS::FileSystem::MassStorage
+
+namespace MatrixOS::FileSystem
+{
+MassStorageStats GetMassStorageStats() {
+  return MassStorage::stats;
+}
+} // namespace MatrixOS::FileSystem
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#ifndef MSC_TRANSFER_SECTORS
+#define MSC_TRANSFER_SECTORS 16 // Sectors per transfer buffer, there are two so USB and storage can work at once
+#endif
+
+// Block access for a USB mass storage host, kept coherent with SectorCache.
+// Two transfer buffers take turns, while USB streams one the storage task reads ahead into or writes back the other.
+// Sequential reads are served from read-ahead windows. Contiguous writes are coalesced into whole buffer writes that
+// finish in the background, a failed one is reported by the next call.
+// Read, Write, WriteComplete and Flush are called from one task only (the USB task).
+namespace MatrixOS::FileSystem::MassStorage
+{
+// Same contract as the TinyUSB READ10 / WRITE10 callbacks: lba is the first sector of this chunk, length is whole
+// sectors. Return length, or -1 on a storage error.
+int32_t Read(uint32_t lba, void* dest, uint32_t length);
+int32_t Write(uint32_t lba, const void* src, uint32_t length);
+void WriteComplete(); // The host finished a write command, start writing back what is still being coalesced
+bool Flush();         // Returns once every accepted write is on storage, false if any of them failed
+} // namespace MatrixOS::FileSystem::MassStorage
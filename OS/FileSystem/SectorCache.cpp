@@ -0,0 +1,298 @@
+#include "SectorCache.h"
+#include "Device.h"
+#include "FatFS/ff.h"
+
+#include <atomic>
+
+static_assert(FS_SECTOR_CACHE_SIZE > 0, "Sector cache needs at least one slot");
+static_assert(FS_READAHEAD_SECTORS > 0, "Use 1 to disable readahead");
+
+namespace MatrixOS::FileSystem::SectorCache
+{
+struct Slot {
+  uint32_t sector = 0;
+  uint32_t lastUse = 0;
+  bool valid = false;
+  bool dirty = false;
+};
+
+static Slot slots[FS_SECTOR_CACHE_SIZE];
+static uint8_t slotData[FS_SECTOR_CACHE_SIZE][FF_MAX_SS];
+static uint32_t useCounter = 0;
+
+static uint8_t readaheadData[FS_READAHEAD_SECTORS][FF_MAX_SS];
+static uint32_t readaheadStart = 0;
+static uint32_t readaheadCount = 0;
+static uint32_t nextSequentialSector = UINT32_MAX;
+
+static SectorCacheStats stats;
+static std::atomic<uint32_t> generation{0};
+
+static SemaphoreHandle_t Mutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+static bool Overlaps(uint32_t sector, uint32_t start, uint32_t count) {
+  return sector >= start && sector - start < count;
+}
+
+static Slot* Find(uint32_t sector) {
+  for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    if (slots[i].valid && slots[i].sector == sector)
+    {
+      return &slots[i];
+    }
+  }
+  return nullptr;
+}
+
+static uint8_t* Data(Slot* slot) {
+  return slotData[slot - slots];
+}
+
+static void Touch(Slot* slot) {
+  slot->lastUse = ++useCounter;
+}
+
+static bool WriteBack(Slot* slot) {
+  if (!Device::Storage::WriteSectors(slot->sector, 1, Data(slot)))
+  {
+    return false;
+  }
+  slot->dirty = false;
+  stats.writeBacks++;
+  return true;
+}
+
+// Take a free slot, or the least recently used one after writing it back
+static Slot* Allocate(uint32_t sector) {
+  Slot* victim = &slots[0];
+  for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    if (!slots[i].valid)
+    {
+      victim = &slots[i];
+      break;
+    }
+    if (slots[i].lastUse < victim->lastUse)
+    {
+      victim = &slots[i];
+    }
+  }
+
+  if (victim->valid && victim->dirty && !WriteBack(victim))
+  {
+    return nullptr;
+  }
+
+  victim->sector = sector;
+  victim->valid = true;
+  victim->dirty = false;
+  Touch(victim);
+  return victim;
+}
+
+// Storage holds stale data for dirty sectors, copy them over anything just read from it
+static void PatchDirty(uint32_t sector, uint32_t count, uint8_t* dest) {
+  for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    if (slots[i].valid && slots[i].dirty && Overlaps(slots[i].sector, sector, count))
+    {
+      memcpy(dest + (slots[i].sector - sector) * FF_MAX_SS, slotData[i], FF_MAX_SS);
+    }
+  }
+}
+
+static void DropReadahead(uint32_t sector, uint32_t count) {
+  if (readaheadCount > 0 && sector < readaheadStart + readaheadCount && readaheadStart < sector + count)
+  {
+    readaheadCount = 0;
+  }
+}
+
+static bool ReadSector(uint32_t sector, uint8_t* dest) {
+  Slot* slot = Find(sector);
+  if (slot != nullptr)
+  {
+    memcpy(dest, Data(slot), FF_MAX_SS);
+    Touch(slot);
+    stats.hits++;
+    return true;
+  }
+
+  if (readaheadCount > 0 && Overlaps(sector, readaheadStart, readaheadCount))
+  {
+    memcpy(dest, readaheadData[sector - readaheadStart], FF_MAX_SS);
+    stats.readaheadHits++;
+    return true;
+  }
+
+  stats.misses++;
+
+  // Sequential access, most likely file data. Fetch ahead into the readahead window and keep the LRU for metadata.
+  if (FS_READAHEAD_SECTORS > 1 && sector == nextSequentialSector)
+  {
+    uint32_t sectorCount = Device::Storage::Status()->sectorCount;
+    uint32_t count = std::min<uint32_t>(FS_READAHEAD_SECTORS, sectorCount > sector ? sectorCount - sector : 1);
+    readaheadCount = 0;
+    if (!Device::Storage::ReadSectors(sector, count, readaheadData))
+    {
+      return false;
+    }
+    PatchDirty(sector, count, readaheadData[0]);
+    readaheadStart = sector;
+    readaheadCount = count;
+    stats.readaheadFills++;
+    memcpy(dest, readaheadData[0], FF_MAX_SS);
+    return true;
+  }
+
+  slot = Allocate(sector);
+  if (slot == nullptr)
+  {
+    return false;
+  }
+  if (!Device::Storage::ReadSectors(sector, 1, Data(slot)))
+  {
+    slot->valid = false;
+    return false;
+  }
+  memcpy(dest, Data(slot), FF_MAX_SS);
+  return true;
+}
+
+bool Read(uint32_t sector, uint32_t count, void* dest) {
+  xSemaphoreTake(Mutex(), portMAX_DELAY);
+  bool success;
+  if (count == 1)
+  {
+    success = ReadSector(sector, (uint8_t*)dest);
+  }
+  else
+  {
+    success = Device::Storage::ReadSectors(sector, count, dest);
+    if (success)
+    {
+      PatchDirty(sector, count, (uint8_t*)dest);
+    }
+    stats.bypassed++;
+  }
+  nextSequentialSector = sector + count;
+  xSemaphoreGive(Mutex());
+  return success;
+}
+
+bool Write(uint32_t sector, uint32_t count, const void* src) {
+  xSemaphoreTake(Mutex(), portMAX_DELAY);
+  DropReadahead(sector, count);
+  generation++;
+
+  bool success = true;
+  if (count == 1)
+  {
+    Slot* slot = Find(sector);
+    if (slot == nullptr)
+    {
+      slot = Allocate(sector);
+    }
+
+    if (slot == nullptr)
+    {
+      success = false;
+    }
+    else
+    {
+      memcpy(Data(slot), src, FF_MAX_SS);
+      slot->dirty = true;
+      Touch(slot);
+      stats.writesCached++;
+    }
+  }
+  else
+  {
+    success = Device::Storage::WriteSectors(sector, count, src);
+    stats.bypassed++;
+
+    // Keep cached copies in step, they are clean again if the write went through
+    for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+    {
+      if (slots[i].valid && Overlaps(slots[i].sector, sector, count))
+      {
+        memcpy(slotData[i], (const uint8_t*)src + (slots[i].sector - sector) * FF_MAX_SS, FF_MAX_SS);
+        slots[i].dirty = !success;
+      }
+    }
+  }
+  xSemaphoreGive(Mutex());
+  return success;
+}
+
+bool Sync() {
+  xSemaphoreTake(Mutex(), portMAX_DELAY);
+  bool success = true;
+
+  // Write back in sector order so the card sees ascending writes. Each sector is tried once,
+  // a failed one stays dirty so the data isn't lost and the next Sync tries again.
+  uint32_t from = 0;
+  while (true)
+  {
+    Slot* next = nullptr;
+    for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+    {
+      if (slots[i].valid && slots[i].dirty && slots[i].sector >= from && (next == nullptr || slots[i].sector < next->sector))
+      {
+        next = &slots[i];
+      }
+    }
+
+    if (next == nullptr)
+    {
+      break;
+    }
+
+    if (!WriteBack(next))
+    {
+      MLOGE("SectorCache", "Failed to write back sector %lu", next->sector);
+      success = false;
+    }
+
+    if (next->sector == UINT32_MAX)
+    {
+      break;
+    }
+    from = next->sector + 1;
+  }
+  xSemaphoreGive(Mutex());
+  return success;
+}
+
+void Invalidate(uint32_t sector, uint32_t count) {
+  xSemaphoreTake(Mutex(), portMAX_DELAY);
+  DropReadahead(sector, count);
+  for (uint16_t i = 0; i < FS_SECTOR_CACHE_SIZE; i++)
+  {
+    if (slots[i].valid && Overlaps(slots[i].sector, sector, count))
+    {
+      slots[i].valid = false;
+      slots[i].dirty = false;
+    }
+  }
+  xSemaphoreGive(Mutex());
+}
+
+uint32_t Generation() {
+  return generation.load();
+}
+} // namespace MatrixOS::FileSystem::SectorCache
+
+namespace MatrixOS::FileSystem
+{
+SectorCacheStats GetCacheStats() {
+  xSemaphoreTake(SectorCache::Mutex(), portMAX_DELAY);
+  SectorCacheStats snapshot = SectorCache::stats;
+  xSemaphoreGive(SectorCache::Mutex());
+  return snapshot;
+}
+} // namespace MatrixOS::FileSystem
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+#ifndef FS_SECTOR_CACHE_SIZE
+#define FS_SECTOR_CACHE_SIZE 16 // Sectors kept in the LRU cache
+#endif
+
+#ifndef FS_READAHEAD_SECTORS
+#define FS_READAHEAD_SECTORS 8 // Sectors fetched at once when single sector reads are sequential, 1 disables readahead
+#endif
+
+// Sector cache between FatFS and Device::Storage.
+// Single sector accesses (FAT, directory and partial file sectors) are cached in an LRU with write-back until Sync().
+// Sequential single sector reads are served from a multi-sector readahead window instead of filling the LRU.
+// Multi-sector accesses go straight to storage, patched with any dirty cached sectors.
+namespace MatrixOS::FileSystem::SectorCache
+{
+bool Read(uint32_t sector, uint32_t count, void* dest);
+bool Write(uint32_t sector, uint32_t count, const void* src);
+bool Sync(); // Write back all dirty sectors
+void Invalidate(uint32_t sector, uint32_t count); // Drop cached copies of sectors that were written behind the cache's back
+uint32_t Generation(); // Changes on every write through the cache, for readers holding sectors of their own
+} // namespace MatrixOS::FileSystem::SectorCache
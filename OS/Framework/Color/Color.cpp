@@ -1,4 +1,5 @@
 #include "Color.h"
+#include "ColorBlend.h"
 #include <cmath>
 #include <algorithm>
 
@@ -116,11 +117,7 @@ void Color::RgbToHsv(Color rgb, float* h, float* s, float* v) {
     *h += 1.0;
 }
 Color Color::Crossfade(Color color1, Color color2, Fract16 ratio) {
-  uint8_t r = ratio.to8bits();
-  uint8_t newR = (color1.R * (255 - r) + color2.R * r) >> 8;
-  uint8_t newG = (color1.G * (255 - r) + color2.G * r) >> 8;
-  uint8_t newB = (color1.B * (255 - r) + color2.B * r) >> 8;
-  return Color(newR, newG, newB);
+  return ColorBlend::Crossfade(color1, color2, ratio);
 }
 
 // Predefined color constants
@@ -25,6 +25,17 @@ public:
                                                                // as parameter so the output // dynamically change based on the // variable
   Color Gamma() const;
 
+  // R, G, B and W as the bytes of one word, lowest first. Unlike RGB() nothing is scaled, for kernels that blend all channels at once.
+  uint32_t Packed() const {
+    return R | (G << 8) | ((uint32_t)B << 16) | ((uint32_t)W << 24);
+  }
+  void SetPacked(uint32_t word) {
+    R = word;
+    G = word >> 8;
+    B = word >> 16;
+    W = word >> 24;
+  }
+
   static uint8_t Scale8(uint8_t i, uint8_t scale);
 
   // A special type of scale. It ensures value won't be 0 after the scale.
@@ -0,0 +1,27 @@
+#include "ColorBlend.h"
+
+namespace ColorBlend
+{
+void Crossfade(Color* dest, const Color* from, const Color* to, uint16_t count, Fract16 ratio) {
+  uint16_t weight = Weight(ratio);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i].SetPacked(LerpWord(from[i].Packed(), to[i].Packed(), weight));
+  }
+}
+
+void Add(Color* dest, const Color* src, uint16_t count) {
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i].SetPacked(AddWord(dest[i].Packed(), src[i].Packed()));
+  }
+}
+
+void AlphaOver(Color* dest, const Color* src, uint16_t count, uint8_t alpha) {
+  uint16_t weight = alpha + (alpha >> 7);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    dest[i].SetPacked(LerpWord(dest[i].Packed(), src[i].Packed(), weight));
+  }
+}
+} // namespace ColorBlend
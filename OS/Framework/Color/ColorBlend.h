@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Color.h"
+
+// Blend kernels that treat a Color as one packed 32 bit word and work on R, G, B and W at once (SWAR).
+// Even and odd channels are split into two 0x00FF00FF lanes so each channel gets 16 bits of headroom for the multiply.
+// Only blends with one weight for every channel pack well. A per channel a * b needs a multiply per channel either way,
+// so there's no packed kernel for it.
+namespace ColorBlend
+{
+constexpr uint32_t LANE_MASK = 0x00FF00FF;
+
+inline uint32_t Pack(Color color) {
+  return color.Packed();
+}
+
+inline Color Unpack(uint32_t word) {
+  Color color;
+  color.SetPacked(word);
+  return color;
+}
+
+// Fract16 to a 0 - 256 weight, so both ends of the ratio give back exactly one of the inputs
+inline uint16_t Weight(Fract16 ratio) {
+  return ((uint32_t)ratio.value + (ratio.value >> 8)) >> 8;
+}
+
+// a * (256 - weight) + b * weight, per channel
+inline uint32_t LerpWord(uint32_t a, uint32_t b, uint16_t weight) {
+  uint16_t inverse = 256 - weight;
+  uint32_t even = (((a & LANE_MASK) * inverse + (b & LANE_MASK) * weight) >> 8) & LANE_MASK;
+  uint32_t odd = ((((a >> 8) & LANE_MASK) * inverse + ((b >> 8) & LANE_MASK) * weight)) & ~LANE_MASK;
+  return even | odd;
+}
+
+// Saturating per channel add
+inline uint32_t AddWord(uint32_t a, uint32_t b) {
+  uint32_t sum = ((a & 0x7F7F7F7F) + (b & 0x7F7F7F7F)) ^ ((a ^ b) & 0x80808080);
+  uint32_t overflow = ((a & b) | ((a | b) & ~sum)) & 0x80808080;
+  return sum | ((overflow >> 7) * 0xFF);
+}
+
+inline Color Crossfade(Color from, Color to, Fract16 ratio) {
+  return Unpack(LerpWord(Pack(from), Pack(to), Weight(ratio)));
+}
+
+inline Color Add(Color a, Color b) {
+  return Unpack(AddWord(Pack(a), Pack(b)));
+}
+
+inline Color AlphaOver(Color dest, Color src, uint8_t alpha) {
+  return Unpack(LerpWord(Pack(dest), Pack(src), alpha + (alpha >> 7)));
+}
+
+// Buffer kernels, dest may alias either source
+void Crossfade(Color* dest, const Color* from, const Color* to, uint16_t count, Fract16 ratio);
+void Add(Color* dest, const Color* src, uint16_t count);
+void AlphaOver(Color* dest, const Color* src, uint16_t count, uint8_t alpha);
+} // namespace ColorBlend
@@ -21,9 +21,11 @@
 #include "Utilts.h"
 #include "Hash.h"
 #include "ColorEffects.h"
+#include "ColorBlend.h"
 
 // OS Component
 #include "MidiPort.h"
+#include "SysExAssembler.h"
 #include "SavedVar.h"
 
 // Device Component
@@ -1,5 +1,6 @@
 #include "MatrixOS.h"
 #include "MidiPort.h"
+#include <atomic>
 
 static const char* TAG = "MidiPort";
 static uint32_t droppedMidiPackets = 0;
@@ -37,6 +38,8 @@ uint16_t MidiPort::Open(uint16_t id, uint16_t queueSize, uint16_t idRange) {
     return MIDI_PORT_INVALID;
   }
   midiQueue = xQueueCreate(queueSize, sizeof(MidiPacket));
+  this->queueSize = queueSize;
+  this->queueHighWaterMark = 0;
   return this->id;
 }
 
@@ -66,18 +69,49 @@ bool MidiPort::Send(MidiPacket midiPacket, uint16_t targetPort, uint32_t timeout
   return MidiPort::RouteMidiPacket(midiPacket, targetPort, timeoutMs);
 }
 
+bool MidiPort::SendBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t targetPort, uint32_t timeoutMs) {
+  return MidiPort::RouteMidiPackets(midiPackets, count, this->id, targetPort, timeoutMs);
+}
+
 bool MidiPort::Receive(MidiPacket midiPacket, uint32_t timeoutMs) {
+  return ReceiveBatch(&midiPacket, 1, midiPacket.port, timeoutMs);
+}
+
+bool MidiPort::ReceiveBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint32_t timeoutMs) {
   if (midiQueue == nullptr)
     return false;
 
-  if (uxQueueSpacesAvailable(midiQueue) == 0)
+  // Drop oldest packets to make room for the whole burst (FIFO overflow behavior)
+  UBaseType_t spaces = uxQueueSpacesAvailable(midiQueue);
+  MidiPacket discarded;
+  while (spaces < count && xQueueReceive(midiQueue, &discarded, 0) == pdTRUE)
   {
-    // Drop oldest packet to make room for new one (FIFO overflow behavior)
-    MidiPacket discarded;
-    xQueueReceive(midiQueue, &discarded, 0);
+    spaces++;
+    droppedPackets++;
     LogDroppedMidiPacket();
   }
-  xQueueSend(midiQueue, &midiPacket, pdMS_TO_TICKS(timeoutMs));
+
+  for (uint16_t i = 0; i < count; i++)
+  {
+    MidiPacket midiPacket = midiPackets[i];
+    midiPacket.port = sourcePort;
+    if (xQueueSend(midiQueue, &midiPacket, pdMS_TO_TICKS(timeoutMs)) != pdTRUE)
+    {
+      droppedPackets += count - i;
+      break;
+    }
+  }
+
+  UBaseType_t pending = uxQueueMessagesWaiting(midiQueue);
+  if (pending > queueHighWaterMark)
+  {
+    queueHighWaterMark = pending;
+  }
+
+  if (receiveNotifyTask != nullptr)
+  {
+    xTaskNotifyGive(receiveNotifyTask);
+  }
   return true;
 }
 
@@ -99,39 +133,146 @@ MidiPort::~MidiPort() {
   Close();
 }
 
+// Routing never walks midiPortMap. Every open/close builds an immutable route table that is swapped in atomically.
+// Routers announce themselves in one of two epoch counters, a replaced table is freed once both epochs have drained.
+struct MidiRoute {
+  uint16_t id;
+  MidiPort* port;
+};
+
+struct MidiClassRoute {
+  MidiRoute first;
+  MidiRoute second; // Used when the first port of the class is the source
+};
+
+struct MidiPortClass {
+  uint8_t firstIndex;        // Lowest id % 0x100 open in this class
+  vector<MidiPort*> ports;   // Indexed by id % 0x100 - firstIndex, nullptr for gaps
+};
+
+struct MidiRouteTable {
+  uint32_t version = 0;
+  vector<MidiRoute> allPorts;          // Every open port by ascending id, for MIDI_PORT_ALL
+  vector<MidiClassRoute> classRoutes;  // First ports of each class up to MIDI_PORT_DEVICE_CUSTOM, for MIDI_PORT_EACH_CLASS
+  uint8_t classIndex[0x100];           // id / 0x100 to index in portClasses, 0xFF if the class has no open port
+  vector<MidiPortClass> portClasses;
+};
+
+static std::atomic<MidiRouteTable*> routeTable{nullptr};
+static std::atomic<uint32_t> routeEpoch{0};
+static std::atomic<uint32_t> activeRouters[2];
+static std::atomic<uint32_t> unroutablePackets{0};
+
+static SemaphoreHandle_t RegistryMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Wait until no router can still be holding a table that was replaced before this call
+static void WaitForRouters() {
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    uint32_t epoch = routeEpoch.fetch_add(1);
+    while (activeRouters[epoch & 1].load() != 0)
+    {
+      vTaskDelay(1);
+    }
+  }
+}
+
+void MidiPort::RebuildRouteTable() {
+  MidiRouteTable* table = new MidiRouteTable();
+  MidiRouteTable* oldTable = routeTable.load();
+  table->version = oldTable ? oldTable->version + 1 : 1;
+  memset(table->classIndex, 0xFF, sizeof(table->classIndex));
+  table->allPorts.reserve(midiPortMap.size());
+
+  for (auto& [portId, port] : midiPortMap)
+  {
+    table->allPorts.push_back({portId, port});
+
+    uint8_t portClass = portId / 0x100;
+    uint8_t index = portId % 0x100;
+    if (table->classIndex[portClass] == 0xFF)
+    {
+      table->classIndex[portClass] = table->portClasses.size();
+      table->portClasses.push_back({index, {}});
+
+      if (portId < MIDI_PORT_DEVICE_CUSTOM + 0x100)
+      {
+        table->classRoutes.push_back({{portId, port}, {MIDI_PORT_INVALID, nullptr}});
+      }
+    }
+    else if (portId < MIDI_PORT_DEVICE_CUSTOM + 0x100 && table->classRoutes.back().second.port == nullptr)
+    {
+      table->classRoutes.back().second = {portId, port};
+    }
+
+    MidiPortClass& routeClass = table->portClasses[table->classIndex[portClass]];
+    routeClass.ports.resize(index - routeClass.firstIndex + 1, nullptr);
+    routeClass.ports[index - routeClass.firstIndex] = port;
+  }
+
+  routeTable.store(table);
+  if (oldTable != nullptr)
+  {
+    WaitForRouters();
+    delete oldTable;
+  }
+}
+
 bool MidiPort::OpenMidiPort(uint16_t portId, MidiPort* midiPort) {
   if (portId < 0x100 || midiPort == nullptr)
     return false;
 
+  xSemaphoreTake(RegistryMutex(), portMAX_DELAY);
+  bool opened = false;
   if (midiPortMap.find(portId) == midiPortMap.end())
   {
     midiPortMap[portId] = midiPort;
-    return true;
+    RebuildRouteTable();
+    opened = true;
   }
-  return false;
+  xSemaphoreGive(RegistryMutex());
+  return opened;
 }
 
 void MidiPort::CloseMidiPort(uint16_t portId) {
-  midiPortMap.erase(portId);
+  xSemaphoreTake(RegistryMutex(), portMAX_DELAY);
+  if (midiPortMap.erase(portId) > 0)
+  {
+    RebuildRouteTable(); // Returns after in flight routes are done with the port
+  }
+  xSemaphoreGive(RegistryMutex());
 }
 
-bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeoutMs) {
-  uint16_t sourcePort = midiPacket.port; // Where the packet came from
+static bool Deliver(MidiPort* port, const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint16_t timeoutMs) {
+  if (port->ReceiveBatch(midiPackets, count, sourcePort, timeoutMs))
+  {
+    port->routedPackets += count;
+    return true;
+  }
+  port->droppedPackets += count;
+  return false;
+}
+
+static bool Route(const MidiRouteTable* table, const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint16_t targetPort,
+                  uint16_t timeoutMs) {
+  if (table == nullptr)
+  {
+    return false;
+  }
 
   if (targetPort == MIDI_PORT_EACH_CLASS)
   {
-    uint16_t targetClass = MIDI_PORT_USB;
     bool send = false;
-    for (std::map<uint16_t, MidiPort*>::iterator port = midiPortMap.begin(); port != midiPortMap.end(); ++port)
+    for (const MidiClassRoute& classRoute : table->classRoutes)
     {
-      if (port->first >= MIDI_PORT_DEVICE_CUSTOM + 0x100)
+      // Don't send back to source port, use the next port of the class instead
+      const MidiRoute& route = classRoute.first.id != sourcePort ? classRoute.first : classRoute.second;
+      if (route.port != nullptr)
       {
-        return send;
-      }
-      if (port->first >= targetClass && port->first != sourcePort)
-      {
-        send |= port->second->Receive(midiPacket, timeoutMs);
-        targetClass = (port->first / 0x100 + 1) * 0x100;
+        send |= Deliver(route.port, midiPackets, count, sourcePort, timeoutMs);
       }
     }
     return send;
@@ -139,27 +280,71 @@ bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint1
   else if (targetPort == MIDI_PORT_ALL)
   {
     bool send = false;
-    for (std::map<uint16_t, MidiPort*>::iterator port = midiPortMap.begin(); port != midiPortMap.end(); ++port)
+    for (const MidiRoute& route : table->allPorts)
     {
       // Don't send back to source port
-      if (port->first != sourcePort)
+      if (route.id != sourcePort)
       {
-        send |= port->second->Receive(midiPacket, timeoutMs);
+        send |= Deliver(route.port, midiPackets, count, sourcePort, timeoutMs);
       }
     }
     return send;
   }
   else
   {
-    std::map<uint16_t, MidiPort*>::iterator port = midiPortMap.find(targetPort);
-    if (port != midiPortMap.end())
+    uint8_t classIndex = table->classIndex[targetPort / 0x100];
+    if (classIndex != 0xFF && targetPort != sourcePort)
     {
-      // Don't send back to source port
-      if (port->first != sourcePort)
+      const MidiPortClass& routeClass = table->portClasses[classIndex];
+      uint8_t index = targetPort % 0x100;
+      size_t slot = (size_t)(index - routeClass.firstIndex); // Wraps around when index is below firstIndex
+      if (index >= routeClass.firstIndex && slot < routeClass.ports.size() && routeClass.ports[slot] != nullptr)
       {
-        return port->second->Receive(midiPacket, timeoutMs);
+        return Deliver(routeClass.ports[slot], midiPackets, count, sourcePort, timeoutMs);
       }
     }
   }
+  unroutablePackets += count;
   return false;
 }
+
+bool MidiPort::RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeoutMs) {
+  return RouteMidiPackets(&midiPacket, 1, midiPacket.port, targetPort, timeoutMs);
+}
+
+// Routes a burst with a single table lookup, each target port queues it back to back and wakes its consumer once
+bool MidiPort::RouteMidiPackets(const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint16_t targetPort, uint16_t timeoutMs) {
+  if (count == 0)
+  {
+    return true;
+  }
+  uint32_t epoch = routeEpoch.load();
+  activeRouters[epoch & 1]++;
+  bool send = Route(routeTable.load(), midiPackets, count, sourcePort, targetPort, timeoutMs);
+  activeRouters[epoch & 1]--;
+  return send;
+}
+
+namespace MatrixOS::MIDI
+{
+RouteStats GetRouteStats() {
+  RouteStats stats;
+  uint32_t epoch = routeEpoch.load();
+  activeRouters[epoch & 1]++;
+  const MidiRouteTable* table = routeTable.load();
+  if (table != nullptr)
+  {
+    stats.tableVersion = table->version;
+    stats.ports.reserve(table->allPorts.size());
+    for (const MidiRoute& route : table->allPorts)
+    {
+      MidiPort* port = route.port;
+      uint16_t pending = port->midiQueue ? uxQueueMessagesWaiting(port->midiQueue) : 0;
+      stats.ports.push_back({route.id, port->routedPackets, port->droppedPackets, port->queueSize, pending, port->queueHighWaterMark});
+    }
+  }
+  activeRouters[epoch & 1]--;
+  stats.unroutablePackets = unroutablePackets.load();
+  return stats;
+}
+} // namespace MatrixOS::MIDI
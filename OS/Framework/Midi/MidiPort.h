@@ -2,23 +2,35 @@
 
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "task.h"
 #include <map>
 
 class MidiPort {
 private:
-  static std::map<uint16_t, MidiPort*> midiPortMap;
+  static std::map<uint16_t, MidiPort*> midiPortMap; // Port registry, routing reads the route table built from it
 
 public:
   string name;
   uint16_t id = MIDI_PORT_INVALID;
   QueueHandle_t midiQueue;
 
+  TaskHandle_t receiveNotifyTask = nullptr; // Notified once per received packet or burst, so the consumer can drain a burst at once
+
+  // Route counters for packets routed to this port
+  uint32_t routedPackets = 0;
+  uint32_t droppedPackets = 0;
+
+  uint16_t queueSize = 0;
+  uint16_t queueHighWaterMark = 0; // Most packets waiting at once
+
   uint16_t Open(uint16_t id, uint16_t queueSize = 64, uint16_t idRange = 1);
   void Close();
   void SetName(string name);
   bool Get(MidiPacket* midiPacketDest, uint32_t timeoutMs = 0);
   bool Send(MidiPacket midiPacket, uint16_t targetPort = MIDI_PORT_OS, uint32_t timeoutMs = 0);
+  bool SendBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t targetPort = MIDI_PORT_OS, uint32_t timeoutMs = 0);
   bool Receive(MidiPacket midiPacket, uint32_t timeoutMs = 0);
+  bool ReceiveBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint32_t timeoutMs = 0);
 
   MidiPort();
   MidiPort(string name, uint16_t id, uint16_t queueSize = 64);
@@ -29,4 +41,8 @@ public:
   static bool OpenMidiPort(uint16_t portId, MidiPort* midiPort);
   static void CloseMidiPort(uint16_t portId);
   static bool RouteMidiPacket(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeoutMs);
+  static bool RouteMidiPackets(const MidiPacket* midiPackets, uint16_t count, uint16_t sourcePort, uint16_t targetPort, uint16_t timeoutMs);
+
+private:
+  static void RebuildRouteTable();
 };
@@ -0,0 +1,238 @@
+#include "MatrixOS.h"
+#include "SysExAssembler.h"
+
+SysExAssembler::SysExAssembler(uint32_t timeoutMs) {
+  this->timeoutMs = timeoutMs;
+  mutex = xSemaphoreCreateMutex();
+  handlers.reserve(SYSEX_MAX_HANDLERS);
+  for (uint8_t i = 0; i < SYSEX_POOL_SIZE; i++)
+  {
+    sessions[i].state = SESSION_FREE;
+    sessions[i].buffer = pool[i];
+  }
+}
+
+bool SysExAssembler::AddHandler(const uint8_t* prefix, uint8_t prefixLength, SysExHandler handler, void* context, bool system) {
+  if (prefix == nullptr || prefixLength == 0 || prefixLength > SYSEX_MAX_PREFIX_LENGTH)
+  {
+    return false;
+  }
+
+  Handler entry;
+  memcpy(entry.prefix, prefix, prefixLength);
+  entry.prefixLength = prefixLength;
+  entry.callback = handler;
+  entry.context = context;
+  entry.system = system;
+
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  bool added = handlers.size() < SYSEX_MAX_HANDLERS;
+  if (added)
+  {
+    // Application handlers go first so they can claim a more specific prefix than a system handler
+    handlers.insert(system ? handlers.end() : handlers.begin(), entry);
+  }
+  xSemaphoreGive(mutex);
+  return added;
+}
+
+void SysExAssembler::RemoveHandler(SysExHandler handler, void* context) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (auto it = handlers.begin(); it != handlers.end();)
+  {
+    it = (it->callback == handler && it->context == context) ? handlers.erase(it) : it + 1;
+  }
+  for (Session& session : sessions)
+  {
+    if (session.state == SESSION_STREAMING && session.handler.callback == handler && session.handler.context == context)
+    {
+      session.state = SESSION_SKIPPING;
+    }
+  }
+  xSemaphoreGive(mutex);
+}
+
+void SysExAssembler::RemoveAppHandlers() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  for (auto it = handlers.begin(); it != handlers.end();)
+  {
+    it = it->system ? it + 1 : handlers.erase(it);
+  }
+  for (Session& session : sessions)
+  {
+    if ((session.state == SESSION_STREAMING || session.state == SESSION_FORWARDING) && !session.handler.system)
+    {
+      session.state = SESSION_SKIPPING;
+    }
+  }
+  xSemaphoreGive(mutex);
+}
+
+SysExAssembler::Session* SysExAssembler::Find(uint16_t port) {
+  for (Session& session : sessions)
+  {
+    if (session.state != SESSION_FREE && session.port == port)
+    {
+      return &session;
+    }
+  }
+  return nullptr;
+}
+
+SysExAssembler::Session* SysExAssembler::Allocate(uint16_t port) {
+  for (Session& session : sessions)
+  {
+    if (session.state == SESSION_FREE)
+    {
+      session.port = port;
+      session.state = SESSION_MATCHING;
+      session.started = false;
+      session.length = 0;
+      stats.activeSessions++;
+      stats.peakSessions = std::max(stats.peakSessions, stats.activeSessions);
+      return &session;
+    }
+  }
+  return nullptr;
+}
+
+void SysExAssembler::Release(Session* session) {
+  session->state = SESSION_FREE;
+  session->length = 0;
+  stats.activeSessions--;
+}
+
+void SysExAssembler::Abort(Session* session) {
+  if (session->state == SESSION_STREAMING && session->started)
+  {
+    session->handler.callback(session->port, nullptr, 0, SYSEX_CHUNK_ABORT, session->handler.context);
+  }
+  Release(session);
+}
+
+void SysExAssembler::Expire(uint32_t nowMs) {
+  for (Session& session : sessions)
+  {
+    if (session.state != SESSION_FREE && nowMs - session.lastActivityMs > timeoutMs)
+    {
+      stats.timeouts++;
+      Abort(&session);
+    }
+  }
+}
+
+// Pick the first handler whose prefix matches. Waits for more bytes while an earlier handler could still match.
+void SysExAssembler::Match(Session* session, bool end) {
+  for (const Handler& handler : handlers)
+  {
+    uint16_t compareLength = std::min<uint16_t>(handler.prefixLength, session->length);
+    if (memcmp(handler.prefix, session->buffer, compareLength) != 0)
+    {
+      continue;
+    }
+    if (session->length < handler.prefixLength)
+    {
+      if (end)
+      {
+        continue;
+      }
+      return;
+    }
+
+    session->handler = handler;
+    stats.messages++;
+    if (handler.callback == nullptr)
+    {
+      session->state = SESSION_FORWARDING;
+      return;
+    }
+    session->state = SESSION_STREAMING;
+    if (end)
+    {
+      Deliver(session, true);
+    }
+    return;
+  }
+  stats.unmatched++;
+  session->state = SESSION_SKIPPING;
+}
+
+void SysExAssembler::Deliver(Session* session, bool end) {
+  uint8_t flags = (session->started ? 0 : SYSEX_CHUNK_START) | (end ? SYSEX_CHUNK_END : 0);
+  session->started = true;
+  stats.chunks++;
+  if (!session->handler.callback(session->port, session->buffer, session->length, flags, session->handler.context))
+  {
+    session->state = SESSION_SKIPPING;
+  }
+  session->length = 0;
+}
+
+SysExAssembler::Result SysExAssembler::Receive(const MidiPacket& packet, uint32_t nowMs) {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  Expire(nowMs);
+
+  Session* session = Find(packet.port);
+  if (packet.SysExStart())
+  {
+    if (session != nullptr)
+    {
+      stats.aborted++;
+      Abort(session);
+    }
+    session = Allocate(packet.port);
+    if (session == nullptr)
+    {
+      stats.poolExhausted++;
+    }
+  }
+
+  if (session == nullptr) // Nothing to add this to, the start was dropped or timed out
+  {
+    xSemaphoreGive(mutex);
+    return SYSEX_CONSUMED;
+  }
+
+  session->lastActivityMs = nowMs;
+  bool end = packet.status == SysExEnd;
+  Result result = SYSEX_CONSUMED;
+  if (session->state == SESSION_FORWARDING)
+  {
+    result = SYSEX_FORWARD;
+  }
+  else if (session->state == SESSION_MATCHING || session->state == SESSION_STREAMING)
+  {
+    uint8_t packetLength = packet.Length();
+    for (uint8_t i = 0; i < packetLength && session->state != SESSION_SKIPPING; i++)
+    {
+      if (session->length == SYSEX_CHUNK_SIZE)
+      {
+        Deliver(session, false); // Only streaming sessions fill up, matching is decided within the prefix length
+      }
+      session->buffer[session->length++] = packet.data[i];
+    }
+
+    if (session->state == SESSION_MATCHING)
+    {
+      Match(session, end);
+    }
+    else if (session->state == SESSION_STREAMING && end)
+    {
+      Deliver(session, true);
+    }
+  }
+
+  if (end)
+  {
+    Release(session);
+  }
+  xSemaphoreGive(mutex);
+  return result;
+}
+
+SysExStats SysExAssembler::GetStats() {
+  xSemaphoreTake(mutex, portMAX_DELAY);
+  SysExStats snapshot = stats;
+  xSemaphoreGive(mutex);
+  return snapshot;
+}
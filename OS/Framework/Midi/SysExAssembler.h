@@ -0,0 +1,86 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "MidiPacket.h"
+#include <vector>
+
+#define SYSEX_POOL_SIZE 4     // SysEx messages that can be in flight at once, across all ports
+#define SYSEX_CHUNK_SIZE 1024 // Bytes buffered per message before they are handed to its handler
+#define SYSEX_MAX_HANDLERS 8
+#define SYSEX_MAX_PREFIX_LENGTH 8
+
+enum SysExChunkFlags : uint8_t {
+  SYSEX_CHUNK_START = 0x01, // Chunk begins the message, F0 included
+  SYSEX_CHUNK_END = 0x02,   // Chunk ends the message, F7 included
+  SYSEX_CHUNK_ABORT = 0x04, // Message was cut off (timeout or a new message on the port), no data
+};
+
+// Gets a SysEx message in order, one chunk at a time as it arrives. Return false to skip the rest of the message.
+typedef bool (*SysExHandler)(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
+
+struct SysExStats {
+  uint32_t messages = 0;      // Messages that reached a handler
+  uint32_t chunks = 0;        // Chunks handed to handlers
+  uint32_t unmatched = 0;     // Messages no handler asked for
+  uint32_t poolExhausted = 0; // Messages dropped because every pool buffer was in use
+  uint32_t timeouts = 0;      // Messages dropped after going quiet
+  uint32_t aborted = 0;       // Messages cut off by a new message on the same port
+  uint8_t activeSessions = 0;
+  uint8_t peakSessions = 0;
+};
+
+// Reassembles SysEx per port from a preallocated buffer pool and streams it to the handler registered for its prefix.
+// A handler with a nullptr callback forwards the packets after its prefix instead, so the caller can pass them on.
+class SysExAssembler {
+public:
+  enum Result : uint8_t {
+    SYSEX_CONSUMED, // Packet was taken or dropped
+    SYSEX_FORWARD,  // Packet belongs to a forwarding handler
+  };
+
+  SysExAssembler(uint32_t timeoutMs);
+
+  bool AddHandler(const uint8_t* prefix, uint8_t prefixLength, SysExHandler handler, void* context, bool system = false);
+  void RemoveHandler(SysExHandler handler, void* context);
+  void RemoveAppHandlers();
+
+  Result Receive(const MidiPacket& packet, uint32_t nowMs);
+  SysExStats GetStats();
+
+private:
+  struct Handler {
+    uint8_t prefix[SYSEX_MAX_PREFIX_LENGTH];
+    uint8_t prefixLength;
+    SysExHandler callback;
+    void* context;
+    bool system;
+  };
+
+  enum SessionState : uint8_t { SESSION_FREE, SESSION_MATCHING, SESSION_STREAMING, SESSION_FORWARDING, SESSION_SKIPPING };
+
+  struct Session {
+    uint16_t port;
+    SessionState state;
+    bool started; // First chunk was handed over
+    uint16_t length;
+    uint32_t lastActivityMs;
+    Handler handler;
+    uint8_t* buffer;
+  };
+
+  uint32_t timeoutMs;
+  SemaphoreHandle_t mutex;
+  std::vector<Handler> handlers;
+  Session sessions[SYSEX_POOL_SIZE];
+  uint8_t pool[SYSEX_POOL_SIZE][SYSEX_CHUNK_SIZE];
+  SysExStats stats;
+
+  Session* Find(uint16_t port);
+  Session* Allocate(uint16_t port);
+  void Release(Session* session);
+  void Abort(Session* session);
+  void Match(Session* session, bool end);
+  void Deliver(Session* session, bool end);
+  void Expire(uint32_t nowMs);
+};
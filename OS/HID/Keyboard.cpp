@@ -2,6 +2,7 @@
 #include "USB.h"
 #include "tusb.h"
 #include "task.h"
+#include "../System/Telemetry.h"
 
 #define NKRO_KEY_COUNT (8 * 13)
 
@@ -128,6 +129,7 @@ static void EnsureSendTask() {
   if (_sendTaskHandle == nullptr)
   {
     _sendTaskHandle = xTaskCreateStatic(SendTask, "kbd_send", configMINIMAL_STACK_SIZE, nullptr, 2, _sendTaskStack, &_sendTaskBuffer);
+    Telemetry::WatchTask(_sendTaskHandle, "kbd_send");
   }
 }
 
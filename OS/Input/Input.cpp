@@ -1,47 +1,168 @@
 #include "MatrixOS.h"
+#include <atomic>
 
 static const char* TAG = "Input";
-static uint32_t droppedInputEvents = 0;
 
-static void LogDroppedInputEvent() {
-  droppedInputEvents++;
-}
+static_assert((INPUT_EVENT_QUEUE_SIZE & (INPUT_EVENT_QUEUE_SIZE - 1)) == 0, "INPUT_EVENT_QUEUE_SIZE must be a power of two");
+static_assert(INPUT_EVENT_AFTERTOUCH_RESERVE < INPUT_EVENT_QUEUE_SIZE, "Aftertouch reserve must leave room for aftertouch");
 
 namespace MatrixOS::Input
 {
+// Single producer (device scan timers) / single consumer (app task) ring.
+// The sequence counter is a per-slot seqlock so the producer can rewrite a pending
+// aftertouch event in place while the consumer may be copying it.
+struct InputEventSlot {
+  std::atomic<uint32_t> sequence{0};
+  InputEvent event;
+};
+
+static constexpr uint32_t INPUT_EVENT_QUEUE_MASK = INPUT_EVENT_QUEUE_SIZE - 1;
+
+static InputEventSlot eventSlots[INPUT_EVENT_QUEUE_SIZE];
+static std::atomic<uint32_t> eventHead{0}; // Only written by the producer
+static std::atomic<uint32_t> eventTail{0}; // Only written by the consumer
+static InputQueueStats queueStats;
+
+static bool IsAftertouch(const InputEvent& event) {
+  return event.inputClass == InputClass::Keypad && event.keypad.state == KeypadState::Aftertouch;
+}
 
-QueueHandle_t inputEventQueue = nullptr;
-
-void Init() {
-  if (!inputEventQueue)
+// Replace the newest pending event of the same input if it is also aftertouch.
+// Anything else (Press, Release...) pending for that input pins the order and forces a new entry.
+// The slot at tail is never rewritten, the consumer may have copied it already without having advanced tail yet.
+static bool CoalesceAftertouch(const InputEvent& event, uint32_t head, uint32_t tail) {
+  for (uint32_t index = head; index != tail;)
   {
-    inputEventQueue = xQueueCreate(INPUT_EVENT_QUEUE_SIZE, sizeof(InputEvent));
+    index--;
+    InputEventSlot& slot = eventSlots[index & INPUT_EVENT_QUEUE_MASK];
+    if (slot.event.id != event.id)
+    {
+      continue;
+    }
+
+    if (!IsAftertouch(slot.event) || index == tail)
+    {
+      return false;
+    }
+
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event = event;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+
+    // The consumer may have reached this slot since tail was read. Unless it is still behind it, queue the update as
+    // well. Pairs with the fence in Pop: either tail is seen here, or Pop sees the rewrite through the sequence.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return (int32_t)(index - eventTail.load(std::memory_order_relaxed)) > 0;
   }
-  else
+  return false;
+}
+
+static bool Pop(InputEvent* event) {
+  uint32_t tail = eventTail.load(std::memory_order_relaxed);
+  if (tail == eventHead.load(std::memory_order_acquire))
   {
-    xQueueReset(inputEventQueue);
+    return false;
   }
+
+  InputEventSlot& slot = eventSlots[tail & INPUT_EVENT_QUEUE_MASK];
+  std::atomic_thread_fence(std::memory_order_seq_cst); // Orders the last tail store before reading this slot
+  uint32_t sequenceBefore;
+  uint32_t sequenceAfter;
+  do
+  {
+    sequenceBefore = slot.sequence.load(std::memory_order_acquire);
+    *event = slot.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    sequenceAfter = slot.sequence.load(std::memory_order_relaxed);
+  } while ((sequenceBefore & 1) || sequenceBefore != sequenceAfter);
+
+  eventTail.store(tail + 1, std::memory_order_release);
+  return true;
+}
+
+void Init() {
+  ClearInputBuffer();
   MLOGI(TAG, "Input system initialized");
 }
 
 bool NewEvent(const InputEvent& event) {
-  if (uxQueueSpacesAvailable(inputEventQueue) == 0)
+  uint32_t head = eventHead.load(std::memory_order_relaxed);
+  uint32_t tail = eventTail.load(std::memory_order_acquire);
+  bool aftertouch = IsAftertouch(event);
+
+  if (aftertouch && CoalesceAftertouch(event, head, tail))
+  {
+    queueStats.coalescedAftertouch++;
+    MatrixOS::SYS::WakeApp();
+    return false;
+  }
+
+  // Aftertouch may not take the last few slots so state transitions always have room.
+  uint32_t pending = head - tail;
+  uint32_t limit = aftertouch ? INPUT_EVENT_QUEUE_SIZE - INPUT_EVENT_AFTERTOUCH_RESERVE : INPUT_EVENT_QUEUE_SIZE;
+  if (pending >= limit)
   {
-    // Drop oldest event when queue is full
-    InputEvent dropped;
-    xQueueReceive(inputEventQueue, &dropped, 0);
-    LogDroppedInputEvent();
+    if (aftertouch)
+    {
+      queueStats.droppedAftertouch++;
+    }
+    else
+    {
+      queueStats.droppedEvents++;
+    }
+    return true;
   }
-  xQueueSend(inputEventQueue, &event, 0);
-  return uxQueueSpacesAvailable(inputEventQueue) == 0;
+
+  eventSlots[head & INPUT_EVENT_QUEUE_MASK].event = event;
+  eventHead.store(head + 1, std::memory_order_release);
+
+  pending++;
+  if (pending > queueStats.highWaterMark)
+  {
+    queueStats.highWaterMark = pending;
+  }
+
+  MatrixOS::SYS::WakeApp();
+  return pending == INPUT_EVENT_QUEUE_SIZE;
 }
 
 bool Get(InputEvent* event, uint32_t timeoutMs) {
-  if (!inputEventQueue)
+  if (Pop(event))
+  {
+    return true;
+  }
+
+  if (timeoutMs == 0)
   {
     return false;
   }
-  return xQueueReceive(inputEventQueue, event, pdMS_TO_TICKS(timeoutMs)) == pdTRUE;
+
+  // NewEvent wakes the app task, so block on that instead of polling.
+  uint64_t deadline = MatrixOS::SYS::Millis() + timeoutMs;
+  while (true)
+  {
+    uint64_t now = MatrixOS::SYS::Millis();
+    if (now >= deadline)
+    {
+      return false;
+    }
+
+    MatrixOS::SYS::WaitForWake(timeoutMs == UINT32_MAX ? UINT32_MAX : (uint32_t)(deadline - now));
+
+    if (Pop(event))
+    {
+      return true;
+    }
+  }
+}
+
+InputQueueStats GetQueueStats() {
+  InputQueueStats stats = queueStats;
+  stats.capacity = INPUT_EVENT_QUEUE_SIZE;
+  stats.pending = eventHead.load(std::memory_order_acquire) - eventTail.load(std::memory_order_acquire);
+  return stats;
 }
 
 bool GetState(InputId id, InputSnapshot* snapshot) {
@@ -119,11 +240,9 @@ bool GetPosition(InputId id, Point* xy) {
   return Device::Input::GetPosition(id.clusterId, id.memberId, xy);
 }
 
+// Consumer side operation: drops everything published so far.
 void ClearInputBuffer() {
-  if (inputEventQueue)
-  {
-    xQueueReset(inputEventQueue);
-  }
+  eventTail.store(eventHead.load(std::memory_order_acquire), std::memory_order_release);
 }
 
 bool GetKeypadCapabilities(uint8_t clusterId, KeypadCapabilities* caps) {
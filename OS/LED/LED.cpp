@@ -1,5 +1,6 @@
 #include "MatrixOS.h"
 #include <algorithm>
+#include <atomic>
 
 namespace MatrixOS::LED
 {
@@ -19,7 +20,19 @@ vector<Color*> frameBuffers; // 0 is the active layer
 vector<float> ledBrightnessMultiplier;
 vector<uint8_t> ledPartitionBrightness;
 
-bool needUpdate = false;
+// Bitmask of partitions whose content may differ from what the driver last received.
+// Written from app tasks and consumed by the timer callback, hence atomic.
+std::atomic<uint32_t> dirtyPartitions{0};
+const uint32_t ALL_PARTITIONS = UINT32_MAX;
+
+// Copy of the last frame handed to Device::LED::Update so redundant uploads can be skipped.
+Color* transmittedFrame = nullptr;
+vector<uint8_t> transmittedBrightness;
+Direction transmittedRotation = TOP;
+bool transmittedFrameValid = false;
+
+vector<uint8_t> ledPartitionLookup; // LED index -> partition index
+FrameStats frameStats;
 
 bool crossfadeActive = false;
 uint32_t crossfadeStartTime = 0;
@@ -28,7 +41,27 @@ Color* crossfadeSourceBuffer = nullptr;
 bool crossfadeDestroySourceBuffer = false;
 Color* crossfadeBuffer = nullptr;
 
+// Layer and crossfade buffers are handed out from one arena reserved at Init, so transitions never touch the heap.
+// Every layer up to MAX_LED_LAYERS plus the crossfade output, its source copy and the replacement output while a fade restarts.
+const uint8_t LED_CROSSFADE_BUFFERS = 3;
+const uint8_t LED_ARENA_SLOTS = MAX_LED_LAYERS + 1 + LED_CROSSFADE_BUFFERS;
+Color* arena = nullptr;
+uint8_t arenaFreeSlots[LED_ARENA_SLOTS]; // Stack of free slot indices
+uint8_t arenaFreeCount = 0;
+LayerArenaStats arenaStats;
+// Guards the free list and stats. Suspending the scheduler only stops this core, the timer callback can run on the other one.
+// Never held while taking another lock, so it nests inside activeBufferSemaphore.
+SemaphoreHandle_t arenaMutex;
+
 void RenderCrossfade();
+static void ReleaseLayerBuffer(Color* buffer);
+
+// Canvas XY to LED index table. Covers the grid plus the ring around it (underglow lives at -1 and size),
+// rebuilt whenever the device is rotated.
+vector<uint16_t> xyTable;
+int16_t xyTableWidth = 0;
+int16_t xyTableHeight = 0;
+Direction xyTableRotation = TOP;
 
 // Crossfade runtime state is shared between the LED timer callback and foreground
 // API calls such as Fade(), Reset(), and UI/layer transitions. Cleanup must
@@ -41,29 +74,101 @@ static void ClearCrossfadeStateLocked() {
 
   if (crossfadeDestroySourceBuffer && crossfadeSourceBuffer != nullptr)
   {
-    vPortFree(crossfadeSourceBuffer);
+    ReleaseLayerBuffer(crossfadeSourceBuffer);
   }
   crossfadeSourceBuffer = nullptr;
   crossfadeDestroySourceBuffer = false;
 
   if (crossfadeBuffer != nullptr)
   {
-    vPortFree(crossfadeBuffer);
+    ReleaseLayerBuffer(crossfadeBuffer);
     crossfadeBuffer = nullptr;
   }
 }
 
-static Color* AllocateLayerBuffer(const char* errorMessage) {
-  Color* buffer = (Color*)pvPortMalloc(ledCount * sizeof(Color));
+static inline void MarkDirty(uint32_t partitionMask = ALL_PARTITIONS) {
+  dirtyPartitions.fetch_or(partitionMask, std::memory_order_relaxed);
+}
+
+static inline void MarkIndexDirty(uint16_t index) {
+  MarkDirty(1UL << ledPartitionLookup[index]);
+}
+
+// Returns a cleared buffer, or nullptr once the arena is used up
+static Color* AcquireLayerBuffer(const char* purpose) {
+  Color* buffer = nullptr;
+  xSemaphoreTake(arenaMutex, portMAX_DELAY);
+  if (arenaFreeCount > 0)
+  {
+    buffer = arena + arenaFreeSlots[--arenaFreeCount] * ledCount;
+    arenaStats.inUse++;
+    arenaStats.highWaterMark = std::max(arenaStats.highWaterMark, arenaStats.inUse);
+  }
+  else
+  {
+    arenaStats.exhausted++;
+  }
+  xSemaphoreGive(arenaMutex);
+
   if (buffer == nullptr)
   {
-    MatrixOS::SYS::ErrorHandler(errorMessage);
+    MLOGW("LED", "No free LED buffer for %s", purpose);
     return nullptr;
   }
   std::fill_n(buffer, ledCount, Color(0));
   return buffer;
 }
 
+static void ReleaseLayerBuffer(Color* buffer) {
+  xSemaphoreTake(arenaMutex, portMAX_DELAY);
+  arenaFreeSlots[arenaFreeCount++] = (buffer - arena) / ledCount;
+  arenaStats.inUse--;
+  xSemaphoreGive(arenaMutex);
+}
+
+// Diff the dirty partitions against the last transmitted frame and only hand the frame to the driver if
+// something visible changed. The LED chain is a single strip, so any change still uploads the full frame.
+IRAM_ATTR static void SubmitFrame(uint32_t dirty) {
+  Color* frame = crossfadeActive ? crossfadeBuffer : frameBuffers[0];
+
+  // Rotation is applied inside the driver, so the buffer alone does not describe the output.
+  Direction rotation = Device::GetRotation();
+  bool forceAll = !transmittedFrameValid || rotation != transmittedRotation;
+
+  uint8_t changedPartitions = 0;
+  for (uint8_t i = 0; i < Device::LED::partitions.size(); i++)
+  {
+    const LEDPartition& partition = Device::LED::partitions[i];
+    bool brightnessChanged = transmittedBrightness[i] != ledPartitionBrightness[i];
+
+    if (!forceAll && !brightnessChanged)
+    {
+      if ((dirty & (1UL << i)) == 0 ||
+          memcmp(frame + partition.start, transmittedFrame + partition.start, partition.size * sizeof(Color)) == 0)
+      {
+        frameStats.partitionsSkipped++;
+        continue;
+      }
+    }
+
+    memcpy(transmittedFrame + partition.start, frame + partition.start, partition.size * sizeof(Color));
+    transmittedBrightness[i] = ledPartitionBrightness[i];
+    frameStats.partitionsSubmitted++;
+    changedPartitions++;
+  }
+
+  if (changedPartitions == 0)
+  {
+    frameStats.framesSkipped++;
+    return;
+  }
+
+  transmittedRotation = rotation;
+  transmittedFrameValid = true;
+  frameStats.framesSubmitted++;
+  Device::LED::Update(frame, ledPartitionBrightness);
+}
+
 IRAM_ATTR void LEDTimerCallback(TimerHandle_t xTimer) {
   xSemaphoreTake(activeBufferSemaphore, portMAX_DELAY);
   if (crossfadeActive)
@@ -71,13 +176,10 @@ IRAM_ATTR void LEDTimerCallback(TimerHandle_t xTimer) {
     RenderCrossfade();
   }
 
-  if (needUpdate)
+  uint32_t dirty = dirtyPartitions.exchange(0, std::memory_order_relaxed);
+  if (dirty)
   {
-    // MLOGD("LED", "Update");
-    needUpdate = false;
-
-    // MLOGD("LED", "Update (Brightness size: %d)", ledPartitionBrightness.size());
-    Device::LED::Update(crossfadeActive ? crossfadeBuffer : frameBuffers[0], ledPartitionBrightness);
+    SubmitFrame(dirty);
   }
   xSemaphoreGive(activeBufferSemaphore);
 }
@@ -104,7 +206,7 @@ void UpdateBrightness() {
     // MatrixOS::UserVar::brightness, ledBrightnessMultiplier[i], brightnessMultiplied);
   }
 
-  needUpdate = true;
+  MarkDirty();
 }
 
 void Reset() {
@@ -121,7 +223,7 @@ void Reset() {
   {
     if (buffer)
     {
-      vPortFree(buffer);
+      ReleaseLayerBuffer(buffer);
     }
   }
 
@@ -129,6 +231,8 @@ void Reset() {
 
   CreateLayer(0); // Create Layer 0 - The active layer
   CreateLayer(0); // Create Layer 1 - The base layer
+  transmittedFrameValid = false;
+  MarkDirty();
   xSemaphoreGive(activeBufferSemaphore);
 }
 
@@ -140,6 +244,8 @@ void Init() {
     ledBrightnessMultiplier.resize(Device::LED::partitions.size());
     ledPartitionBrightness.resize(Device::LED::partitions.size());
 
+    transmittedBrightness.resize(Device::LED::partitions.size());
+
     ledCount = 0;
     for (uint8_t i = 0; i < Device::LED::partitions.size(); i++)
     {
@@ -150,6 +256,30 @@ void Init() {
       ledCount += Device::LED::partitions[i].size;
     }
 
+    ledPartitionLookup.assign(ledCount, 0);
+    for (uint8_t i = 0; i < Device::LED::partitions.size(); i++)
+    {
+      const LEDPartition& partition = Device::LED::partitions[i];
+      for (uint16_t index = partition.start; index < partition.start + partition.size && index < ledCount; index++)
+      {
+        ledPartitionLookup[index] = i;
+      }
+    }
+
+    transmittedFrame = (Color*)pvPortMalloc(ledCount * sizeof(Color));
+    arena = (Color*)pvPortMalloc(LED_ARENA_SLOTS * ledCount * sizeof(Color));
+    if (transmittedFrame == nullptr || arena == nullptr)
+    {
+      MatrixOS::SYS::ErrorHandler("Failed to allocate led buffers");
+      return;
+    }
+
+    for (uint8_t slot = 0; slot < LED_ARENA_SLOTS; slot++)
+    {
+      arenaFreeSlots[arenaFreeCount++] = LED_ARENA_SLOTS - 1 - slot;
+    }
+    arenaStats.slots = LED_ARENA_SLOTS;
+
     UpdateBrightness();
   }
 
@@ -157,6 +287,10 @@ void Init() {
   {
     activeBufferSemaphore = xSemaphoreCreateMutex();
   }
+  if (arenaMutex == nullptr)
+  {
+    arenaMutex = xSemaphoreCreateMutex();
+  }
 
   Reset();
 
@@ -233,7 +367,7 @@ void SetColor(Point xy, Color color, uint8_t layer) {
 
   if (layer == 0)
   {
-    needUpdate = true;
+    MarkIndexDirty(index);
   }
 }
 
@@ -256,7 +390,35 @@ void SetColor(uint16_t ID, Color color, uint8_t layer) {
 
   if (layer == 0)
   {
-    needUpdate = true;
+    MarkIndexDirty(index);
+  }
+}
+
+void SetColors(uint16_t index, const Color* colors, uint16_t count, uint8_t layer) {
+  if (layer == 255)
+  {
+    layer = CurrentLayer();
+  }
+  else if (layer >= frameBuffers.size() || frameBuffers[layer] == nullptr)
+  {
+    MatrixOS::SYS::ErrorHandler("LED Layer Unavailable");
+    return;
+  }
+
+  if (index >= ledCount || count == 0)
+    return;
+  count = std::min<uint16_t>(count, ledCount - index);
+
+  memcpy((void*)(frameBuffers[layer] + index), (const void*)colors, count * sizeof(Color));
+
+  if (layer == 0)
+  {
+    uint32_t mask = 0;
+    for (uint16_t i = index; i < index + count; i++)
+    {
+      mask |= 1UL << ledPartitionLookup[i];
+    }
+    MarkDirty(mask);
   }
 }
 
@@ -286,7 +448,7 @@ void Fill(Color color, uint8_t layer) {
 
   if (layer == 0)
   {
-    needUpdate = true;
+    MarkDirty();
   }
 }
 
@@ -337,7 +499,7 @@ bool FillPartition(string partition, Color color, uint8_t layer) {
 
   if (layer == 0)
   {
-    needUpdate = true;
+    MarkDirty(1UL << ledPartitionLookup[start]);
   }
 
   return true;
@@ -351,10 +513,13 @@ int8_t CreateLayer(uint16_t crossfade) {
   int8_t oldLayer = CurrentLayer();
   if (oldLayer >= MAX_LED_LAYERS)
   {
-    MatrixOS::SYS::ErrorHandler("Max LED Layer Exceded");
+    MLOGW("LED", "Max LED Layer Exceeded");
+    xSemaphoreTake(arenaMutex, portMAX_DELAY);
+    arenaStats.exhausted++;
+    xSemaphoreGive(arenaMutex);
     return -1;
   }
-  Color* frameBuffer = AllocateLayerBuffer("Failed to allocate new led buffer");
+  Color* frameBuffer = AcquireLayerBuffer("new layer");
   if (frameBuffer == nullptr)
   {
     return -1;
@@ -380,7 +545,7 @@ bool DestroyLayer(uint16_t crossfade) {
       Fade(crossfade);
     }
 
-    vPortFree(frameBuffers.back());
+    ReleaseLayerBuffer(frameBuffers.back());
     frameBuffers.pop_back();
     Update();
 
@@ -417,7 +582,7 @@ void Update(uint8_t layer) {
 
   xSemaphoreTake(activeBufferSemaphore, portMAX_DELAY);
   CopyLayer(0, layer);
-  needUpdate = true;
+  MarkDirty();
   xSemaphoreGive(activeBufferSemaphore);
 }
 
@@ -435,60 +600,63 @@ void Fade(uint16_t crossfade, Color* sourceBuffer) {
   {
     xSemaphoreTake(activeBufferSemaphore, portMAX_DELAY);
     ClearCrossfadeStateLocked();
-    needUpdate = true;
+    MarkDirty();
     xSemaphoreGive(activeBufferSemaphore);
     return;
   }
 
-  Color* nextCrossfadeBuffer = nullptr;
+  // Decide and claim under the lock, the timer callback may finish the running fade and release its buffers meanwhile
+  xSemaphoreTake(activeBufferSemaphore, portMAX_DELAY);
+
   if (crossfadeActive)
   {
-    nextCrossfadeBuffer = AllocateLayerBuffer("Failed to allocate crossfade buffer");
+    Color* nextCrossfadeBuffer = AcquireLayerBuffer("crossfade");
     if (nextCrossfadeBuffer == nullptr)
     {
+      xSemaphoreGive(activeBufferSemaphore);
       return;
     }
-  }
-  else if (crossfadeBuffer == nullptr)
-  {
-    crossfadeBuffer = AllocateLayerBuffer("Failed to allocate crossfade buffer");
-    if (crossfadeBuffer == nullptr)
-    {
-      return;
-    }
-  }
 
-  xSemaphoreTake(activeBufferSemaphore, portMAX_DELAY);
-
-  if (crossfadeActive)
-  {
     // Continue from the current blended frame instead of a stale source pointer.
     if (crossfadeDestroySourceBuffer && crossfadeSourceBuffer != nullptr)
     {
-      vPortFree(crossfadeSourceBuffer);
+      ReleaseLayerBuffer(crossfadeSourceBuffer);
     }
 
     crossfadeSourceBuffer = crossfadeBuffer;
     crossfadeBuffer = nextCrossfadeBuffer;
     crossfadeDestroySourceBuffer = true;
   }
-  else if (sourceBuffer == nullptr)
+  else
   {
-    // Create a copy of the current active frame so source data is stable for the entire fade.
-    crossfadeSourceBuffer = AllocateLayerBuffer("Failed to allocate crossfade buffer");
-    if (crossfadeSourceBuffer == nullptr)
+    if (crossfadeBuffer == nullptr)
     {
-      xSemaphoreGive(activeBufferSemaphore);
-      return;
+      crossfadeBuffer = AcquireLayerBuffer("crossfade");
+      if (crossfadeBuffer == nullptr)
+      {
+        xSemaphoreGive(activeBufferSemaphore);
+        return;
+      }
+    }
+
+    if (sourceBuffer == nullptr)
+    {
+      // Create a copy of the current active frame so source data is stable for the entire fade.
+      crossfadeSourceBuffer = AcquireLayerBuffer("crossfade source");
+      if (crossfadeSourceBuffer == nullptr)
+      {
+        xSemaphoreGive(activeBufferSemaphore);
+        return;
+      }
+      memcpy((void*)crossfadeSourceBuffer, (void*)frameBuffers[0], ledCount * sizeof(Color));
+      crossfadeDestroySourceBuffer = true;
+    }
+    else
+    {
+      // Used when creating a new layer; sourceBuffer already points to a stable source frame.
+      crossfadeSourceBuffer = sourceBuffer;
+      crossfadeDestroySourceBuffer = false;
     }
-    memcpy((void*)crossfadeSourceBuffer, (void*)frameBuffers[0], ledCount * sizeof(Color));
-    crossfadeDestroySourceBuffer = true;
-  }
-  else
-  {
-    // Used when creating a new layer; sourceBuffer already points to a stable source frame.
-    crossfadeSourceBuffer = sourceBuffer;
-    crossfadeDestroySourceBuffer = false;
   }
 
   crossfadeStartTime = MatrixOS::SYS::Millis() + crossfadeDelay;
@@ -521,27 +689,31 @@ IRAM_ATTR void RenderCrossfade() {
 
   if (ratio < FRACT16_MAX)
   {
-    for (uint16_t index = 0; index < ledCount; index++)
+    if (crossfadeSourceBuffer == nullptr)
+    {
+      std::fill_n(crossfadeBuffer, ledCount, Color(0));
+      ColorBlend::Crossfade(crossfadeBuffer, crossfadeBuffer, frameBuffers[0], ledCount, ratio);
+    }
+    else
     {
-      crossfadeBuffer[index] =
-          Color::Crossfade(crossfadeSourceBuffer == nullptr ? Color(0) : crossfadeSourceBuffer[index], frameBuffers[0][index], ratio);
+      ColorBlend::Crossfade(crossfadeBuffer, crossfadeSourceBuffer, frameBuffers[0], ledCount, ratio);
     }
   }
   else if (ratio == FRACT16_MAX)
   {
     if (crossfadeDestroySourceBuffer)
     {
-      vPortFree(crossfadeSourceBuffer);
+      ReleaseLayerBuffer(crossfadeSourceBuffer);
     }
     crossfadeSourceBuffer = nullptr;
     crossfadeDestroySourceBuffer = false;
-    vPortFree(crossfadeBuffer);
+    ReleaseLayerBuffer(crossfadeBuffer);
     crossfadeBuffer = nullptr;
     crossfadeActive = false;
     // MLOGD("LED", "Crossfade Done");
   }
 
-  needUpdate = true;
+  MarkDirty();
 }
 
 void PauseUpdate(bool pause) {
@@ -555,7 +727,168 @@ void PauseUpdate(bool pause) {
   }
 }
 
+static void RefreshXYTable() {
+  Direction rotation = Device::GetRotation();
+  int16_t width = Device::xSize + 2;
+  int16_t height = Device::ySize + 2;
+  if (!xyTable.empty() && rotation == xyTableRotation && width == xyTableWidth && height == xyTableHeight)
+  {
+    return;
+  }
+
+  xyTable.resize(width * height);
+  for (int16_t y = 0; y < height; y++)
+  {
+    for (int16_t x = 0; x < width; x++)
+    {
+      xyTable[y * width + x] = Device::LED::XY2Index(Point(x - 1, y - 1));
+    }
+  }
+  xyTableWidth = width;
+  xyTableHeight = height;
+  xyTableRotation = rotation;
+}
+
+Canvas AcquireCanvas(uint8_t layer) {
+  Canvas canvas;
+  if (layer == 255)
+  {
+    layer = CurrentLayer();
+  }
+  else if (layer >= frameBuffers.size() || frameBuffers[layer] == nullptr)
+  {
+    MatrixOS::SYS::ErrorHandler("LED Layer Unavailable");
+    return canvas;
+  }
+
+  RefreshXYTable();
+  canvas.buffer = frameBuffers[layer];
+  canvas.live = layer == 0;
+  return canvas;
+}
+
+Canvas Canvas::View(Point offset) {
+  Canvas view = *this;
+  view.origin = origin + offset;
+  return view;
+}
+
+uint16_t Canvas::Cell(Point xy) {
+  int16_t x = origin.x + xy.x + 1;
+  int16_t y = origin.y + xy.y + 1;
+  if (x < 0 || y < 0 || x >= xyTableWidth || y >= xyTableHeight)
+  {
+    return UINT16_MAX;
+  }
+  return y * xyTableWidth + x;
+}
+
+inline void Canvas::Write(uint16_t cell, Color color, uint32_t* mask) {
+  uint16_t index = xyTable[cell];
+  if (index == UINT16_MAX)
+    return;
+
+  buffer[index] = color;
+  *mask |= 1UL << ledPartitionLookup[index];
+}
+
+void Canvas::Commit(uint32_t mask) {
+  if (live && mask)
+  {
+    MarkDirty(mask);
+  }
+}
+
+void Canvas::SetColor(Point xy, Color color) {
+  uint16_t cell = Cell(xy);
+  if (buffer == nullptr || cell == UINT16_MAX)
+    return;
+
+  uint32_t mask = 0;
+  Write(cell, color, &mask);
+  Commit(mask);
+}
+
+void Canvas::SetRow(Point xy, const Color* colors, uint16_t count) {
+  SetRect(xy, Dimension(count, 1), colors);
+}
+
+void Canvas::SetRect(Point xy, Dimension size, const Color* colors) {
+  if (buffer == nullptr)
+    return;
+
+  // Clip to the table once so the inner loop is a straight walk along the row
+  int16_t left = origin.x + xy.x + 1;
+  int16_t top = origin.y + xy.y + 1;
+  int16_t xStart = std::max<int16_t>(0, -left);
+  int16_t yStart = std::max<int16_t>(0, -top);
+  int16_t xEnd = std::min<int16_t>(size.x, xyTableWidth - left);
+  int16_t yEnd = std::min<int16_t>(size.y, xyTableHeight - top);
+
+  uint32_t mask = 0;
+  for (int16_t y = yStart; y < yEnd; y++)
+  {
+    uint16_t cell = (top + y) * xyTableWidth + left + xStart;
+    const Color* row = colors + y * size.x;
+    for (int16_t x = xStart; x < xEnd; x++)
+    {
+      Write(cell++, row[x], &mask);
+    }
+  }
+  Commit(mask);
+}
+
+void Canvas::FillRect(Point xy, Dimension size, Color color) {
+  if (buffer == nullptr)
+    return;
+
+  int16_t left = std::max<int16_t>(0, origin.x + xy.x + 1);
+  int16_t top = std::max<int16_t>(0, origin.y + xy.y + 1);
+  int16_t right = std::min<int16_t>(origin.x + xy.x + 1 + size.x, xyTableWidth);
+  int16_t bottom = std::min<int16_t>(origin.y + xy.y + 1 + size.y, xyTableHeight);
+
+  uint32_t mask = 0;
+  for (int16_t y = top; y < bottom; y++)
+  {
+    for (int16_t x = left; x < right; x++)
+    {
+      Write(y * xyTableWidth + x, color, &mask);
+    }
+  }
+  Commit(mask);
+}
+
+void Canvas::Blit(const uint16_t* cells, const Color* colors, uint16_t count) {
+  if (buffer == nullptr)
+    return;
+
+  uint32_t mask = 0;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    if (cells[i] < xyTable.size())
+    {
+      Write(cells[i], colors[i], &mask);
+    }
+  }
+  Commit(mask);
+}
+
 uint32_t GetLEDCount(void) {
   return ledCount;
 }
+
+FrameStats GetFrameStats() {
+  return frameStats;
+}
+
+LayerArenaStats GetLayerArenaStats() {
+  if (arenaMutex == nullptr)
+  {
+    return arenaStats;
+  }
+  xSemaphoreTake(arenaMutex, portMAX_DELAY);
+  LayerArenaStats snapshot = arenaStats;
+  xSemaphoreGive(arenaMutex);
+  return snapshot;
+}
 } // namespace MatrixOS::LED
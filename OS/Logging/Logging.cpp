@@ -1,7 +1,13 @@
 #include "MatrixOS.h"
+#include "Logging.h"
+#include "../System/Telemetry.h"
+#include <atomic>
 
 #define DEFAULT_LOGGING_LEVEL LOG_VERBOSE // Change this later
 
+#define LOG_TASK_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
+#define LOG_TASK_INTERVAL_MS 10 // How often the logging task drains the ring
+
 namespace MatrixOS::Logging
 {
 
@@ -9,16 +15,23 @@ namespace MatrixOS::Logging
 
 string logLevel[5] = {"E", "W", "I", "D", "V"};
 string logLevelColor[5] = {"31", "33", "32", "36", "37"};
-void Log(ELogLevel level, const string& tag, const string& format, va_list& valst) // DO NOT USE THIS DIRECTLY. STRING WILL NOT BE
-                                                                                   // REMOVED IF LOG LEVEL ISN'T SET FOR IT TO LOG
-{
+
+static string Prefix(ELogLevel level, const string& tag, uint32_t timestamp) {
+#ifdef MATRIXOS_LOG_COLOR
+  return string() + "\033[0;" + logLevelColor[level - 1] + "m" + logLevel[level - 1] + " (" + std::to_string(timestamp) + ") " + tag + ": ";
+#else
+  return string() + logLevel[level - 1] + " (" + std::to_string(timestamp) + ") " + tag + ": ";
+#endif
+}
+
 #ifdef MATRIXOS_LOG_COLOR
-  string msg = string() + "\033[0;" + logLevelColor[level - 1] + "m" + logLevel[level - 1] + " (" + std::to_string(SYS::Millis()) + ") " +
-               tag + ": " + format + "\033[0m\n";
+#define LOG_SUFFIX "\033[0m\n"
 #else
-  string msg = string() + logLevel[level - 1] + " (" + std::to_string(SYS::Millis()) + ") " + tag + ": " + format + "\n";
+#define LOG_SUFFIX "\n"
 #endif
 
+// Fan a message out to every sink
+static void Write(string& msg, va_list& valst) {
 #ifdef MATRIXOS_LOG_DEVICE
   va_list deviceArgs;
   va_copy(deviceArgs, valst);
@@ -34,6 +47,362 @@ void Log(ELogLevel level, const string& tag, const string& format, va_list& vals
 #endif
 }
 
+void Log(ELogLevel level, const string& tag, const string& format, va_list& valst) // DO NOT USE THIS DIRECTLY. STRING WILL NOT BE
+                                                                                   // REMOVED IF LOG LEVEL ISN'T SET FOR IT TO LOG
+{
+  string msg = Prefix(level, tag, SYS::Millis()) + format + LOG_SUFFIX;
+  Write(msg, valst);
+}
+
+// Deferred logging
+// Callers only capture their arguments into a fixed size record in a lock-free MPSC ring (Vyukov style, a sequence per slot).
+// The logging task re-walks the format string to decode the arguments, formats the line and writes it to the sinks.
+struct LogRecord {
+  std::atomic<uint32_t> sequence;
+  uint32_t timestamp;
+  const char* tag;
+  const char* format;
+  ELogLevel level;
+  bool truncated;
+  uint8_t argLength;
+  uint8_t args[LOG_RECORD_ARG_SIZE];
+};
+
+static_assert((LOG_DEFERRED_QUEUE_SIZE & (LOG_DEFERRED_QUEUE_SIZE - 1)) == 0, "LOG_DEFERRED_QUEUE_SIZE must be a power of two");
+
+static LogRecord records[LOG_DEFERRED_QUEUE_SIZE];
+static std::atomic<uint32_t> enqueuePosition{0};
+static uint32_t dequeuePosition = 0; // Only touched by the logging task
+static std::atomic<bool> deferredReady{false};
+
+static std::atomic<uint32_t> recordsQueued{0};
+static std::atomic<uint32_t> recordsDropped{0};
+static std::atomic<uint32_t> recordsTruncated{0};
+
+static StackType_t logTaskStack[LOG_TASK_STACK_SIZE];
+static StaticTask_t logTaskDef;
+
+enum ArgType : uint8_t { ARG_NONE, ARG_INT, ARG_LONG, ARG_LONGLONG, ARG_SIZE, ARG_DOUBLE, ARG_POINTER, ARG_STRING };
+
+// Parses one conversion at format[0] == '%'. Returns the type of its value, the number of '*' fields and the spec length.
+static ArgType ParseSpec(const char* format, uint8_t* stars, uint8_t* length) {
+  const char* p = format + 1;
+  *stars = 0;
+  while (*p && strchr("-+ #0", *p))
+  {
+    p++;
+  }
+  for (uint8_t field = 0; field < 2; field++) // Width, then precision
+  {
+    if (field == 1)
+    {
+      if (*p != '.')
+      {
+        break;
+      }
+      p++;
+    }
+    if (*p == '*')
+    {
+      (*stars)++;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+      p++;
+    }
+  }
+
+  uint8_t longs = 0;
+  bool sizeType = false;
+  while (*p && strchr("hlLzjt", *p))
+  {
+    if (*p == 'l')
+    {
+      longs++;
+    }
+    else if (*p == 'z' || *p == 'j' || *p == 't')
+    {
+      sizeType = true;
+    }
+    p++;
+  }
+
+  char conversion = *p;
+  *length = (conversion ? p + 1 : p) - format;
+  switch (conversion)
+  {
+  case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+    if (sizeType)
+    {
+      return ARG_SIZE;
+    }
+    return longs >= 2 ? ARG_LONGLONG : (longs == 1 ? ARG_LONG : ARG_INT);
+  case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+    return ARG_DOUBLE;
+  case 'p':
+    return ARG_POINTER;
+  case 's':
+    return ARG_STRING;
+  default: // %% or unsupported, consumes nothing
+    return ARG_NONE;
+  }
+}
+
+template <typename T>
+static bool Store(LogRecord* record, T value) {
+  if (record->argLength + sizeof(T) > LOG_RECORD_ARG_SIZE)
+  {
+    return false;
+  }
+  memcpy(record->args + record->argLength, &value, sizeof(T));
+  record->argLength += sizeof(T);
+  return true;
+}
+
+template <typename T>
+static T Load(const LogRecord* record, uint8_t* offset) {
+  T value{};
+  if (*offset + sizeof(T) <= record->argLength)
+  {
+    memcpy(&value, record->args + *offset, sizeof(T));
+    *offset += sizeof(T);
+  }
+  return value;
+}
+
+static void CaptureArgs(LogRecord* record, const char* format, va_list& valst) {
+  record->argLength = 0;
+  record->truncated = false;
+  bool full = false;
+  for (const char* p = format; *p; p++)
+  {
+    if (*p != '%')
+    {
+      continue;
+    }
+    uint8_t stars, length;
+    ArgType type = ParseSpec(p, &stars, &length);
+    p += length - 1;
+    for (uint8_t i = 0; i < stars; i++)
+    {
+      int star = va_arg(valst, int);
+      full = full || !Store(record, star);
+    }
+    switch (type)
+    {
+    case ARG_INT: { int value = va_arg(valst, int); full = full || !Store(record, value); break; }
+    case ARG_LONG: { long value = va_arg(valst, long); full = full || !Store(record, value); break; }
+    case ARG_LONGLONG: { long long value = va_arg(valst, long long); full = full || !Store(record, value); break; }
+    case ARG_SIZE: { size_t value = va_arg(valst, size_t); full = full || !Store(record, value); break; }
+    case ARG_DOUBLE: { double value = va_arg(valst, double); full = full || !Store(record, value); break; }
+    case ARG_POINTER: { void* value = va_arg(valst, void*); full = full || !Store(record, value); break; }
+    case ARG_STRING: {
+      // Strings are copied, the caller's buffer may be gone by the time the record is formatted
+      const char* value = va_arg(valst, const char*);
+      if (value == nullptr)
+      {
+        value = "(null)";
+      }
+      uint8_t space = full ? 0 : LOG_RECORD_ARG_SIZE - record->argLength;
+      if (space == 0)
+      {
+        full = true;
+        break;
+      }
+      size_t stringLength = strnlen(value, space - 1);
+      memcpy(record->args + record->argLength, value, stringLength);
+      record->args[record->argLength + stringLength] = '\0';
+      record->argLength += stringLength + 1;
+      full = full || value[stringLength] != '\0';
+      break;
+    }
+    case ARG_NONE:
+      break;
+    }
+  }
+  record->truncated = full;
+}
+
+template <typename T>
+static void AppendSpec(string& out, const char* spec, uint8_t stars, const int* starValues, T value) {
+  char buffer[LOG_RECORD_ARG_SIZE + 32];
+  if (stars == 0)
+  {
+    snprintf(buffer, sizeof(buffer), spec, value);
+  }
+  else if (stars == 1)
+  {
+    snprintf(buffer, sizeof(buffer), spec, starValues[0], value);
+  }
+  else
+  {
+    snprintf(buffer, sizeof(buffer), spec, starValues[0], starValues[1], value);
+  }
+  out += buffer;
+}
+
+static string FormatRecord(const LogRecord* record) {
+  string out;
+  uint8_t offset = 0;
+  char spec[16];
+  for (const char* p = record->format; *p; p++)
+  {
+    if (*p != '%')
+    {
+      out += *p;
+      continue;
+    }
+    uint8_t stars, length;
+    ArgType type = ParseSpec(p, &stars, &length);
+    if (type == ARG_NONE || length >= sizeof(spec))
+    {
+      if (p[1] == '%')
+      {
+        out += '%';
+      }
+      p += length - 1;
+      continue;
+    }
+    memcpy(spec, p, length);
+    spec[length] = '\0';
+    p += length - 1;
+
+    int starValues[2] = {0, 0};
+    for (uint8_t i = 0; i < stars; i++)
+    {
+      starValues[i] = Load<int>(record, &offset);
+    }
+    switch (type)
+    {
+    case ARG_INT: AppendSpec(out, spec, stars, starValues, Load<int>(record, &offset)); break;
+    case ARG_LONG: AppendSpec(out, spec, stars, starValues, Load<long>(record, &offset)); break;
+    case ARG_LONGLONG: AppendSpec(out, spec, stars, starValues, Load<long long>(record, &offset)); break;
+    case ARG_SIZE: AppendSpec(out, spec, stars, starValues, Load<size_t>(record, &offset)); break;
+    case ARG_DOUBLE: AppendSpec(out, spec, stars, starValues, Load<double>(record, &offset)); break;
+    case ARG_POINTER: AppendSpec(out, spec, stars, starValues, Load<void*>(record, &offset)); break;
+    case ARG_STRING: {
+      const char* value = "";
+      if (offset < record->argLength)
+      {
+        value = (const char*)record->args + offset;
+        offset += strnlen(value, record->argLength - offset) + 1;
+      }
+      AppendSpec(out, spec, stars, starValues, value);
+      break;
+    }
+    case ARG_NONE:
+      break;
+    }
+  }
+  if (record->truncated)
+  {
+    out += " [truncated]";
+  }
+  return out;
+}
+
+static void WriteFormatted(string msg, ...) {
+  va_list valst;
+  va_start(valst, msg);
+  Write(msg, valst);
+  va_end(valst);
+}
+
+static void LogTask(void* param) {
+  while (true)
+  {
+    while (true)
+    {
+      LogRecord* record = &records[dequeuePosition & (LOG_DEFERRED_QUEUE_SIZE - 1)];
+      if (record->sequence.load(std::memory_order_acquire) != dequeuePosition + 1)
+      {
+        break;
+      }
+      string msg = Prefix(record->level, record->tag, record->timestamp) + FormatRecord(record) + LOG_SUFFIX;
+      record->sequence.store(dequeuePosition + LOG_DEFERRED_QUEUE_SIZE, std::memory_order_release);
+      dequeuePosition++;
+      WriteFormatted("%s", msg.c_str());
+    }
+    vTaskDelay(pdMS_TO_TICKS(LOG_TASK_INTERVAL_MS));
+  }
+}
+
+void Init() {
+  if (deferredReady)
+  {
+    return;
+  }
+  for (uint32_t i = 0; i < LOG_DEFERRED_QUEUE_SIZE; i++)
+  {
+    records[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  TaskHandle_t logTask = xTaskCreateStatic(LogTask, "logging", LOG_TASK_STACK_SIZE, NULL, 1, logTaskStack, &logTaskDef);
+  Telemetry::WatchTask(logTask, "logging");
+  deferredReady.store(true, std::memory_order_release);
+}
+
+void LogDeferred(ELogLevel level, const char* tag, const char* format, ...) {
+  va_list valst;
+  va_start(valst, format);
+
+  // Logging task isn't up yet, log in place
+  if (!deferredReady.load(std::memory_order_acquire))
+  {
+    Log(level, tag, format, valst);
+    va_end(valst);
+    return;
+  }
+
+  uint32_t position = enqueuePosition.load(std::memory_order_relaxed);
+  LogRecord* record;
+  while (true)
+  {
+    record = &records[position & (LOG_DEFERRED_QUEUE_SIZE - 1)];
+    int32_t diff = (int32_t)(record->sequence.load(std::memory_order_acquire) - position);
+    if (diff == 0)
+    {
+      if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+      {
+        break;
+      }
+    }
+    else if (diff < 0)
+    {
+      // Full, never block the caller
+      recordsDropped.fetch_add(1, std::memory_order_relaxed);
+      va_end(valst);
+      return;
+    }
+    else
+    {
+      position = enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  record->timestamp = SYS::Millis();
+  record->level = level;
+  record->tag = tag;
+  record->format = format;
+  CaptureArgs(record, format, valst);
+  va_end(valst);
+  if (record->truncated)
+  {
+    recordsTruncated.fetch_add(1, std::memory_order_relaxed);
+  }
+  recordsQueued.fetch_add(1, std::memory_order_relaxed);
+  record->sequence.store(position + 1, std::memory_order_release);
+}
+
+LogStats GetLogStats() {
+  LogStats stats;
+  stats.queued = recordsQueued.load(std::memory_order_relaxed);
+  stats.dropped = recordsDropped.load(std::memory_order_relaxed);
+  stats.truncated = recordsTruncated.load(std::memory_order_relaxed);
+  stats.pending = enqueuePosition.load(std::memory_order_relaxed) - dequeuePosition;
+  return stats;
+}
+
 void LogError(const string& tag, const string& format, ...) {
 #if MATRIXOS_LOG_LEVEL >= LOG_LEVEL_ERROR
   va_list valst;
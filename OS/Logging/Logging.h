@@ -0,0 +1,6 @@
+#pragma once
+
+namespace MatrixOS::Logging
+{
+void Init(); // Start the deferred logging task
+}
@@ -3,6 +3,7 @@
 #include "Commands/CommandHandler.h"
 
 #include "../System/System.h"
+#include "../System/Telemetry.h"
 
 namespace MatrixOS::MIDI
 {
@@ -11,7 +12,7 @@ static constexpr size_t MATRIXOS_SYSEX_REPLY_OVERHEAD = 3;
 static constexpr uint32_t SYSEX_INACTIVITY_TIMEOUT_MS = 1000;
 static uint32_t droppedAppMidiPackets = 0;
 static uint32_t droppedOversizedSysExMessages = 0;
-static uint32_t timedOutSysExSessions = 0;
+static uint32_t appQueueHighWaterMark = 0;
 
 static bool SendCommandSysExReply(const vector<uint8_t>& reply, bool end, void* context) {
   (void)end;
@@ -53,21 +54,8 @@ static void LogDroppedOversizedSysEx() {
   }
 }
 
-static void LogTimedOutSysExSession() {
-  timedOutSysExSessions++;
-  if (timedOutSysExSessions == 1 || (timedOutSysExSessions % 8) == 0)
-  {
-    MLOGW("MIDI", "Dropped timed out SysEx session(s): %lu", timedOutSysExSessions);
-  }
-}
-
-static void ResetActiveSysExSession(vector<uint8_t>& sysExBuffer, uint16_t& activeSysExPort, SysExState& currentSysExState,
-                                    uint32_t& lastSysExActivityMs) {
-  sysExBuffer.clear();
-  activeSysExPort = MIDI_PORT_INVALID;
-  currentSysExState = SysExState::SYSEX_IDLE;
-  lastSysExActivityMs = 0;
-}
+static bool UniversalSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
+static bool MatrixOSSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context);
 
 void Init(void) {
   // Create the OS MIDI port if it doesn't exist
@@ -80,6 +68,18 @@ void Init(void) {
   if (!appQueue)
   {
     appQueue = xQueueCreate(MIDI_QUEUE_SIZE, sizeof(MidiPacket));
+    vQueueAddToRegistry(appQueue, "MIDI App");
+  }
+
+  if (!sysExAssembler)
+  {
+    sysExAssembler = new SysExAssembler(SYSEX_INACTIVITY_TIMEOUT_MS);
+    const uint8_t universalPrefix[] = {MIDIv1_SYSEX_START, MIDIv1_UNIVERSAL_NON_REALTIME_ID};
+    const uint8_t commandPrefix[] = {MIDIv1_SYSEX_START, MATRIXOS_SYSEX_REQUEST};
+    const uint8_t appPrefix[] = {MIDIv1_SYSEX_START, SYSEX_MFG_ID[0], SYSEX_MFG_ID[1], SYSEX_MFG_ID[2], SYSEX_FAMILY_ID[0], SYSEX_FAMILY_ID[1]};
+    sysExAssembler->AddHandler(universalPrefix, sizeof(universalPrefix), UniversalSysExHandler, nullptr, true);
+    sysExAssembler->AddHandler(commandPrefix, sizeof(commandPrefix), MatrixOSSysExHandler, nullptr, true);
+    sysExAssembler->AddHandler(appPrefix, sizeof(appPrefix), nullptr, nullptr, true); // Application SysEx, passed to the app after the header
   }
 
   // Create the receive task if it doesn't exist
@@ -87,6 +87,7 @@ void Init(void) {
   if (!receiveTask && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
   {
     xTaskCreate(ReceiveTask, "MIDI_Receive", 2048, NULL, tskIDLE_PRIORITY + 2, &receiveTask);
+    Telemetry::WatchTask(receiveTask, "MIDI_Receive");
   }
 }
 
@@ -102,13 +103,45 @@ bool Send(MidiPacket midiPacket, uint16_t targetPort, uint16_t timeoutMs) {
   return osPort->Send(midiPacket, targetPort, timeoutMs);
 }
 
-void ReceiveTask(void* parameters) {
+bool SendBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t targetPort, uint16_t timeoutMs) {
+  if (!osPort)
+    return false;
+  return osPort->SendBatch(midiPackets, count, targetPort, timeoutMs);
+}
+
+bool AddSysExHandler(const uint8_t* prefix, uint8_t prefixLength, SysExHandler handler, void* context) {
+  if (!sysExAssembler || handler == nullptr)
+    return false;
+  return sysExAssembler->AddHandler(prefix, prefixLength, handler, context);
+}
 
-  static vector<uint8_t> sysExBuffer;
-  static uint16_t activeSysExPort = MIDI_PORT_INVALID;
-  static SysExState currentSysExState = SysExState::SYSEX_IDLE;
-  static uint32_t lastSysExActivityMs = 0;
+void RemoveSysExHandler(SysExHandler handler, void* context) {
+  if (sysExAssembler)
+    sysExAssembler->RemoveHandler(handler, context);
+}
+
+void RemoveAppSysExHandlers() {
+  if (sysExAssembler)
+    sysExAssembler->RemoveAppHandlers();
+}
+
+SysExStats GetSysExStats() {
+  if (!sysExAssembler)
+    return SysExStats();
+  return sysExAssembler->GetStats();
+}
 
+MidiQueueStats GetQueueStats() {
+  MidiQueueStats stats;
+  stats.capacity = MIDI_QUEUE_SIZE;
+  stats.pending = appQueue ? uxQueueMessagesWaiting(appQueue) : 0;
+  stats.highWaterMark = appQueueHighWaterMark;
+  stats.droppedPackets = droppedAppMidiPackets;
+  stats.droppedOversizedSysEx = droppedOversizedSysExMessages;
+  return stats;
+}
+
+void ReceiveTask(void* parameters) {
   MidiPacket packet;
 
   while (true)
@@ -116,93 +149,28 @@ void ReceiveTask(void* parameters) {
     // Blocking get from OS port
     if (osPort && osPort->Get(&packet, portMAX_DELAY))
     {
-      // Process the packet (moved from old Receive function)
-      bool shouldForwardToApp = true;
-      uint32_t nowMs = SYS::Millis();
-
-      if (activeSysExPort != MIDI_PORT_INVALID && (uint32_t)(nowMs - lastSysExActivityMs) > SYSEX_INACTIVITY_TIMEOUT_MS)
+      // SysEx is reassembled per port and streamed to its handler, only application SysEx is passed on packet by packet
+      if (packet.SysEx() && sysExAssembler->Receive(packet, SYS::Millis()) == SysExAssembler::SYSEX_CONSUMED)
       {
-        ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-        LogTimedOutSysExSession();
+        continue;
       }
 
-      // Handle SysEx
-      if (packet.SysEx())
+      // Forward to application queue
+      if (appQueue)
       {
-        if (packet.SysExStart())
+        // Try to send to app queue, drop if full
+        if (xQueueSend(appQueue, &packet, 0) != pdTRUE)
         {
-          if (activeSysExPort != MIDI_PORT_INVALID && packet.port != activeSysExPort)
-          {
-            continue; // Skip concurrent SysEx from another port
-          }
-
-          sysExBuffer.reserve(12);
-          sysExBuffer.clear();
-          activeSysExPort = packet.port;
-          currentSysExState = SysExState::SYSEX_PENDING;
-          lastSysExActivityMs = nowMs;
+          LogDroppedAppMidiPacket();
         }
         else
         {
-          if (activeSysExPort != packet.port)
+          UBaseType_t pending = uxQueueMessagesWaiting(appQueue);
+          if (pending > appQueueHighWaterMark)
           {
-            continue; // Skip fragments for inactive or concurrent ports
-          }
-
-          lastSysExActivityMs = nowMs;
-
-          if (currentSysExState == SysExState::SYSEX_INVALID)
-          {
-            if (packet.status == SysExEnd)
-            {
-              ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-            }
-            continue; // Skip this packet
+            appQueueHighWaterMark = pending;
           }
-        }
-
-        if (currentSysExState != SysExState::SYSEX_RELEASE)
-        {
-          uint8_t packetLength = packet.Length();
-          if (sysExBuffer.size() + packetLength > MAX_SYSTEM_SYSEX_SIZE)
-          {
-            sysExBuffer.clear();
-            LogDroppedOversizedSysEx();
-            if (packet.status == SysExEnd)
-            {
-              ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-            }
-            else
-            {
-              currentSysExState = SysExState::SYSEX_INVALID;
-            }
-            continue;
-          }
-
-          sysExBuffer.insert(sysExBuffer.end(), packet.data, packet.data + packetLength);
-          currentSysExState = ProcessSysEx(packet.port, sysExBuffer, packet.status == SysExEnd);
-
-          if (packet.status == SysExEnd)
-          {
-            ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-          }
-          shouldForwardToApp = false; // System handled this packet
-        }
-      }
-
-      // If current SysEx is the SysexEnd, free up the sysex lock for more sysex.
-      if (packet.status == SysExEnd && packet.port == activeSysExPort)
-      {
-        ResetActiveSysExSession(sysExBuffer, activeSysExPort, currentSysExState, lastSysExActivityMs);
-      }
-
-      // Forward to application queue if not handled by system
-      if (shouldForwardToApp && appQueue)
-      {
-        // Try to send to app queue, drop if full
-        if (xQueueSend(appQueue, &packet, 0) != pdTRUE)
-        {
-          LogDroppedAppMidiPacket();
+          SYS::WakeApp();
         }
       }
     }
@@ -270,82 +238,68 @@ bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data, bool includeMeta)
   return true;
 }
 
-SysExState ProcessSysEx(uint16_t port, vector<uint8_t>& sysExBuffer, bool complete) {
-  if (sysExBuffer.empty())
+static bool UniversalSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context) {
+  (void)context;
+  if (flags != (SYSEX_CHUNK_START | SYSEX_CHUNK_END)) // Only short whole messages are of interest
   {
-    return SysExState::SYSEX_INVALID;
-  }
-
-  if (sysExBuffer[0] != MIDIv1_SYSEX_START)
-  {
-    return SysExState::SYSEX_INVALID;
+    return false;
   }
 
-  if (complete)
+  if (length >= 5 && data[3] == USYSEX_GENERAL_INFO && data[4] == USYSEX_GI_ID_REQUEST) // General Info - Identity Request
   {
-    if (sysExBuffer.size() < 2)
-    {
-      return SysExState::SYSEX_INVALID;
-    }
-
-    if (sysExBuffer[1] == MIDIv1_UNIVERSAL_NON_REALTIME_ID) // Non real time messages
-    {
-      if (sysExBuffer.size() >= 5 && sysExBuffer[3] == USYSEX_GENERAL_INFO &&
-          sysExBuffer[4] == USYSEX_GI_ID_REQUEST) // General Info - Identity Request I should be check channel here but it doesn't matter
-      {
 #if MATRIXOS_BUILD_VER == 0 // Release Version
-        uint8_t osReleaseVersion = 0;
+    uint8_t osReleaseVersion = 0;
 #elif (MATRIXOS_BUILD_VER == 4)   // Nighty Version
-        uint8_t osReleaseVersion = 0x31; // 0b0011111 - Shares the same first two bit as release version but the last 5 bits are set
+    uint8_t osReleaseVersion = 0x31; // 0b0011111 - Shares the same first two bit as release version but the last 5 bits are set
 #elif (MATRIXOS_RELEASE_VER < 32) // Special Release Version
-        uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + MATRIXOS_RELEASE_VER;
+    uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + MATRIXOS_RELEASE_VER;
 #else
-        uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + 0x1F;
+    uint8_t osReleaseVersion = (MATRIXOS_BUILD_VER << 5) + 0x1F;
 #endif
 
-        uint8_t reply[] = {MIDIv1_SYSEX_START,    MIDIv1_UNIVERSAL_NON_REALTIME_ID,
-                           USYSEX_ALL_CHANNELS,   USYSEX_GENERAL_INFO,
-                           USYSEX_GI_ID_RESPONSE, SYSEX_MFG_ID[0],
-                           SYSEX_MFG_ID[1],       SYSEX_MFG_ID[2],
-                           SYSEX_FAMILY_ID[0],    SYSEX_FAMILY_ID[1],
-                           SYSEX_MODEL_ID[0],     SYSEX_MODEL_ID[1],
-                           MATRIXOS_MAJOR_VER,    MATRIXOS_MINOR_VER,
-                           MATRIXOS_PATCH_VER,    osReleaseVersion,
-                           MIDIv1_SYSEX_END};
-
-        SendSysEx(port, sizeof(reply), reply, false);
-      }
-    }
-    else if (sysExBuffer[1] == MATRIXOS_SYSEX_REQUEST) // Matrix OS specific sysex
-    {
-      if (sysExBuffer.size() >= 3)
-      {
-        HandleMatrixOSSysEx(port, sysExBuffer);
-      }
-    }
-    return SysExState::SYSEX_COMPLETE;
+    uint8_t reply[] = {MIDIv1_SYSEX_START,    MIDIv1_UNIVERSAL_NON_REALTIME_ID,
+                       USYSEX_ALL_CHANNELS,   USYSEX_GENERAL_INFO,
+                       USYSEX_GI_ID_RESPONSE, SYSEX_MFG_ID[0],
+                       SYSEX_MFG_ID[1],       SYSEX_MFG_ID[2],
+                       SYSEX_FAMILY_ID[0],    SYSEX_FAMILY_ID[1],
+                       SYSEX_MODEL_ID[0],     SYSEX_MODEL_ID[1],
+                       MATRIXOS_MAJOR_VER,    MATRIXOS_MINOR_VER,
+                       MATRIXOS_PATCH_VER,    osReleaseVersion,
+                       MIDIv1_SYSEX_END};
+
+    SendSysEx(port, sizeof(reply), reply, false);
   }
-  else if (sysExBuffer.size() >= 6 && sysExBuffer[1] == SYSEX_MFG_ID[0] && sysExBuffer[2] == SYSEX_MFG_ID[1] &&
-           sysExBuffer[3] == SYSEX_MFG_ID[2] && sysExBuffer[4] == SYSEX_FAMILY_ID[0] && sysExBuffer[5] == SYSEX_FAMILY_ID[1])
+  return true;
+}
+
+static bool MatrixOSSysExHandler(uint16_t port, const uint8_t* data, size_t length, uint8_t flags, void* context) {
+  (void)context;
+  if (flags != (SYSEX_CHUNK_START | SYSEX_CHUNK_END)) // Commands are handled whole
   {
-    return SysExState::SYSEX_RELEASE;
+    if (flags & SYSEX_CHUNK_START)
+    {
+      LogDroppedOversizedSysEx();
+    }
+    return false;
   }
-  return SysExState::SYSEX_PENDING;
+
+  HandleMatrixOSSysEx(port, data, length);
+  return true;
 }
 
-void HandleMatrixOSSysEx(uint16_t port, vector<uint8_t>& sysExBuffer) {
-  if (sysExBuffer.size() < 4 || sysExBuffer.back() != MIDIv1_SYSEX_END)
+void HandleMatrixOSSysEx(uint16_t port, const uint8_t* sysEx, size_t length) {
+  if (length < 4 || sysEx[length - 1] != MIDIv1_SYSEX_END)
   {
     return;
   }
 
-  const uint8_t* request = sysExBuffer.data() + 2;
-  size_t requestSize = sysExBuffer.size() - 3;
+  const uint8_t* request = sysEx + 2;
+  size_t requestSize = length - 3;
 
   if (!Command::Submit(Command::Encoding::SysEx7Bit, request, requestSize, MAX_SYSTEM_SYSEX_SIZE - MATRIXOS_SYSEX_REPLY_OVERHEAD,
                        SendCommandSysExReply, port))
   {
-    MLOGE("MIDI", "Dropped MatrixOS SysEx command: %d", sysExBuffer[2]);
+    MLOGE("MIDI", "Dropped MatrixOS SysEx command: %d", sysEx[2]);
   }
 }
 } // namespace MatrixOS::MIDI
@@ -33,16 +33,34 @@ void ExecuteAPP(string author, string appName, const vector<string>& args = {});
 void ExitAPP();
 
 void ErrorHandler(string error = string());
+
+void WakeApp(); // Wake the app task if it is blocked in WaitForWake. Called on input, MIDI and render requests.
+bool WaitForWake(uint32_t timeoutMs); // Block the app task until WakeApp is called or the timeout expires
 } // namespace SYS
 
 namespace LED
 {
+struct FrameStats {
+  uint32_t framesSubmitted = 0;     // Frames handed to the LED driver
+  uint32_t framesSkipped = 0;       // Frames identical to the last transmitted one
+  uint32_t partitionsSubmitted = 0; // Partitions that changed since the last transmitted frame
+  uint32_t partitionsSkipped = 0;   // Partitions that were clean or unchanged
+};
+
+struct LayerArenaStats {
+  uint8_t slots = 0;         // Layer and crossfade buffers reserved at Init
+  uint8_t inUse = 0;
+  uint8_t highWaterMark = 0; // Most buffers in use at once
+  uint32_t exhausted = 0;    // Layer or crossfade requests refused because every buffer was in use
+};
+
 void NextBrightness();
 void SetBrightness(uint8_t brightness);
 bool SetBrightnessMultiplier(string partitionName, float multiplier);
 
 void SetColor(Point xy, Color color, uint8_t layer = 255);
 void SetColor(uint16_t ID, Color color, uint8_t layer = 255);
+void SetColors(uint16_t index, const Color* colors, uint16_t count, uint8_t layer = 255); // Raw LED index order, no ID mapping
 void Fill(Color color, uint8_t layer = 255);
 bool FillPartition(string partition, Color color, uint8_t layer = 255);
 void Update(uint8_t layer = 255);
@@ -56,10 +74,50 @@ void Fade(uint16_t crossfade = crossfadeDuration, Color* sourceBuffer = nullptr)
 
 void PauseUpdate(bool pause = true);
 uint32_t GetLEDCount(void);
+FrameStats GetFrameStats();
+LayerArenaStats GetLayerArenaStats();
+
+// A layer acquired once for a whole redraw. Writes skip the per call layer checks and go through a cached,
+// rotation aware XY to index table. Acquire a new one for every redraw, it doesn't survive CreateLayer or DestroyLayer.
+class Canvas {
+public:
+  bool Valid() { return buffer != nullptr; }
+  Point Origin() { return origin; }
+  Canvas View(Point offset); // Same layer with (0, 0) moved to offset, what UI components are handed
+
+  void SetColor(Point xy, Color color);
+  void SetRow(Point xy, const Color* colors, uint16_t count);   // count pixels left to right from xy
+  void SetRect(Point xy, Dimension size, const Color* colors);  // Row major, size.x * size.y colors
+  void FillRect(Point xy, Dimension size, Color color);
+
+  // Precomputed index maps. A cell is a rotation independent handle for a position relative to this canvas, UINT16_MAX
+  // if it is off the table. Cells stay valid across rotations and canvases as long as the origin is the same.
+  uint16_t Cell(Point xy);
+  void Blit(const uint16_t* cells, const Color* colors, uint16_t count);
+
+private:
+  friend Canvas AcquireCanvas(uint8_t layer);
+  Color* buffer = nullptr;
+  Point origin = Point(0, 0);
+  bool live = false; // Layer 0 is what the driver reads, writes mark partitions dirty
+  void Write(uint16_t cell, Color color, uint32_t* mask);
+  void Commit(uint32_t mask);
+};
+
+Canvas AcquireCanvas(uint8_t layer = 255); // Invalid canvas (writes are ignored) if the layer doesn't exist
 } // namespace LED
 
 namespace Input
 {
+struct InputQueueStats {
+  uint32_t capacity = 0;
+  uint32_t pending = 0;
+  uint32_t highWaterMark = 0;       // Most events pending at once
+  uint32_t coalescedAftertouch = 0; // Aftertouch updates merged into a pending event
+  uint32_t droppedAftertouch = 0;   // Aftertouch dropped to keep room for state transitions
+  uint32_t droppedEvents = 0;       // Other events dropped because the queue was full
+};
+
 bool Get(InputEvent* event, uint32_t timeoutMs = 0);
 bool GetState(InputId id, InputSnapshot* snapshot);
 
@@ -75,6 +133,7 @@ void ClearInputBuffer();
 
 bool GetKeypadCapabilities(uint8_t clusterId, KeypadCapabilities* caps);
 
+InputQueueStats GetQueueStats();
 } // namespace Input
 
 namespace USB
@@ -83,28 +142,103 @@ bool Connected(void); // If USB is connected
 
 namespace CDC
 {
+// What happens to output that doesn't fit the TX ring
+enum class TxOverflowPolicy : uint8_t {
+  Block,      // Wait for the host to drain it, up to CDC_TX_BLOCK_TIMEOUT_MS, then drop the rest
+  DropOldest, // Discard the oldest queued output to make room
+  DropNewest, // Discard what doesn't fit
+};
+
+struct TxStats {
+  uint32_t capacity = 0;
+  uint32_t pending = 0;       // Bytes queued and not yet handed to the USB stack
+  uint32_t highWaterMark = 0; // Most bytes queued at once
+  uint32_t bytesQueued = 0;
+  uint32_t bytesSent = 0;     // Bytes handed to the USB stack
+  uint32_t bytesDropped = 0;
+  uint32_t transfers = 0;     // Bulk writes, bytesSent / transfers is the average write size
+  uint32_t blockedWrites = 0; // Writes that had to wait for room under TxOverflowPolicy::Block
+};
+
 bool Connected(void);
 uint32_t Available(void);
 void Poll(void);
 
+// Output is copied to a RAM ring and sent by the USB task as the endpoint frees up
 void Print(string str);
 void Println(string str);
 void Printf(string format, ...);
 void VPrintf(string format, va_list valst);
-void Flush(void);
+void Flush(void); // Hands whatever is queued to the USB stack now
+void SetTxOverflowPolicy(TxOverflowPolicy policy);
+TxStats GetTxStats();
 
 int8_t Read(void);
 uint32_t ReadBytes(void* buffer, uint32_t length); // Returns nums byte read
 string ReadString(void);
 } // namespace CDC
+
+namespace MIDI
+{
+struct TransferStats {
+  uint32_t transfers = 0; // Writes handed to the USB MIDI endpoint
+  uint32_t packets = 0;   // MIDI packets in those writes, packets / transfers is the average packets per transfer
+};
+
+struct CableStats {
+  uint16_t port = MIDI_PORT_INVALID;
+  uint32_t packets = 0;
+  uint32_t transfers = 0;      // Writes that carried at least one packet of this cable
+  uint32_t droppedPackets = 0; // Taken off the port while the host wasn't listening
+  uint32_t lastLatencyUs = 0;  // From leaving the port queue to the endpoint FIFO taking the write
+  uint32_t maxLatencyUs = 0;
+  uint64_t totalLatencyUs = 0; // totalLatencyUs / transfers is the average latency
+};
+
+TransferStats GetTransferStats();
+vector<CableStats> GetCableStats();
+} // namespace MIDI
 } // namespace USB
 
 namespace MIDI
 {
+struct MidiQueueStats {
+  uint32_t capacity = 0;
+  uint32_t pending = 0;
+  uint32_t highWaterMark = 0;         // Most packets waiting for the application at once
+  uint32_t droppedPackets = 0;        // Packets lost because the application queue was full
+  uint32_t droppedOversizedSysEx = 0; // System SysEx messages too long to handle
+};
+
 bool Get(MidiPacket* midiPacketDest, uint16_t timeoutMs = 0);
 bool Send(MidiPacket midiPacket, uint16_t targetPort = MIDI_PORT_EACH_CLASS, uint16_t timeoutMs = 0);
+bool SendBatch(const MidiPacket* midiPackets, uint16_t count, uint16_t targetPort = MIDI_PORT_EACH_CLASS,
+               uint16_t timeoutMs = 0); // Routes the packets once and queues them to each port as one burst
+
+// Streaming SysEx. handler gets every message starting with prefix (F0 included) chunk by chunk as it arrives, on the MIDI task.
+// Handlers must not add or remove handlers. Handlers added by an application are removed when it exits.
+bool AddSysExHandler(const uint8_t* prefix, uint8_t prefixLength, SysExHandler handler, void* context = nullptr);
+void RemoveSysExHandler(SysExHandler handler, void* context = nullptr);
+SysExStats GetSysExStats();
 bool SendSysEx(uint16_t port, uint16_t length, uint8_t* data,
                bool includeMeta = true); // If include meta, it will send the correct header and ending;
+
+struct PortRouteStats {
+  uint16_t port;
+  uint32_t routedPackets;  // Packets queued to the port
+  uint32_t droppedPackets; // Packets lost to a full or missing port queue
+  uint16_t queueSize;
+  uint16_t pending;
+  uint16_t highWaterMark;  // Most packets waiting in the port queue at once
+};
+
+struct RouteStats {
+  uint32_t tableVersion = 0;      // Bumped on every port open/close
+  uint32_t unroutablePackets = 0; // Packets sent to a port that isn't open
+  vector<PortRouteStats> ports;
+};
+RouteStats GetRouteStats();
+MidiQueueStats GetQueueStats(); // The application MIDI queue read by Get
 } // namespace MIDI
 
 namespace HID
@@ -192,6 +326,31 @@ void LogInfo(const string& tag, const string& format, ...);
 void LogDebug(const string& tag, const string& format, ...);
 void LogVerbose(const string& tag, const string& format, ...);
 
+// Deferred version - only captures the arguments, formatting and output happen on the logging task
+// tag and format must outlive the call (string literals or static strings), %s arguments are copied
+void LogDeferred(ELogLevel level, const char* tag, const char* format, ...);
+
+struct LogStats {
+  uint32_t queued = 0;    // Deferred records accepted
+  uint32_t dropped = 0;   // Deferred records lost because the queue was full
+  uint32_t truncated = 0; // Deferred records whose arguments didn't fit in a record
+  uint32_t pending = 0;   // Deferred records waiting to be formatted
+};
+LogStats GetLogStats();
+
+// Errors always log in place so nothing is lost if the system halts right after
+#ifdef MATRIXOS_LOG_DEFERRED
+#define MLOG_WARNING(tag, format, ...) MatrixOS::Logging::LogDeferred(LOG_WARNING, tag, "" format, ##__VA_ARGS__)
+#define MLOG_INFO(tag, format, ...) MatrixOS::Logging::LogDeferred(LOG_INFO, tag, "" format, ##__VA_ARGS__)
+#define MLOG_DEBUG(tag, format, ...) MatrixOS::Logging::LogDeferred(LOG_DEBUG, tag, "" format, ##__VA_ARGS__)
+#define MLOG_VERBOSE(tag, format, ...) MatrixOS::Logging::LogDeferred(LOG_VERBOSE, tag, "" format, ##__VA_ARGS__)
+#else
+#define MLOG_WARNING(tag, format, ...) MatrixOS::Logging::LogWarning(tag, format, ##__VA_ARGS__)
+#define MLOG_INFO(tag, format, ...) MatrixOS::Logging::LogInfo(tag, format, ##__VA_ARGS__)
+#define MLOG_DEBUG(tag, format, ...) MatrixOS::Logging::LogDebug(tag, format, ##__VA_ARGS__)
+#define MLOG_VERBOSE(tag, format, ...) MatrixOS::Logging::LogVerbose(tag, format, ##__VA_ARGS__)
+#endif
+
 // Macro version is perfered because it will not generate any code if the log level is lower than the log level
 #if (MATRIXOS_LOG_LEVEL >= LOG_LEVEL_ERROR)
 #define MLOGE(tag, format, ...) MatrixOS::Logging::LogError(tag, format, ##__VA_ARGS__)
@@ -200,25 +359,25 @@ void LogVerbose(const string& tag, const string& format, ...);
 #endif
 
 #if (MATRIXOS_LOG_LEVEL >= LOG_LEVEL_WARNING)
-#define MLOGW(tag, format, ...) MatrixOS::Logging::LogWarning(tag, format, ##__VA_ARGS__)
+#define MLOGW(tag, format, ...) MLOG_WARNING(tag, format, ##__VA_ARGS__)
 #else
 #define MLOGW(tag, format, ...)
 #endif
 
 #if (MATRIXOS_LOG_LEVEL >= LOG_LEVEL_INFO)
-#define MLOGI(tag, format, ...) MatrixOS::Logging::LogInfo(tag, format, ##__VA_ARGS__)
+#define MLOGI(tag, format, ...) MLOG_INFO(tag, format, ##__VA_ARGS__)
 #else
 #define MLOGI(tag, format, ...)
 #endif
 
 #if (MATRIXOS_LOG_LEVEL >= LOG_LEVEL_DEBUG)
-#define MLOGD(tag, format, ...) MatrixOS::Logging::LogDebug(tag, format, ##__VA_ARGS__)
+#define MLOGD(tag, format, ...) MLOG_DEBUG(tag, format, ##__VA_ARGS__)
 #else
 #define MLOGD(tag, format, ...)
 #endif
 
 #if (MATRIXOS_LOG_LEVEL >= LOG_LEVEL_VERBOSE)
-#define MLOGV(tag, format, ...) MatrixOS::Logging::LogVerbose(tag, format, ##__VA_ARGS__)
+#define MLOGV(tag, format, ...) MLOG_VERBOSE(tag, format, ##__VA_ARGS__)
 #else
 #define MLOGV(tag, format, ...)
 #endif
@@ -226,6 +385,16 @@ void LogVerbose(const string& tag, const string& format, ...);
 
 namespace NVS
 {
+struct CacheStats {
+  uint32_t cachedVariables = 0;
+  uint32_t pendingWrites = 0;   // Changed variables waiting for the next flush
+  uint32_t readHits = 0;
+  uint32_t readMisses = 0;
+  uint32_t writesCoalesced = 0; // Writes merged into a pending write or equal to the stored value
+  uint32_t flashWrites = 0;     // Writes and deletes issued to the device
+  uint32_t flushes = 0;
+};
+
 size_t GetSize(uint32_t hash);
 vector<char> GetVariable(uint32_t hash);
 int8_t GetVariable(uint32_t hash, void* pointer, uint16_t length); // Load variable into pointer. If not defined,
@@ -233,10 +402,33 @@ int8_t GetVariable(uint32_t hash, void* pointer, uint16_t length); // Load varia
                                                                    // into it.
 bool SetVariable(uint32_t hash, void* pointer, uint16_t length);
 bool DeleteVariable(uint32_t hash);
+void Flush(); // Write pending variables to flash now. Done automatically after writes settle, on app exit and before reboot.
+void Clear(); // Erase all variables, including pending writes
+CacheStats GetCacheStats();
 } // namespace NVS
 
 namespace FileSystem
 {
+struct SectorCacheStats {
+  uint32_t hits = 0;
+  uint32_t misses = 0;
+  uint32_t readaheadHits = 0;  // Sectors served from a readahead window
+  uint32_t readaheadFills = 0; // Multi-sector reads issued for sequential access
+  uint32_t writesCached = 0;   // Sector writes absorbed by the cache
+  uint32_t writeBacks = 0;     // Dirty sectors written to storage
+  uint32_t bypassed = 0;       // Multi-sector transfers sent straight to storage
+};
+
+struct MassStorageStats {
+  uint32_t sectorsRead = 0;
+  uint32_t sectorsWritten = 0;
+  uint32_t readaheadHits = 0; // Read windows that were ready by the time the host got to them
+  uint32_t readMisses = 0;    // Read windows the host had to wait for
+  uint32_t storageWrites = 0; // Coalesced writes, sectorsWritten / storageWrites is the average write size
+  uint32_t writeErrors = 0;
+  uint64_t waitUs = 0;        // Time USB spent waiting on the storage task
+};
+
 void Init();
 bool Available(void);
 string TranslatePath(const string& path);
@@ -248,6 +440,8 @@ bool Remove(const string& path);
 bool RemoveDir(const string& path);
 bool Rename(const string& from, const string& to);
 vector<string> ListDir(const string& path);
+SectorCacheStats GetCacheStats();
+MassStorageStats GetMassStorageStats();
 } // namespace FileSystem
 
 // namespace GPIO
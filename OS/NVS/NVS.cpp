@@ -1,17 +1,174 @@
 #include "MatrixOS.h"
+#include "NVS.h"
+#include "../System/Telemetry.h"
+
+// Variables are cached in RAM and written back by a background task once writes settle, so UI code never waits on flash.
+#define NVS_FLUSH_DELAY_MS 1000      // Flush after no variable changed for this long
+#define NVS_FLUSH_MAX_DELAY_MS 5000  // Flush at least this often while variables keep changing
+#define NVS_CACHE_MAX_ENTRY_SIZE 256 // Larger variables (e.g. UAD) are written through instead of kept in RAM
+#define NVS_FLUSH_STACK_SIZE (configMINIMAL_STACK_SIZE * 4)
 
 namespace MatrixOS::NVS
 {
+struct CacheEntry {
+  vector<char> data;
+  bool exists = false; // False if the variable is not stored (or pending delete)
+  bool dirty = false;  // Differs from flash
+  uint32_t version = 0; // Bumped on every change, so a flush knows if the value changed while it was writing
+};
+
+static std::unordered_map<uint32_t, CacheEntry> cache;
+static CacheStats stats;
+static uint32_t firstDirtyTime = 0;
+static uint32_t lastWriteTime = 0;
+static uint32_t bypassGeneration = 0; // Bumped after every device write that bypasses the cache
+
+static StackType_t flushTaskStack[NVS_FLUSH_STACK_SIZE];
+static StaticTask_t flushTaskDef;
+static TaskHandle_t flushTask = NULL;
+
+// Created on first use, NVS is read during device init before Init() runs
+static SemaphoreHandle_t CacheMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Serializes device writes so a flush can't reorder with another flush or a clear
+static SemaphoreHandle_t FlushMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Returns the cache entry for hash, loading it from the device on a miss. Call with the cache mutex held.
+static CacheEntry& Load(uint32_t hash) {
+  auto it = cache.find(hash);
+  if (it != cache.end())
+  {
+    return it->second;
+  }
+
+  CacheEntry& entry = cache[hash];
+  entry.data = Device::NVS::Read(hash);
+  entry.exists = entry.data.size() > 0;
+  return entry;
+}
+
+static void MarkDirty(CacheEntry& entry) {
+  uint32_t now = (uint32_t)MatrixOS::SYS::Millis();
+  entry.version++;
+  if (!entry.dirty)
+  {
+    entry.dirty = true;
+    stats.pendingWrites++;
+  }
+  else
+  {
+    stats.writesCoalesced++;
+  }
+  if (stats.pendingWrites == 1)
+  {
+    firstDirtyTime = now;
+  }
+  lastWriteTime = now;
+}
+
+static void WakeFlushTask() {
+  if (flushTask != NULL)
+  {
+    xTaskNotifyGive(flushTask);
+  }
+}
+
+static void FlushTask(void* param) {
+  bool retry = false;
+  while (true)
+  {
+    // Writes that failed are still dirty, try them again after a while even if nothing new is written
+    ulTaskNotifyTake(pdTRUE, retry ? pdMS_TO_TICKS(NVS_FLUSH_MAX_DELAY_MS) : portMAX_DELAY);
+
+    // Debounce, every write restarts the idle timer until the max delay is reached
+    while (true)
+    {
+      xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+      uint32_t now = (uint32_t)MatrixOS::SYS::Millis();
+      uint32_t idle = now - lastWriteTime;
+      uint32_t pending = now - firstDirtyTime;
+      bool hasPending = stats.pendingWrites > 0;
+      xSemaphoreGive(CacheMutex());
+
+      if (!hasPending || idle >= NVS_FLUSH_DELAY_MS || pending >= NVS_FLUSH_MAX_DELAY_MS)
+      {
+        break;
+      }
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(std::min(NVS_FLUSH_DELAY_MS - idle, NVS_FLUSH_MAX_DELAY_MS - pending)));
+    }
+
+    Flush();
+
+    xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+    retry = stats.pendingWrites > 0;
+    xSemaphoreGive(CacheMutex());
+  }
+}
+
+void Init() {
+  if (flushTask != NULL)
+  {
+    return;
+  }
+  flushTask = xTaskCreateStatic(FlushTask, "nvs_flush", NVS_FLUSH_STACK_SIZE, NULL, 1, flushTaskStack, &flushTaskDef);
+  Telemetry::WatchTask(flushTask, "nvs_flush");
+  WakeFlushTask(); // Pick up anything written before the task existed
+}
+
 size_t GetSize(uint32_t hash) {
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  auto it = cache.find(hash);
+  if (it != cache.end())
+  {
+    stats.readHits++;
+    size_t size = it->second.exists ? it->second.data.size() : 0;
+    xSemaphoreGive(CacheMutex());
+    return size;
+  }
+  xSemaphoreGive(CacheMutex());
   return Device::NVS::Size(hash);
 }
 
 vector<char> GetVariable(uint32_t hash) {
-  return Device::NVS::Read(hash);
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  auto it = cache.find(hash);
+  if (it != cache.end())
+  {
+    stats.readHits++;
+    vector<char> data = it->second.exists ? it->second.data : vector<char>();
+    xSemaphoreGive(CacheMutex());
+    return data;
+  }
+  uint32_t generation = bypassGeneration;
+  xSemaphoreGive(CacheMutex());
+
+  vector<char> data = Device::NVS::Read(hash);
+  if (data.size() > NVS_CACHE_MAX_ENTRY_SIZE)
+  {
+    return data;
+  }
+
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  stats.readMisses++;
+  // Another task may have written it while we were reading the device, through the cache or around it
+  if (cache.find(hash) == cache.end() && bypassGeneration == generation)
+  {
+    CacheEntry& entry = cache[hash];
+    entry.data = data;
+    entry.exists = data.size() > 0;
+  }
+  xSemaphoreGive(CacheMutex());
+  return data;
 }
 
 int8_t GetVariable(uint32_t hash, void* pointer, uint16_t length) {
-  vector<char> data = Device::NVS::Read(hash);
+  vector<char> data = GetVariable(hash);
   if (data.size() == 0) // Have not been saved
   {
     SetVariable(hash, pointer, length);
@@ -30,12 +187,157 @@ int8_t GetVariable(uint32_t hash, void* pointer, uint16_t length) {
 }
 
 bool SetVariable(uint32_t hash, void* pointer, uint16_t length) {
-  // MLOGV("NVS", "Variable wrote : 0x%08x : 0x%08x: %d", hash, *(uint32_t*)pointer, length);
-  // //Sometimes this will cause kernal panic
-  return Device::NVS::Write(hash, pointer, length);
+  if (length > NVS_CACHE_MAX_ENTRY_SIZE)
+  {
+    xSemaphoreTake(FlushMutex(), portMAX_DELAY);
+    xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+    auto it = cache.find(hash);
+    if (it != cache.end())
+    {
+      if (it->second.dirty)
+      {
+        stats.pendingWrites--;
+      }
+      cache.erase(it);
+    }
+    xSemaphoreGive(CacheMutex());
+    bool success = Device::NVS::Write(hash, pointer, length);
+    xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+    bypassGeneration++;
+    stats.flashWrites++;
+    xSemaphoreGive(CacheMutex());
+    xSemaphoreGive(FlushMutex());
+    return success;
+  }
+
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  CacheEntry& entry = Load(hash);
+  if (entry.exists && entry.data.size() == length && memcmp(entry.data.data(), pointer, length) == 0)
+  {
+    // Same as the stored value, nothing to write
+    stats.writesCoalesced++;
+    xSemaphoreGive(CacheMutex());
+    return true;
+  }
+  entry.data.assign((char*)pointer, (char*)pointer + length);
+  entry.exists = true;
+  MarkDirty(entry);
+  xSemaphoreGive(CacheMutex());
+
+  WakeFlushTask();
+  return true;
 }
 
 bool DeleteVariable(uint32_t hash) {
-  return Device::NVS::Delete(hash);
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  auto it = cache.find(hash);
+  if (it == cache.end())
+  {
+    // Not cached, could be a large variable. Delete directly instead of loading it.
+    xSemaphoreGive(CacheMutex());
+    xSemaphoreTake(FlushMutex(), portMAX_DELAY);
+    bool success = Device::NVS::Delete(hash);
+    xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+    bypassGeneration++;
+    stats.flashWrites++;
+    xSemaphoreGive(CacheMutex());
+    xSemaphoreGive(FlushMutex());
+    return success;
+  }
+
+  CacheEntry& entry = it->second;
+  if (!entry.exists)
+  {
+    xSemaphoreGive(CacheMutex());
+    return false;
+  }
+  entry.data.clear();
+  entry.exists = false;
+  MarkDirty(entry);
+  xSemaphoreGive(CacheMutex());
+
+  WakeFlushTask();
+  return true;
+}
+
+void Flush() {
+  struct PendingWrite {
+    uint32_t hash;
+    uint32_t version;
+    bool exists;
+    vector<char> data;
+    bool success;
+  };
+
+  xSemaphoreTake(FlushMutex(), portMAX_DELAY);
+
+  // Snapshot dirty entries so writers aren't blocked on flash. They stay dirty until their write succeeds.
+  vector<PendingWrite> pendingWrites;
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  pendingWrites.reserve(stats.pendingWrites);
+  for (auto& [hash, entry] : cache)
+  {
+    if (entry.dirty)
+    {
+      pendingWrites.push_back({hash, entry.version, entry.exists, entry.data, false});
+    }
+  }
+  xSemaphoreGive(CacheMutex());
+
+  for (PendingWrite& write : pendingWrites)
+  {
+    if (write.exists)
+    {
+      write.success = Device::NVS::Write(write.hash, write.data.data(), write.data.size());
+    }
+    else
+    {
+      // Deleting a variable that was never stored is fine
+      write.success = Device::NVS::Delete(write.hash) || Device::NVS::Size(write.hash) == 0;
+    }
+    if (!write.success)
+    {
+      MLOGE("NVS", "Failed to write variable 0x%08X, will retry", write.hash);
+    }
+  }
+
+  if (!pendingWrites.empty())
+  {
+    xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+    for (PendingWrite& write : pendingWrites)
+    {
+      auto it = cache.find(write.hash);
+      // Changed again while we were writing, the newer value is still pending
+      if (write.success && it != cache.end() && it->second.dirty && it->second.version == write.version)
+      {
+        it->second.dirty = false;
+        stats.pendingWrites--;
+      }
+    }
+    stats.flashWrites += pendingWrites.size();
+    stats.flushes++;
+    xSemaphoreGive(CacheMutex());
+  }
+
+  xSemaphoreGive(FlushMutex());
+}
+
+void Clear() {
+  xSemaphoreTake(FlushMutex(), portMAX_DELAY);
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  cache.clear();
+  stats.pendingWrites = 0;
+  Device::NVS::Clear();
+  bypassGeneration++;
+  xSemaphoreGive(CacheMutex());
+  xSemaphoreGive(FlushMutex());
+}
+
+CacheStats GetCacheStats() {
+  xSemaphoreTake(CacheMutex(), portMAX_DELAY);
+  CacheStats snapshot = stats;
+  snapshot.cachedVariables = cache.size();
+  xSemaphoreGive(CacheMutex());
+  return snapshot;
 }
-} // namespace MatrixOS::NVS
\ No newline at end of file
+} // namespace MatrixOS::NVS
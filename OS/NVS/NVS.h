@@ -0,0 +1,6 @@
+#pragma once
+
+namespace MatrixOS::NVS
+{
+void Init(); // Start the background flush task
+}
@@ -36,13 +36,21 @@
 #define MATRIXOS_LOG_DEVICE
 #define MATRIXOS_LOG_USBCDC
 #define MATRIXOS_LOG_COLOR
+#define MATRIXOS_LOG_DEFERRED // Non-error logs are formatted and written by a background task
+
+#define LOG_DEFERRED_QUEUE_SIZE 64 // Must be a power of two
+#define LOG_RECORD_ARG_SIZE 44 // Bytes of captured arguments per deferred record, inline strings included
 
 // TODO: move this to per-app stack sizing so heavier apps can request more.
 #define APPLICATION_STACK_SIZE (configMINIMAL_STACK_SIZE * 32)
 
-#define INPUT_EVENT_QUEUE_SIZE 32
+#define INPUT_EVENT_QUEUE_SIZE 32 // Must be a power of two
+#define INPUT_EVENT_AFTERTOUCH_RESERVE 8 // Slots only state transitions may use
 #define MIDI_QUEUE_SIZE 128
 
+#define CDC_TX_BUFFER_SIZE 4096 // Must be a power of two
+#define CDC_TX_BLOCK_TIMEOUT_MS 100 // Longest a write waits for room under TxOverflowPolicy::Block
+
 inline const uint16_t holdThreshold = 400;
 
 inline const uint16_t crossfadeDuration = 200;
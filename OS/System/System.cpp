@@ -7,7 +7,10 @@
 #include "../LED/LED.h"
 #include "../Input/Input.h"
 #include "../MIDI/MIDI.h"
+#include "../NVS/NVS.h"
+#include "../Logging/Logging.h"
 #include "../Commands/CommandHandler.h"
+#include "Telemetry.h"
 #include "task.h"
 
 extern std::unordered_map<uint32_t, Application_Info*> applications;
@@ -23,6 +26,17 @@ enum TLSIndex {
   TLS_MAX_INDEX = 1          // Reserve for future use
 };
 
+SemaphoreHandle_t AppTaskMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+static void SetAppTask(TaskHandle_t task) {
+  xSemaphoreTake(AppTaskMutex(), portMAX_DELAY);
+  activeAppTask = task;
+  xSemaphoreGive(AppTaskMutex());
+}
+
 static void ResetAppEnvironment() {
   MatrixOS::Input::ClearInputBuffer();
   Device::Input::SuppressActiveInputs();
@@ -101,8 +115,8 @@ void Supervisor(void* param) {
 
   MLOGD("Supervisor", "%d Apps registered", GetApplications().size());
 
-  activeAppTask =
-      xTaskCreateStatic(ApplicationFactory, "application", APPLICATION_STACK_SIZE, NULL, 1, applicationStack, &applicationTaskdef);
+  SetAppTask(
+      xTaskCreateStatic(ApplicationFactory, "application", APPLICATION_STACK_SIZE, NULL, 1, applicationStack, &applicationTaskdef));
 
   bool exited = false;
   InputId fnKeyId = InputId::FunctionKey();
@@ -133,14 +147,15 @@ void Supervisor(void* param) {
         appTaskPendingCleanup = false;
       }
 
-      activeAppTask =
-          xTaskCreateStatic(ApplicationFactory, "application", APPLICATION_STACK_SIZE, NULL, 1, applicationStack, &applicationTaskdef);
+      SetAppTask(
+          xTaskCreateStatic(ApplicationFactory, "application", APPLICATION_STACK_SIZE, NULL, 1, applicationStack, &applicationTaskdef));
     }
     DelayMs(100);
   }
 }
 
 void Begin(void) {
+  MatrixOS::Logging::Init();
   MatrixOS::Command::Init();
 
   MLOGI("System", "Begin: DeviceInit start");
@@ -162,6 +177,7 @@ void Begin(void) {
 
   MLOGI("System", "Begin: UpdateSystemNVS start");
   UpdateSystemNVS();
+  MatrixOS::NVS::Init();
   MLOGI("System", "Begin: UpdateSystemNVS done");
 
   inited = true;
@@ -178,7 +194,9 @@ void Begin(void) {
 
   Device::DeviceStart(); // App won't run till supervisor is running
 
-  (void)xTaskCreateStatic(Supervisor, "supervisor", configMINIMAL_STACK_SIZE * 4, NULL, 1, supervisorStack, &supervisorTaskdef);
+  TaskHandle_t supervisorTask =
+      xTaskCreateStatic(Supervisor, "supervisor", configMINIMAL_STACK_SIZE * 4, NULL, 1, supervisorStack, &supervisorTaskdef);
+  Telemetry::WatchTask(supervisorTask, "supervisor");
 
   // nextAppId = GenerateAPPID("203 Systems", "Performance Mode");  // Launch Performance mode by default for now
 }
@@ -206,13 +224,35 @@ void DelayMs(uint32_t ms) {
   vTaskDelay(pdMS_TO_TICKS(ms));
 }
 
+void WakeApp() {
+  TaskHandle_t task = activeAppTask;
+  if (task != NULL)
+  {
+    xTaskNotifyGive(task);
+  }
+}
+
+bool WaitForWake(uint32_t timeoutMs) {
+  // Notifications are only delivered to the app task, anything else would sleep for the full timeout.
+  if (activeAppTask == NULL || xTaskGetCurrentTaskHandle() != activeAppTask)
+  {
+    taskYIELD();
+    return false;
+  }
+
+  TickType_t ticks = (timeoutMs == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+  return ulTaskNotifyTake(pdTRUE, ticks) > 0;
+}
+
 void Reboot(void) {
+  MatrixOS::NVS::Flush();
   Device::Reboot();
 }
 
 void Bootloader() {
   MatrixOS::LED::Fill(0);
   MatrixOS::LED::Update();
+  MatrixOS::NVS::Flush();
   DelayMs(20); // Wait for led data to be updated first.
   Device::Bootloader();
 }
@@ -262,9 +302,15 @@ void ExitAPP() {
 
   if (taskToDelete != NULL && xTaskGetCurrentTaskHandle() != taskToDelete)
   {
+    // Under the lock so the app isn't suspended holding it, clearing the handle below would never get it back
+    xSemaphoreTake(AppTaskMutex(), portMAX_DELAY);
     vTaskSuspend(taskToDelete);
+    xSemaphoreGive(AppTaskMutex());
   }
 
+  // SysEx handlers point into the app, drop them before it's gone
+  MatrixOS::MIDI::RemoveAppSysExHandlers();
+
   // Safeguard against nullptr before calling End()
   if (activeApp != nullptr)
   {
@@ -277,6 +323,9 @@ void ExitAPP() {
     activeAppInfo->destructor(activeApp);
   }
 
+  // Persist whatever the app saved before its task goes away
+  MatrixOS::NVS::Flush();
+
   if (taskToDelete != NULL)
   {
     UI::ExitAllUIs();
@@ -285,7 +334,7 @@ void ExitAPP() {
   activeApp = NULL;
   activeAppInfo = NULL;
   activeAppId = 0;
-  activeAppTask = NULL;
+  SetAppTask(NULL); // Nobody holding the mutex can still be reading the task once it's released
   appTaskPendingCleanup = (taskToDelete != NULL);
 
   if (taskToDelete != NULL)
@@ -330,7 +379,7 @@ void UpdateSystemNVS() {
       (prevSystemVersion & 0xFFFFFF00) > (MATRIXOS_VERSION_ID & 0xFFFFFF00)) // System version is not set or is newer than current
   {
     // Wipe NVS
-    Device::NVS::Clear();
+    MatrixOS::NVS::Clear();
     prevSystemVersion.Set(MATRIXOS_VERSION_ID);
     return;
   }
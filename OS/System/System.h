@@ -39,6 +39,9 @@ inline SavedVar<uint32_t> prevSystemVersion = SavedVar<uint32_t>(SYSTEM_VAR_NAME
 
 void Begin(void);
 
+// Held while activeAppTask is replaced, hold it to use the handle from another task without it being deleted
+SemaphoreHandle_t AppTaskMutex();
+
 void InitSysModules(void);
 
 uint32_t GenerateAPPID(string author, string appName);
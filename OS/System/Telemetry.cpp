@@ -0,0 +1,197 @@
+#include "MatrixOS.h"
+#include "Telemetry.h"
+#include "System.h"
+
+#include "../Commands/CommandHandler.h"
+
+namespace MatrixOS::Telemetry
+{
+#ifdef portNUM_PROCESSORS
+static constexpr uint32_t CPU_CORES = portNUM_PROCESSORS; // The run time clock is wall time, every core adds a share
+#else
+static constexpr uint32_t CPU_CORES = 1;
+#endif
+
+struct WatchedTask {
+  TaskHandle_t task;
+  const char* name;
+};
+
+static WatchedTask watchedTasks[MAX_WATCHED_TASKS];
+static uint8_t watchedTaskCount = 0;
+
+static SemaphoreHandle_t WatchMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+void WatchTask(TaskHandle_t task, const char* name) {
+  if (task == nullptr)
+  {
+    return;
+  }
+
+  xSemaphoreTake(WatchMutex(), portMAX_DELAY);
+  bool watched = false;
+  for (uint8_t i = 0; i < watchedTaskCount && !watched; i++)
+  {
+    watched = watchedTasks[i].task == task;
+  }
+  if (!watched && watchedTaskCount < MAX_WATCHED_TASKS)
+  {
+    watchedTasks[watchedTaskCount++] = {task, name};
+  }
+  else if (!watched)
+  {
+    MLOGW("Telemetry", "Watch list full, %s not watched", name);
+  }
+  xSemaphoreGive(WatchMutex());
+}
+
+void UnwatchTask(TaskHandle_t task) {
+  xSemaphoreTake(WatchMutex(), portMAX_DELAY);
+  for (uint8_t i = 0; i < watchedTaskCount; i++)
+  {
+    if (watchedTasks[i].task == task)
+    {
+      watchedTasks[i] = watchedTasks[--watchedTaskCount];
+      break;
+    }
+  }
+  xSemaphoreGive(WatchMutex());
+}
+
+static uint32_t RunTime(TaskHandle_t task) {
+#if (configGENERATE_RUN_TIME_STATS == 1)
+  return ulTaskGetRunTimeCounter(task);
+#else
+  (void)task;
+  return UNAVAILABLE;
+#endif
+}
+
+static uint32_t TotalRunTime() {
+#if (configGENERATE_RUN_TIME_STATS == 1)
+  return portGET_RUN_TIME_COUNTER_VALUE();
+#else
+  return UNAVAILABLE;
+#endif
+}
+
+static TaskStats ReadTask(TaskHandle_t task, const char* name) {
+  TaskStats stats;
+  stats.task = task;
+  stats.name = name;
+  stats.priority = uxTaskPriorityGet(task);
+  stats.stackFree = uxTaskGetStackHighWaterMark(task) * sizeof(StackType_t);
+  stats.runTime = RunTime(task);
+  return stats;
+}
+
+static void SampleTasks(Snapshot* snapshot) {
+  vector<TaskStats> tasks;
+  tasks.reserve(MAX_WATCHED_TASKS + 2);
+
+  // Read under the locks so a task can't be unwatched, or the app exited, and deleted halfway through
+  xSemaphoreTake(SYS::AppTaskMutex(), portMAX_DELAY);
+  if (SYS::activeAppTask != nullptr)
+  {
+    tasks.push_back(ReadTask(SYS::activeAppTask, "application"));
+  }
+  xSemaphoreGive(SYS::AppTaskMutex());
+
+  xSemaphoreTake(WatchMutex(), portMAX_DELAY);
+  TaskHandle_t timerTask = xTimerGetTimerDaemonTaskHandle();
+  if (timerTask != nullptr)
+  {
+    tasks.push_back(ReadTask(timerTask, "timers"));
+  }
+  for (uint8_t i = 0; i < watchedTaskCount; i++)
+  {
+    tasks.push_back(ReadTask(watchedTasks[i].task, watchedTasks[i].name));
+  }
+  xSemaphoreGive(WatchMutex());
+
+  uint32_t totalRunTime = TotalRunTime();
+  uint32_t elapsed = (totalRunTime - snapshot->totalRunTime) * CPU_CORES;
+  bool hasBaseline = totalRunTime != UNAVAILABLE && snapshot->totalRunTime != UNAVAILABLE && elapsed != 0;
+  for (TaskStats& task : tasks)
+  {
+    if (!hasBaseline || task.runTime == UNAVAILABLE)
+    {
+      continue;
+    }
+    for (const TaskStats& previous : snapshot->tasks)
+    {
+      if (previous.task == task.task && previous.runTime != UNAVAILABLE)
+      {
+        uint64_t permille = (uint64_t)(task.runTime - previous.runTime) * 1000 / elapsed;
+        task.cpuPermille = permille > 1000 ? 1000 : permille;
+        break;
+      }
+    }
+  }
+
+  snapshot->totalRunTime = totalRunTime;
+  snapshot->tasks = std::move(tasks);
+}
+
+static void SampleCounters(Snapshot* snapshot) {
+  snapshot->queues.clear();
+
+  Input::InputQueueStats input = Input::GetQueueStats();
+  snapshot->queues.push_back({"Input", input.capacity, input.pending, input.highWaterMark, input.droppedEvents + input.droppedAftertouch});
+
+  MIDI::MidiQueueStats midi = MIDI::GetQueueStats();
+  snapshot->queues.push_back({"MIDI App", midi.capacity, midi.pending, midi.highWaterMark, midi.droppedPackets});
+
+  MIDI::RouteStats routes = MIDI::GetRouteStats();
+  uint32_t droppedPortPackets = 0;
+  for (const MIDI::PortRouteStats& port : routes.ports)
+  {
+    char name[16];
+    snprintf(name, sizeof(name), "MIDI Port %04X", port.port);
+    snapshot->queues.push_back({name, port.queueSize, port.pending, port.highWaterMark, port.droppedPackets});
+    droppedPortPackets += port.droppedPackets;
+  }
+
+  uint32_t droppedUsbMidi = 0;
+  for (const USB::MIDI::CableStats& cable : USB::MIDI::GetCableStats())
+  {
+    droppedUsbMidi += cable.droppedPackets;
+  }
+
+  SysExStats sysEx = MIDI::GetSysExStats();
+  Logging::LogStats log = Logging::GetLogStats();
+  LED::LayerArenaStats arena = LED::GetLayerArenaStats();
+  Command::LedStreamStats stream = Command::GetLedStreamStats();
+  USB::CDC::TxStats cdc = USB::CDC::GetTxStats();
+  snapshot->queues.push_back({"CDC TX", cdc.capacity, cdc.pending, cdc.highWaterMark, cdc.bytesDropped});
+  snapshot->drops = {
+      {"input_events", input.droppedEvents},
+      {"input_aftertouch", input.droppedAftertouch},
+      {"midi_app", midi.droppedPackets},
+      {"midi_ports", droppedPortPackets},
+      {"midi_unroutable", routes.unroutablePackets},
+      {"midi_sysex_oversized", midi.droppedOversizedSysEx},
+      {"midi_usb_unmounted", droppedUsbMidi},
+      {"sysex_pool_exhausted", sysEx.poolExhausted},
+      {"sysex_timeouts", sysEx.timeouts},
+      {"sysex_aborted", sysEx.aborted},
+      {"log_dropped", log.dropped},
+      {"log_truncated", log.truncated},
+      {"led_arena_exhausted", arena.exhausted},
+      {"led_stream_frames", stream.droppedFrames},
+      {"led_stream_segments", stream.rejectedSegments},
+      {"cdc_tx_dropped", cdc.bytesDropped},
+  };
+}
+
+void Sample(Snapshot* snapshot) {
+  snapshot->timestamp = (uint32_t)SYS::Millis();
+  snapshot->freeHeap = xPortGetFreeHeapSize();
+  snapshot->minimumFreeHeap = xPortGetMinimumEverFreeHeapSize();
+  SampleTasks(snapshot);
+  SampleCounters(snapshot);
+}
+} // namespace MatrixOS::Telemetry
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "MatrixOS.h"
+
+// Per task CPU and stack use, queue depths and drop counters, for diagnosing latency reports from the field.
+// Nothing runs in the background, Sample reads the FreeRTOS task counters and the stats each module already keeps.
+namespace MatrixOS::Telemetry
+{
+constexpr uint8_t MAX_WATCHED_TASKS = 16;
+constexpr uint32_t UNAVAILABLE = UINT32_MAX;
+
+struct TaskStats {
+  TaskHandle_t task = nullptr;
+  const char* name = "";
+  uint8_t priority = 0;
+  uint32_t stackFree = 0;         // Least stack ever left, in bytes
+  uint32_t runTime = UNAVAILABLE; // FreeRTOS run time counter, only kept when built with configGENERATE_RUN_TIME_STATS
+  uint16_t cpuPermille = 0;       // Share of the CPU since the previous sample
+};
+
+struct QueueStats {
+  string name;
+  uint32_t capacity = 0;
+  uint32_t pending = 0;
+  uint32_t highWaterMark = 0;
+  uint32_t dropped = 0;
+};
+
+struct Counter {
+  const char* name;
+  uint32_t value;
+};
+
+struct Snapshot {
+  uint32_t timestamp = 0; // Millis at the sample
+  uint32_t totalRunTime = UNAVAILABLE;
+  uint32_t freeHeap = 0;
+  uint32_t minimumFreeHeap = 0;
+  vector<TaskStats> tasks;
+  vector<QueueStats> queues;
+  vector<Counter> drops;
+};
+
+// Long lived tasks register once created, the application and timer service tasks are always included.
+// Unwatch a task before deleting it.
+void WatchTask(TaskHandle_t task, const char* name);
+void UnwatchTask(TaskHandle_t task);
+
+// Refreshes snapshot in place. CPU shares are measured from what it held before, so each reader keeps its own.
+void Sample(Snapshot* snapshot);
+} // namespace MatrixOS::Telemetry
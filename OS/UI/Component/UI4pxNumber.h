@@ -87,34 +87,40 @@ public:
   template <typename F> void SetColorFunc(F&& f) {
     this->colorFunc = UICallback<Color(uint16_t digit)>(static_cast<F&&>(f));
   }
-  void Render4pxNumber(Point origin, Color color, uint8_t value) {
+  void Render4pxNumber(MatrixOS::LED::Canvas& canvas, Point origin, Color color, uint8_t value) {
     // MLOGD("4PX", "Num: %d, render at %d-%d", value, origin.x, origin.y);
     if (value < 11 /*&& value >= 0*/)
     {
+      Color glyph[4][3];
       for (int8_t x = 0; x < 3; x++)
       {
         for (int8_t y = 0; y < 4; y++)
         {
-          MatrixOS::LED::SetColor(origin + Point(x, 3 - y), bitRead(number4px[value][x], y) ? color : Color(0));
+          glyph[3 - y][x] = bitRead(number4px[value][x], y) ? color : Color(0);
         }
       }
+      canvas.SetRect(origin, Dimension(3, 4), &glyph[0][0]);
     }
   }
 
   virtual bool Render(Point origin) {
+    return RenderCanvas(MatrixOS::LED::AcquireCanvas().View(origin));
+  }
+
+  virtual bool RenderCanvas(MatrixOS::LED::Canvas canvas) {
     int32_t value = GetValue(); // Use GetValue() to support both pointer and function
     uint8_t sigFigure = int(log10(value) + 1);
-    Point renderOrigin = origin;
+    Point renderOrigin = Point(0, 0);
     // MLOGD("4PX", "Render %d, sigfig %d", value, sigFigure);
     for (int8_t digit = digits - 1; digit >= 0; digit--)
     {
       if (digit < sigFigure || digit == 0)
       {
-        Render4pxNumber(renderOrigin, GetColor(digit), (int)(value / std::pow(10, digit)) % 10);
+        Render4pxNumber(canvas, renderOrigin, GetColor(digit), (int)(value / std::pow(10, digit)) % 10);
       }
       else
       {
-        Render4pxNumber(renderOrigin, Color(0), 10);
+        Render4pxNumber(canvas, renderOrigin, Color(0), 10);
       }
 
       renderOrigin = renderOrigin + Point(3 + spacing, 0);
@@ -18,10 +18,16 @@ public:
     return false;
   } //
 
-  virtual bool Render(Point origin) {
+  virtual bool Render([[maybe_unused]] Point origin) {
     return false;
   }
 
+  // What the UI calls, with (0, 0) of the canvas at the component's origin.
+  // Components that draw a lot of pixels override this and write through the canvas instead of SetColor.
+  virtual bool RenderCanvas(MatrixOS::LED::Canvas canvas) {
+    return Render(canvas.Origin());
+  }
+
   virtual void SetEnabled(bool enabled) {
     this->enabled = enabled;
   }
@@ -49,7 +49,7 @@ void UI::Start() {
     GlobalLoops();
     Loop();
     RenderUI();
-    taskYIELD();
+    WaitForEvent();
   }
   UIEnd();
 }
@@ -71,6 +71,7 @@ void UI::RenderUI() {
     needRender = false;
     MatrixOS::LED::Fill(0);
     PreRender();
+    MatrixOS::LED::Canvas canvas = MatrixOS::LED::AcquireCanvas();
     for (auto const& uiComponentPair : uiComponents)
     {
       if (uiComponentPair.second->IsEnabled() == false)
@@ -79,13 +80,43 @@ void UI::RenderUI() {
       }
       Point xy = uiComponentPair.first;
       UIComponent* uiComponent = uiComponentPair.second;
-      uiComponent->Render(xy);
+      uiComponent->RenderCanvas(canvas.View(xy));
     }
     PostRender();
     MatrixOS::LED::Update();
   }
 }
 
+void UI::WaitForEvent() {
+  if (polling || needRender)
+  {
+    taskYIELD();
+    return;
+  }
+
+  uint32_t waitMs = UI_MAX_IDLE_WAIT_MS;
+  if (uiUpdateMS != UINT32_MAX)
+  {
+    uint32_t elapsed = uiTimer.SinceLastTick();
+    waitMs = std::min(waitMs, elapsed >= uiUpdateMS ? 0 : uiUpdateMS - elapsed);
+  }
+  for (UI* ui : uiList)
+  {
+    if (ui->global_loop_wait_func)
+    {
+      waitMs = std::min(waitMs, ui->global_loop_wait_func());
+    }
+  }
+
+  if (waitMs == 0)
+  {
+    taskYIELD();
+    return;
+  }
+
+  MatrixOS::SYS::WaitForWake(waitMs);
+}
+
 void UI::GetKey() {
   InputEvent inputEvent;
   while (MatrixOS::Input::Get(&inputEvent))
@@ -192,6 +223,15 @@ void UI::SetFPS(uint16_t fps) {
   }
 }
 
+void UI::SetPolling(bool polling) {
+  this->polling = polling;
+}
+
+void UI::NeedRender() {
+  needRender = true;
+  MatrixOS::SYS::WakeApp();
+}
+
 void UI::RegisterUI(UI* ui) {
   MLOGD("UI", "Register UI %s", ui->name.c_str());
   UI::uiList.push_back(ui);
@@ -11,6 +11,7 @@
 #include "UIUtilities.h"
 
 #define UI_DEFAULT_MAX_FPS 100
+#define UI_MAX_IDLE_WAIT_MS 50 // Upper bound for a blocked UI loop so Loop/GlobalLoop still run with FPS 0
 
 class UI {
 public:
@@ -30,6 +31,8 @@ public:
   template <typename F> void SetSetupFunc(F&& f) { setup_func = UICallback<void()>(static_cast<F&&>(f)); }
   template <typename F> void SetLoopFunc(F&& f) { loop_func = UICallback<void()>(static_cast<F&&>(f)); }
   template <typename F> void SetGlobalLoopFunc(F&& f) { global_loop_func = UICallback<void()>(static_cast<F&&>(f)); }
+  // Returns the ms until the global loop has to run again, every UI caps its sleep to it while this UI is alive
+  template <typename F> void SetGlobalLoopWaitFunc(F&& f) { global_loop_wait_func = UICallback<uint32_t()>(static_cast<F&&>(f)); }
   template <typename F> void SetEndFunc(F&& f) { end_func = UICallback<void()>(static_cast<F&&>(f)); }
   template <typename F> void SetPreRenderFunc(F&& f) { pre_render_func = UICallback<void()>(static_cast<F&&>(f)); }
   template <typename F> void SetPostRenderFunc(F&& f) { post_render_func = UICallback<void()>(static_cast<F&&>(f)); }
@@ -42,6 +45,11 @@ public:
 
   void SetFPS(uint16_t fps);
 
+  // By default the UI task sleeps between frames and is woken by input, MIDI or NeedRender.
+  // Enable polling for UIs whose Loop has to spin continuously.
+  void SetPolling(bool polling);
+  void NeedRender();
+
   static void GlobalLoops();
 
   void Exit();
@@ -58,6 +66,7 @@ private:
   bool newLEDLayer = true;
   bool disableExit = false;
   bool needRender = false;
+  bool polling = false;
 
   Timer uiTimer;
   uint32_t uiUpdateMS = 1000 / UI_DEFAULT_MAX_FPS;
@@ -65,6 +74,7 @@ private:
   UICallback<void()> setup_func;
   UICallback<void()> loop_func;
   UICallback<void()> global_loop_func;
+  UICallback<uint32_t()> global_loop_wait_func;
   UICallback<void()> pre_render_func;
   UICallback<void()> post_render_func;
   UICallback<void()> end_func;
@@ -92,6 +102,7 @@ private:
   }; // Return true to skip UIKeyEvent
 
   void RenderUI();
+  void WaitForEvent();
   void UIEnd();
   void UIKeyEvent(InputEvent* inputEvent);
   void PostCallbackCleanUp();
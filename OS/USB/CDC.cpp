@@ -3,6 +3,8 @@
 #include "tusb.h"
 #include "printf.h"
 
+#include <algorithm>
+
 namespace MatrixOS::USB::CDC
 {
 
@@ -18,40 +20,147 @@ void Poll(void) {
   // TODO
 }
 
-void Print(string str) {
+static_assert((CDC_TX_BUFFER_SIZE & (CDC_TX_BUFFER_SIZE - 1)) == 0, "CDC_TX_BUFFER_SIZE must be a power of two");
+
+// Head and tail run free, the difference is what's queued
+static uint8_t txBuffer[CDC_TX_BUFFER_SIZE];
+static uint32_t txHead = 0;
+static uint32_t txTail = 0;
+static TxOverflowPolicy txOverflowPolicy = TxOverflowPolicy::DropOldest;
+static TxStats txStats;
+
+static SemaphoreHandle_t TxMutex() {
+  static SemaphoreHandle_t mutex = xSemaphoreCreateMutex();
+  return mutex;
+}
+
+// Moves queued bytes into the TinyUSB FIFO as contiguous spans and starts the transfer. Caller holds TxMutex.
+static void PumpLocked() {
   if (!Connected())
   {
     return;
   }
 
-  for (uint16_t i = 0; i < str.length(); i++)
+  uint32_t moved = 0;
+  while (txTail != txHead)
+  {
+    uint32_t offset = txTail & (CDC_TX_BUFFER_SIZE - 1);
+    uint32_t span = std::min(txHead - txTail, CDC_TX_BUFFER_SIZE - offset);
+    uint32_t written = tud_cdc_n_write(0, &txBuffer[offset], span);
+    if (written == 0)
+    {
+      break;
+    }
+    txTail += written;
+    moved += written;
+  }
+
+  if (moved)
+  {
+    txStats.bytesSent += moved;
+    txStats.transfers++;
+    tud_cdc_n_write_flush(0);
+  }
+}
+
+static void Write(const char* data, uint32_t length) {
+  if (length == 0 || !Connected())
+  {
+    return;
+  }
+
+  xSemaphoreTake(TxMutex(), portMAX_DELAY);
+  txStats.bytesQueued += length;
+
+  if (txOverflowPolicy == TxOverflowPolicy::DropOldest && length > CDC_TX_BUFFER_SIZE)
   {
-    while (!tud_cdc_n_write_available(0))
+    // Only the tail end of the write can survive
+    txStats.bytesDropped += length - CDC_TX_BUFFER_SIZE;
+    data += length - CDC_TX_BUFFER_SIZE;
+    length = CDC_TX_BUFFER_SIZE;
+  }
+
+  uint32_t deadline = 0;
+  bool blocked = false;
+  while (length)
+  {
+    uint32_t space = CDC_TX_BUFFER_SIZE - (txHead - txTail);
+    if (space < length && txOverflowPolicy == TxOverflowPolicy::DropOldest)
+    {
+      uint32_t discard = length - space;
+      txTail += discard;
+      txStats.bytesDropped += discard;
+      space = length;
+    }
+
+    uint32_t count = std::min(space, length);
+    while (count)
+    {
+      uint32_t offset = txHead & (CDC_TX_BUFFER_SIZE - 1);
+      uint32_t span = std::min(count, CDC_TX_BUFFER_SIZE - offset);
+      memcpy(&txBuffer[offset], data, span);
+      txHead += span;
+      data += span;
+      length -= span;
+      count -= span;
+    }
+    txStats.highWaterMark = std::max(txStats.highWaterMark, txHead - txTail);
+    PumpLocked();
+
+    if (length == 0)
     {
-      if (!Connected())
-      {
-        return;
-      }
-      taskYIELD();
+      break;
+    }
+
+    if (txOverflowPolicy != TxOverflowPolicy::Block || !Connected())
+    {
+      break;
+    }
+
+    if (!blocked)
+    {
+      blocked = true;
+      deadline = (uint32_t)SYS::Millis() + CDC_TX_BLOCK_TIMEOUT_MS;
+      txStats.blockedWrites++;
     }
-    tud_cdc_n_write_char(0, str[i]);
+    else if ((int32_t)((uint32_t)SYS::Millis() - deadline) >= 0)
+    {
+      break;
+    }
+
+    // Let the USB task drain the ring from tud_cdc_tx_complete_cb
+    xSemaphoreGive(TxMutex());
+    vTaskDelay(1);
+    xSemaphoreTake(TxMutex(), portMAX_DELAY);
   }
-  // tud_cdc_n_write_str(0, str);
-  Flush();
+
+  txStats.bytesDropped += length;
+  xSemaphoreGive(TxMutex());
+}
+
+void Print(string str) {
+  Write(str.data(), str.length());
 }
 
 void Println(string str) {
   Print(str);
   Print("\n\r");
-  Flush();
 }
 
-void WriteChar(char c, void* arg) {
-  while (Connected() && !tud_cdc_n_write_available(0))
+// Collects formatted output so the ring is locked once per chunk rather than per character
+struct FormatBuffer {
+  char data[64];
+  uint8_t length = 0;
+};
+
+static void WriteChar(char c, void* arg) {
+  FormatBuffer* buffer = (FormatBuffer*)arg;
+  buffer->data[buffer->length++] = c;
+  if (buffer->length == sizeof(buffer->data))
   {
-    taskYIELD();
+    Write(buffer->data, buffer->length);
+    buffer->length = 0;
   }
-  tud_cdc_n_write_char(0, c);
 }
 
 void Printf(string format, ...) {
@@ -67,17 +176,30 @@ void Printf(string format, ...) {
 }
 
 void VPrintf(string format, va_list valst) {
-  vfctprintf(&WriteChar, NULL, format.c_str(), valst);
-  Flush();
+  FormatBuffer buffer;
+  vfctprintf(&WriteChar, &buffer, format.c_str(), valst);
+  Write(buffer.data, buffer.length);
 }
 
 void Flush(void) {
-  if (!Connected())
-  {
-    return;
-  }
+  xSemaphoreTake(TxMutex(), portMAX_DELAY);
+  PumpLocked();
+  xSemaphoreGive(TxMutex());
+}
 
-  tud_cdc_n_write_flush(0);
+void SetTxOverflowPolicy(TxOverflowPolicy policy) {
+  xSemaphoreTake(TxMutex(), portMAX_DELAY);
+  txOverflowPolicy = policy;
+  xSemaphoreGive(TxMutex());
+}
+
+TxStats GetTxStats() {
+  xSemaphoreTake(TxMutex(), portMAX_DELAY);
+  TxStats stats = txStats;
+  stats.capacity = CDC_TX_BUFFER_SIZE;
+  stats.pending = txHead - txTail;
+  xSemaphoreGive(TxMutex());
+  return stats;
 }
 
 // void Read() //Prob won't work, implementation need work
@@ -124,11 +246,12 @@ string ReadString(void) {
 }
 } // namespace MatrixOS::USB::CDC
 
-void putchar_(char character) {
-  if (!MatrixOS::USB::CDC::Connected())
-  {
-    return;
-  }
+// Runs on the USB task once the IN endpoint has sent what it was given
+void tud_cdc_tx_complete_cb(uint8_t itf) {
+  (void)itf;
+  MatrixOS::USB::CDC::Flush();
+}
 
-  tud_cdc_n_write_char(0, character);
+void putchar_(char character) {
+  MatrixOS::USB::CDC::Write(&character, 1);
 }
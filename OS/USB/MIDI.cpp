@@ -1,6 +1,9 @@
 #include "MatrixOS.h"
 #include "USB.h"
 #include "tusb.h"
+#include "../System/Telemetry.h"
+
+#include <algorithm>
 
 namespace MatrixOS::MIDI
 {
@@ -10,61 +13,213 @@ extern MidiPort* osPort;
 namespace MatrixOS::USB::MIDI
 {
 std::vector<MidiPort> ports;
-std::vector<TaskHandle_t> portTasks;
-std::vector<string> portTaskNames;
-SemaphoreHandle_t usbMidiMutex;
+static TaskHandle_t txTask = nullptr;
+
+// One bulk transfer worth of USB MIDI event packets (4 bytes each)
+#define USB_MIDI_PACKETS_PER_TRANSFER (CFG_TUD_MIDI_TX_BUFSIZE / 4)
+
+// How long a batch may wait on a host that stopped reading before the rest of it is dropped
+#ifndef USB_MIDI_WRITE_TIMEOUT_MS
+#define USB_MIDI_WRITE_TIMEOUT_MS 5
+#endif
 
-std::vector<uint8_t> sysexBuffer;
+static TransferStats transferStats;
+static CableStats cableStats[USB_MIDI_COUNT];
+
+// Packs a parsed MidiPacket straight into a USB MIDI event packet. Returns false if there is nothing to send.
+static bool EventPacket(const MidiPacket& packet, uint8_t cable, uint8_t event[4]) {
+  uint8_t cin;
+  switch (packet.status)
+  {
+  case EMidiStatus::NoteOff:
+    cin = CIN_NOTE_OFF;
+    break;
+  case EMidiStatus::NoteOn:
+    cin = CIN_NOTE_ON;
+    break;
+  case EMidiStatus::AfterTouch:
+    cin = CIN_AFTER_TOUCH;
+    break;
+  case EMidiStatus::ControlChange:
+    cin = CIN_CONTROL_CHANGE;
+    break;
+  case EMidiStatus::ProgramChange:
+    cin = CIN_PROGRAM_CHANGE;
+    break;
+  case EMidiStatus::ChannelPressure:
+    cin = CIN_CHANNEL_PRESSURE;
+    break;
+  case EMidiStatus::PitchChange:
+    cin = CIN_PITCH_WHEEL;
+    break;
+  case EMidiStatus::MTCQuarterFrame:
+  case EMidiStatus::SongSelect:
+    cin = CIN_2BYTE_SYS_COMMON;
+    break;
+  case EMidiStatus::SongPosition:
+    cin = CIN_3BYTE_SYS_COMMON;
+    break;
+  case EMidiStatus::TuneRequest:
+    cin = CIN_SYSEX_ENDS_IN_1; // Single byte system common shares the CIN
+    break;
+  case EMidiStatus::Clock:
+  case EMidiStatus::Tick:
+  case EMidiStatus::Start:
+  case EMidiStatus::Continue:
+  case EMidiStatus::Stop:
+  case EMidiStatus::ActiveSense:
+  case EMidiStatus::Reset:
+    cin = CIN_1BYTE;
+    break;
+  case EMidiStatus::SysExData:
+    cin = CIN_SYSEX;
+    break;
+  case EMidiStatus::SysExEnd:
+    cin = CIN_SYSEX_ENDS_IN_1 + packet.Length() - 1;
+    break;
+  default:
+    return false;
+  }
+
+  uint8_t length = cin == CIN_2BYTE_SYS_COMMON ? 2 : packet.Length();
+  event[0] = (cable << 4) | cin;
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    event[i + 1] = i < length ? packet.data[i] : 0;
+  }
+  return true;
+}
 
-void portTask(void* param) {
-  uint8_t itf = (uint8_t)(uintptr_t)param;
+// Hands the batch to the endpoint FIFO, waiting a frame at a time while it still holds the previous transfer.
+// Gives up after USB_MIDI_WRITE_TIMEOUT_MS, the caller counts what wasn't written as dropped.
+static uint16_t WriteEvents(const uint8_t events[][4], uint16_t count) {
+  uint16_t written = 0;
+  TickType_t start = xTaskGetTickCount();
+  while (written < count && tud_midi_mounted())
+  {
+#if (TUSB_VERSION_MAJOR > 0) || (TUSB_VERSION_MINOR >= 18)
+    written += tud_midi_n_packet_write_n(0, events[written], (count - written) * 4) / 4;
+#else
+    while (written < count && tud_midi_n_packet_write(0, events[written]))
+    {
+      written++;
+    }
+#endif
+    if (written < count)
+    {
+      if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(USB_MIDI_WRITE_TIMEOUT_MS))
+      {
+        break;
+      }
+      vTaskDelay(1);
+    }
+  }
+  return written;
+}
+
+// Single scheduler for every USB MIDI cable. Packets queued together (chords, a sequencer step) share a transfer,
+// cables take turns filling it so a busy one can't starve the others.
+static void TxTask(void* param) {
+  (void)param;
+  uint8_t events[USB_MIDI_PACKETS_PER_TRANSFER][4];
+  uint16_t cablePackets[USB_MIDI_COUNT];
+  uint8_t nextCable = 0;
   MidiPacket packet;
   while (true)
   {
-    if (ports[itf].Get(&packet, portMAX_DELAY))
+    while (true)
     {
-      if (usbMidiMutex)
+      uint16_t count = 0;
+      memset(cablePackets, 0, sizeof(cablePackets));
+      uint8_t firstCable = nextCable;
+      nextCable = (nextCable + 1) % USB_MIDI_COUNT;
+      uint64_t start = SYS::Micros();
+      for (uint8_t i = 0; i < USB_MIDI_COUNT && count < USB_MIDI_PACKETS_PER_TRANSFER; i++)
       {
-        xSemaphoreTake(usbMidiMutex, portMAX_DELAY);
+        uint8_t cable = (firstCable + i) % USB_MIDI_COUNT;
+        while (count < USB_MIDI_PACKETS_PER_TRANSFER && ports[cable].Get(&packet, 0))
+        {
+          if (EventPacket(packet, ports[cable].id % 0x100, events[count]))
+          {
+            count++;
+            cablePackets[cable]++;
+          }
+        }
       }
-      tud_midi_stream_write(ports[itf].id % 0x100, packet.data, packet.Length());
-      if (usbMidiMutex)
+      if (count == 0)
       {
-        xSemaphoreGive(usbMidiMutex);
+        break;
+      }
+
+      uint16_t written = WriteEvents(events, count);
+      uint32_t latency = (uint32_t)(SYS::Micros() - start);
+      transferStats.transfers++;
+      transferStats.packets += written;
+
+      // Cables fill the batch one after another, so the packets cut off by an unmount or a timeout are the last ones
+      uint16_t offset = 0;
+      for (uint8_t i = 0; i < USB_MIDI_COUNT; i++)
+      {
+        uint8_t cable = (firstCable + i) % USB_MIDI_COUNT;
+        if (cablePackets[cable] == 0)
+        {
+          continue;
+        }
+        CableStats& stats = cableStats[cable];
+        uint16_t sent = written > offset ? std::min<uint16_t>(written - offset, cablePackets[cable]) : 0;
+        stats.packets += sent;
+        stats.droppedPackets += cablePackets[cable] - sent;
+        stats.transfers++;
+        stats.lastLatencyUs = latency;
+        stats.maxLatencyUs = std::max(stats.maxLatencyUs, latency);
+        stats.totalLatencyUs += latency;
+        offset += cablePackets[cable];
       }
     }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
   }
 }
 
+TransferStats GetTransferStats() {
+  return transferStats;
+}
+
+vector<CableStats> GetCableStats() {
+  vector<CableStats> stats(cableStats, cableStats + ports.size());
+  for (uint8_t i = 0; i < ports.size(); i++)
+  {
+    stats[i].port = ports[i].id;
+  }
+  return stats;
+}
+
 void Init() {
-  for (TaskHandle_t portTask : portTasks)
+  if (txTask)
   {
-    vTaskDelete(portTask);
+    Telemetry::UnwatchTask(txTask);
+    vTaskDelete(txTask);
+    txTask = nullptr;
   }
-  portTasks.clear();
-  portTaskNames.clear();
   ports.clear();
-  if (usbMidiMutex)
+  for (CableStats& stats : cableStats)
   {
-    vSemaphoreDelete(usbMidiMutex);
-    usbMidiMutex = nullptr;
+    stats = CableStats();
   }
 
-  // Create ports and tasks
+  // Create ports, all of them wake the one TX task
   ports.reserve(USB_MIDI_COUNT);
-  portTasks.reserve(USB_MIDI_COUNT);
-  usbMidiMutex = xSemaphoreCreateMutex();
-
   for (uint8_t i = 0; i < USB_MIDI_COUNT; i++)
   {
     string portname = "USB MIDI " + std::to_string(i + 1);
     ports.emplace_back(portname, MIDI_PORT_USB + i);
+  }
 
-    portTasks.push_back(NULL);
-    portTaskNames.push_back(portname);
-    xTaskCreate(portTask, portTaskNames.back().c_str(), configMINIMAL_STACK_SIZE * 2, (void*)(uintptr_t)i, configMAX_PRIORITIES - 2,
-                &portTasks.back());
+  xTaskCreate(TxTask, "usb_midi_tx", configMINIMAL_STACK_SIZE * 2, NULL, configMAX_PRIORITIES - 2, &txTask);
+  for (MidiPort& port : ports)
+  {
+    port.receiveNotifyTask = txTask;
   }
+  Telemetry::WatchTask(txTask, "usb_midi_tx");
 }
 } // namespace MatrixOS::USB::MIDI
 
@@ -2,9 +2,12 @@
 #include "tusb.h"
 #include "Device.h"
 #include "class/msc/msc.h"
+#include "FileSystem/MassStorage.h"
 
 #define DEVICE_STORAGE 1
 
+#define SCSI_CMD_SYNCHRONIZE_CACHE_10 0x35 // Not in TinyUSB's list, hosts send it before eject and unmount
+
 //--------------------------------------------------------------------+
 // MSC callbacks
 //--------------------------------------------------------------------+
@@ -87,8 +90,11 @@ bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, boo
     }
     else
     {
-      // Unload disk storage - nothing to do as we don't support ejection
+      // Unload disk storage - we don't support ejection, just make sure the host's writes landed
       // MatrixOS::Logging::LogInfo("MSC", "Unload disk requested");
+#if DEVICE_STORAGE == 1
+      MatrixOS::FileSystem::MassStorage::Flush();
+#endif
     }
   }
 
@@ -99,9 +105,8 @@ bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, boo
 // Copy disk's data to buffer (up to bufsize) and return number of copied bytes.
 int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buffer, uint32_t bufsize) {
 #if DEVICE_STORAGE == 1
-  // Simple passthrough to Storage layer - ESP-IDF style
-  uint32_t sectorCount = bufsize / 512; // Convert bytes to sector count (Hard code this for now to improve performance)
-  if (!Device::Storage::ReadSectors(lba, sectorCount, buffer))
+  // Served from read-ahead windows, the next one is read while USB sends this one
+  if (MatrixOS::FileSystem::MassStorage::Read(lba, buffer, bufsize) < 0)
   {
     tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x11, 0x00);
     return -1;
@@ -119,11 +124,10 @@ int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void* buff
 // Process data in buffer to disk's storage and return number of written bytes
 int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t* buffer, uint32_t bufsize) {
 #if DEVICE_STORAGE == 1
-  // Simple passthrough to Storage layer - ESP-IDF style
-  uint32_t sectorCount = bufsize / 512; // Convert bytes to sector count (Hard code this for now to improve performance)
-  if (!Device::Storage::WriteSectors(lba, sectorCount, buffer))
+  // Coalesced and written in the background, a failed write is reported on the next command
+  if (MatrixOS::FileSystem::MassStorage::Write(lba, buffer, bufsize) < 0)
   {
-    tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x11, 0x00);
+    tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00);
     return -1;
   }
 
@@ -150,6 +154,16 @@ int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, u
 
   switch (scsi_cmd[0])
   {
+  case SCSI_CMD_SYNCHRONIZE_CACHE_10:
+#if DEVICE_STORAGE == 1
+    if (!MatrixOS::FileSystem::MassStorage::Flush())
+    {
+      tud_msc_set_sense(lun, SCSI_SENSE_MEDIUM_ERROR, 0x0C, 0x00);
+      resplen = -1;
+    }
+#endif
+    break;
+
   default:
     // Set Sense = Invalid Command Operation
     // MatrixOS::Logging::LogWarning("MSC", "Unknown SCSI command: 0x%02X", scsi_cmd[0]);
@@ -183,7 +197,9 @@ int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void* buffer, u
 void tud_msc_write10_complete_cb(uint8_t lun) {
   // MatrixOS::Logging::LogInfo("MSC", "WRITE10_COMPLETE - LUN: %d", lun);
 
-  // Could implement cache flushing here if needed
+#if DEVICE_STORAGE == 1
+  MatrixOS::FileSystem::MassStorage::WriteComplete(); // Start writing the tail of the command, don't wait for it
+#endif
 }
 
 // Invoked when received GET_MAX_LUN request, required for multiple LUNs implementation
@@ -121,9 +121,9 @@ extern "C" {
 
 #define CFG_TUD_HID_EP_BUFSIZE  64
 
-// MSC Buffer size of Device Mass storage (only if enabled)
+// MSC Buffer size of Device Mass storage (only if enabled), READ10/WRITE10 callbacks get up to this much at a time
 #if DEVICE_STORAGE
-#define CFG_TUD_MSC_EP_BUFSIZE 512
+#define CFG_TUD_MSC_EP_BUFSIZE 4096
 #endif
 
 enum
@@ -2,6 +2,7 @@
 #include "USB.h"
 
 #include "tusb.h"
+#include "../System/Telemetry.h"
 
 namespace MatrixOS::USB
 {
@@ -29,7 +30,9 @@ StaticTask_t usb_device_taskdef;
 void Init(USB_MODE mode) {
   MatrixOS::USB::mode = mode;
   tusb_init();
-  (void)xTaskCreateStatic(usb_device_task, "usbd", USBD_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, usb_device_stack, &usb_device_taskdef);
+  TaskHandle_t usbTask =
+      xTaskCreateStatic(usb_device_task, "usbd", USBD_STACK_SIZE, NULL, configMAX_PRIORITIES - 1, usb_device_stack, &usb_device_taskdef);
+  Telemetry::WatchTask(usbTask, "usbd");
   if (mode == USB_MODE_NORMAL)
   {
     USB::MIDI::Init();
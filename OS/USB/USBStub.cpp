@@ -15,6 +15,8 @@ bool Connected() { return false; }
 namespace MIDI
 {
 void Init() {}
+TransferStats GetTransferStats() { return TransferStats(); }
+vector<CableStats> GetCableStats() { return {}; }
 }
 
 namespace CDC
@@ -28,6 +30,8 @@ void Println(string str) { (void)str; }
 void Printf(string format, ...) { (void)format; }
 void VPrintf(string format, va_list valst) { (void)format; (void)valst; }
 void Flush() {}
+void SetTxOverflowPolicy(TxOverflowPolicy policy) { (void)policy; }
+TxStats GetTxStats() { return TxStats(); }
 
 int8_t Read() { return -1; }
 uint32_t ReadBytes(void* buffer, uint32_t length) { (void)buffer; (void)length; return 0; }